@@ -0,0 +1,157 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#ifdef _WIN32
+	#ifdef KALAUTILS_DLL_EXPORT
+		#define KALAUTILS_API __declspec(dllexport)
+	#else
+		#define KALAUTILS_API __declspec(dllimport)
+	#endif
+#else
+	#define KALAUTILS_API
+#endif
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <bit>
+
+#include "inpututils.hpp"
+#include "enums.hpp"
+
+namespace KalaKit
+{
+	using std::initializer_list;
+	using std::string;
+	using std::vector;
+	using std::unordered_map;
+
+	using ActionID = uint32_t;
+
+	enum class BindingType : uint8_t
+	{
+		//every key is held and atleast one of them went down this frame
+		CHORD,
+		//every key except the last is held and the last key went down this frame
+		COMBO
+	};
+
+	/// <summary>
+	/// Named input actions bound to chords and combos. Bindings are compiled
+	/// into key masks stored per binding, and every binding is tested in a
+	/// single pass over the key state each frame.
+	/// An action is triggered if any of its bindings matched.
+	/// </summary>
+	class KALAUTILS_API ActionMap
+	{
+	public:
+		static constexpr ActionID invalidAction = UINT32_MAX;
+
+		/// <summary>
+		/// Bind keys to the action, the action is created on first use.
+		/// Returns the action id, or invalidAction if no keys were given.
+		/// </summary>
+		/// <param name="actionName">Name of the action, the same name always maps to the same id.</param>
+		/// <param name="type">How the keys must be pressed.</param>
+		/// <param name="keys">Keys of the binding, the order only matters for combos.</param>
+		/// <param name="isExactModifiers">If true then shift, control and alt keys that are not part of the binding must be up.</param>
+		ActionID AddBinding(
+			const string& actionName,
+			BindingType type,
+			initializer_list<Key> keys,
+			bool isExactModifiers = false);
+		ActionID AddBinding(
+			const string& actionName,
+			BindingType type,
+			const vector<Key>& keys,
+			bool isExactModifiers = false);
+
+		/// <summary>
+		/// Add bindings from a text config, one binding per line:
+		///   action = Key + Key        chord
+		///   action = Key > Key > Key  combo
+		///   action = exact Key + Key  other modifiers must be up
+		/// Key names are case insensitive, lines starting with # are comments.
+		/// Invalid lines are skipped and reported.
+		/// </summary>
+		bool LoadFromString(const string& config);
+		bool LoadFromFile(const string& filePath);
+
+		/// <summary>
+		/// Remove every action and binding.
+		/// </summary>
+		void Clear();
+
+		/// <summary>
+		/// Evaluate every binding against the current InputUtils key state.
+		/// Call once per frame after InputUtils::ProcessEvents.
+		/// </summary>
+		void Update();
+		/// <summary>
+		/// Evaluate every binding against the given key state.
+		/// </summary>
+		void Update(const KeyBitset& held, const KeyBitset& pressed);
+
+		bool IsTriggered(ActionID action) const;
+		bool IsTriggered(const string& actionName) const;
+
+		/// <summary>
+		/// Returns invalidAction if no action with this name exists.
+		/// </summary>
+		ActionID GetActionID(const string& actionName) const;
+		const string& GetActionName(ActionID action) const;
+		size_t GetActionCount() const { return actionNames.size(); }
+		size_t GetBindingCount() const { return bindingActions.size(); }
+
+		/// <summary>
+		/// Call the callback with the id of every action triggered by the last Update.
+		/// </summary>
+		template <typename Callback>
+		void ForEachTriggered(Callback&& callback) const
+		{
+			for (size_t i = 0; i < triggeredActions.size(); i++)
+			{
+				uint64_t word = triggeredActions[i];
+				while (word != 0)
+				{
+					ActionID action = static_cast<ActionID>(i * 64 + std::countr_zero(word));
+					word &= word - 1;
+					callback(action);
+				}
+			}
+		}
+	private:
+		ActionID GetOrCreateAction(const string& actionName);
+
+		//
+		// COMPILED BINDINGS
+		// masks are stored word-major, word w of binding b is at [w * bindingCapacity + b],
+		// so each word of the key state is tested against every binding in one contiguous loop
+		//
+
+		void Reserve(size_t newCapacity);
+
+		size_t bindingCapacity = 0;
+		vector<uint64_t> heldMasks;      //keys that must be held
+		vector<uint64_t> pressedMasks;   //keys of which atleast one must have gone down
+		vector<uint64_t> forbiddenMasks; //keys that must be up
+		vector<ActionID> bindingActions;
+		//key state words used by any binding, unused words are skipped
+		uint8_t usedWords = 0;
+
+		//per binding scratch of Update, nonzero if a held or forbidden test failed
+		vector<uint64_t> failedTests;
+		//per binding scratch of Update, nonzero if a key of the pressed mask went down
+		vector<uint64_t> pressedHits;
+
+		vector<string> actionNames;
+		unordered_map<string, ActionID> actionLookup;
+		vector<uint64_t> triggeredActions;
+	};
+}
@@ -0,0 +1,224 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#ifdef _WIN32
+	#ifdef KALAUTILS_DLL_EXPORT
+		#define KALAUTILS_API __declspec(dllexport)
+	#else
+		#define KALAUTILS_API __declspec(dllimport)
+	#endif
+#else
+	#define KALAUTILS_API
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace KalaKit
+{
+	using std::string;
+	using std::coroutine_handle;
+
+	/// <summary>
+	/// Basic metadata of a file or folder returned by StatAsync.
+	/// </summary>
+	struct FileStat
+	{
+		bool exists = false;
+		bool isDirectory = false;
+		uintmax_t size = 0;
+	};
+
+	/// <summary>
+	/// Result of ReadFileAsync. Error is 0 on success,
+	/// otherwise it is the errno value of the failed step.
+	/// </summary>
+	struct AsyncReadResult
+	{
+		bool success = false;
+		int error = 0;
+		string data;
+	};
+
+	enum class AsyncFileOperation
+	{
+		OPERATION_READ,
+		OPERATION_WRITE,
+		OPERATION_STAT
+	};
+
+	/// <summary>
+	/// A single in-flight file request. It lives inside the awaitable
+	/// that created it, so it stays valid while the coroutine is suspended.
+	/// Should not be used manually.
+	/// </summary>
+	struct AsyncFileRequest
+	{
+		AsyncFileOperation operation = AsyncFileOperation::OPERATION_READ;
+		string path;
+		//file contents for reads, source bytes for writes
+		string data;
+		FileStat stat{};
+		int error = 0;
+		coroutine_handle<> continuation{};
+
+		//reactor bookkeeping
+		int fd = -1;
+		int stage = 0;
+		size_t offset = 0;
+		alignas(8) unsigned char statBuffer[256]{};
+		AsyncFileRequest* next = nullptr;
+	};
+
+	/// <summary>
+	/// Fire-and-forget coroutine type for functions that use co_await
+	/// on the async file API. Starts running immediately and destroys
+	/// itself once the coroutine body finishes.
+	/// </summary>
+	struct AsyncTask
+	{
+		struct promise_type
+		{
+			AsyncTask get_return_object() noexcept { return {}; }
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() noexcept {}
+			void unhandled_exception() noexcept { std::terminate(); }
+		};
+	};
+
+	class KALAUTILS_API AsyncFileUtils
+	{
+	public:
+		/// <summary>
+		/// Start the I/O reactor. Uses io_uring on Linux if the kernel supports it,
+		/// otherwise a pool of worker threads performs the blocking calls.
+		/// Coroutines are always resumed on the thread that calls Poll.
+		/// </summary>
+		/// <param name="threadCount">Worker threads for the thread pool fallback, 0 picks hardware concurrency.</param>
+		/// <param name="queueDepth">Submission queue size for io_uring.</param>
+		static bool Initialize(unsigned int threadCount = 0, unsigned int queueDepth = 256);
+
+		/// <summary>
+		/// Stop the reactor. All in-flight requests must have completed.
+		/// </summary>
+		static void Shutdown();
+
+		/// <summary>
+		/// Return true if requests are served by io_uring instead of the thread pool.
+		/// </summary>
+		static bool IsUsingIoUring();
+
+		/// <summary>
+		/// Submit queued requests and resume every coroutine whose request has completed.
+		/// If wait is true, blocks until atleast one request completes.
+		/// Returns how many coroutines were resumed.
+		/// </summary>
+		static size_t Poll(bool wait = false);
+
+		/// <summary>
+		/// Keep polling until no requests are in flight.
+		/// </summary>
+		static void RunUntilIdle();
+
+		/// <summary>
+		/// Return how many requests have been submitted but not yet resumed.
+		/// </summary>
+		static size_t GetInFlightCount();
+
+		/// <summary>
+		/// Used for handing a request to the reactor.
+		/// Should not be called manually.
+		/// </summary>
+		static void Submit(AsyncFileRequest* request);
+
+		struct ReadAwaitable
+		{
+			AsyncFileRequest request;
+
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(coroutine_handle<> handle)
+			{
+				request.continuation = handle;
+				Submit(&request);
+			}
+			AsyncReadResult await_resume()
+			{
+				return { request.error == 0, request.error, std::move(request.data) };
+			}
+		};
+
+		struct WriteAwaitable
+		{
+			AsyncFileRequest request;
+
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(coroutine_handle<> handle)
+			{
+				request.continuation = handle;
+				Submit(&request);
+			}
+			bool await_resume() const noexcept { return request.error == 0; }
+		};
+
+		struct StatAwaitable
+		{
+			AsyncFileRequest request;
+
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(coroutine_handle<> handle)
+			{
+				request.continuation = handle;
+				Submit(&request);
+			}
+			FileStat await_resume() const noexcept { return request.stat; }
+		};
+
+		/// <summary>
+		/// Read the whole file. Use with co_await inside an AsyncTask.
+		/// </summary>
+		/// <param name="filePath">Where is the file located?</param>
+		static ReadAwaitable ReadFileAsync(const string& filePath)
+		{
+			ReadAwaitable awaitable{};
+			awaitable.request.operation = AsyncFileOperation::OPERATION_READ;
+			awaitable.request.path = filePath;
+			return awaitable;
+		}
+
+		/// <summary>
+		/// Replace the contents of the file, creates it if it does not exist.
+		/// Use with co_await inside an AsyncTask.
+		/// </summary>
+		/// <param name="filePath">Where is the file located?</param>
+		/// <param name="data">Bytes that will be written to the file.</param>
+		static WriteAwaitable WriteFileAsync(const string& filePath, string data)
+		{
+			WriteAwaitable awaitable{};
+			awaitable.request.operation = AsyncFileOperation::OPERATION_WRITE;
+			awaitable.request.path = filePath;
+			awaitable.request.data = std::move(data);
+			return awaitable;
+		}
+
+		/// <summary>
+		/// Get the size and type of a file or folder.
+		/// Use with co_await inside an AsyncTask.
+		/// </summary>
+		/// <param name="targetPath">Where is the file or folder located?</param>
+		static StatAwaitable StatAsync(const string& targetPath)
+		{
+			StatAwaitable awaitable{};
+			awaitable.request.operation = AsyncFileOperation::OPERATION_STAT;
+			awaitable.request.path = targetPath;
+			return awaitable;
+		}
+	};
+}
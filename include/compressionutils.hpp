@@ -0,0 +1,197 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#ifdef _WIN32
+	#ifdef KALAUTILS_DLL_EXPORT
+		#define KALAUTILS_API __declspec(dllexport)
+	#else
+		#define KALAUTILS_API __declspec(dllimport)
+	#endif
+#else
+	#define KALAUTILS_API
+#endif
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iosfwd>
+#include <cstdint>
+#include <cstddef>
+
+namespace KalaKit
+{
+	using std::string;
+	using std::string_view;
+	using std::vector;
+	using std::ostream;
+	using std::istream;
+
+	/// <summary>
+	/// Incremental XXH32 hash, used for LZ4 frame header and content checksums.
+	/// </summary>
+	struct KALAUTILS_API XXH32State
+	{
+		uint32_t accumulators[4];
+		uint64_t totalLength;
+		unsigned char buffer[16];
+		uint32_t bufferSize;
+		uint32_t seed;
+
+		void Reset(uint32_t newSeed = 0);
+		void Update(const void* data, size_t size);
+		uint32_t Digest() const;
+	};
+
+	/// <summary>
+	/// Largest uncompressed block in a frame. Matches the LZ4 frame block max size IDs.
+	/// </summary>
+	enum class LZ4BlockSize : uint8_t
+	{
+		BLOCK_64KB = 4,
+		BLOCK_256KB = 5,
+		BLOCK_1MB = 6,
+		BLOCK_4MB = 7
+	};
+
+	/// <summary>
+	/// In-tree LZ4 block and frame compression. Output is compatible
+	/// with the reference LZ4 frame format, frames produced by other
+	/// LZ4 implementations can be decompressed as well.
+	/// </summary>
+	class KALAUTILS_API CompressionUtils
+	{
+	public:
+		/// <summary>
+		/// Worst case compressed size of a single block.
+		/// </summary>
+		static size_t CompressBound(size_t inputSize);
+
+		/// <summary>
+		/// Compress a single raw LZ4 block.
+		/// Returns the compressed size, or 0 if dst is too small.
+		/// </summary>
+		static size_t CompressBlock(
+			const char* src,
+			size_t srcSize,
+			char* dst,
+			size_t dstCapacity);
+
+		/// <summary>
+		/// Decompress a single raw LZ4 block. Malformed input is rejected,
+		/// never reads or writes outside the given buffers.
+		/// </summary>
+		/// <param name="outSize">How many bytes were written to dst.</param>
+		static bool DecompressBlock(
+			const char* src,
+			size_t srcSize,
+			char* dst,
+			size_t dstCapacity,
+			size_t& outSize);
+
+		/// <summary>
+		/// Compress data into a complete LZ4 frame with independent blocks.
+		/// With more than one thread the blocks are compressed in parallel,
+		/// the output is identical regardless of thread count.
+		/// </summary>
+		/// <param name="input">Data to compress.</param>
+		/// <param name="threadCount">Threads used for compression, 0 picks hardware concurrency.</param>
+		/// <param name="blockSize">Largest uncompressed size of each block.</param>
+		static string CompressFrame(
+			string_view input,
+			unsigned int threadCount = 1,
+			LZ4BlockSize blockSize = LZ4BlockSize::BLOCK_4MB);
+
+		/// <summary>
+		/// Decompress one or more concatenated LZ4 frames, skippable frames are ignored.
+		/// Frames with independent blocks are decompressed in parallel when threadCount is above 1.
+		/// </summary>
+		/// <param name="frame">Compressed data.</param>
+		/// <param name="output">Decompressed data is appended here.</param>
+		/// <param name="threadCount">Threads used for decompression, 0 picks hardware concurrency.</param>
+		/// <param name="maxOutputSize">Most bytes that may be appended to output, 0 means no limit.</param>
+		static bool DecompressFrame(
+			string_view frame,
+			string& output,
+			unsigned int threadCount = 1,
+			size_t maxOutputSize = 0);
+
+		static size_t GetBlockSizeBytes(LZ4BlockSize blockSize);
+	};
+
+	/// <summary>
+	/// Streams data into an LZ4 frame. Input is buffered until a full block
+	/// is available, then compressed and written to the stream.
+	/// </summary>
+	class KALAUTILS_API LZ4FrameWriter
+	{
+	public:
+		LZ4FrameWriter(ostream& output, LZ4BlockSize blockSize = LZ4BlockSize::BLOCK_256KB);
+		~LZ4FrameWriter();
+
+		LZ4FrameWriter(const LZ4FrameWriter&) = delete;
+		LZ4FrameWriter& operator=(const LZ4FrameWriter&) = delete;
+
+		bool Write(const void* data, size_t size);
+		/// <summary>
+		/// Write the last block, end mark and content checksum.
+		/// Called automatically on destruction if not called earlier.
+		/// </summary>
+		bool Finish();
+	private:
+		bool FlushBlock();
+
+		ostream& output;
+		size_t blockBytes;
+		vector<char> block;
+		vector<char> compressed;
+		XXH32State contentHash{};
+		bool isFinished = false;
+	};
+
+	/// <summary>
+	/// Streams decompressed data out of one or more LZ4 frames.
+	/// Supports both independent and linked blocks.
+	/// </summary>
+	class KALAUTILS_API LZ4FrameReader
+	{
+	public:
+		LZ4FrameReader(istream& input);
+
+		LZ4FrameReader(const LZ4FrameReader&) = delete;
+		LZ4FrameReader& operator=(const LZ4FrameReader&) = delete;
+
+		/// <summary>
+		/// Read up to capacity decompressed bytes. Returns 0 once
+		/// the stream has ended or an error was found.
+		/// </summary>
+		size_t Read(void* buffer, size_t capacity);
+
+		bool IsFinished() const { return isFinished; }
+		bool HasError() const { return hasError; }
+	private:
+		bool ReadFrameHeader();
+		bool ReadNextBlock();
+
+		istream& input;
+
+		//last 64KB of output in front of the current block for linked blocks
+		vector<char> window;
+		size_t windowStart = 0;
+		size_t windowEnd = 0;
+		vector<char> compressed;
+
+		size_t blockMaxSize = 0;
+		bool isInFrame = false;
+		bool isIndependent = true;
+		bool hasBlockChecksum = false;
+		bool hasContentChecksum = false;
+		XXH32State contentHash{};
+
+		bool isFinished = false;
+		bool hasError = false;
+	};
+}
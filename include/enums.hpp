@@ -5,8 +5,15 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace KalaKit
 {
+	/// <summary>
+	/// Key codes match the Win32 virtual-key codes, so Windows messages map
+	/// to keys directly while other platforms translate through a table.
+	/// Every code is below 0x200.
+	/// </summary>
 	enum class Key
 	{
 		// Letters
@@ -24,95 +31,95 @@ namespace KalaKit
 
 		// Symbols and punctuation (OEM)
 
-		Semicolon = VK_OEM_1,    // ;:
-		Equal = VK_OEM_PLUS,     // =+
-		Comma = VK_OEM_COMMA,    // ,<
-		Minus = VK_OEM_MINUS,    // -_
-		Period = VK_OEM_PERIOD,  // .>
-		Slash = VK_OEM_2,        // /?
-		Backtick = VK_OEM_3,     // `~
-		BracketLeft = VK_OEM_4,  // [{
-		Backslash = VK_OEM_5,    // \|
-		BracketRight = VK_OEM_6, // ]}
-		Apostrophe = VK_OEM_7,   // '"
-		Oem102 = VK_OEM_102,     // <> or \ (ISO)
+		Semicolon = 0xBA,    // ;:
+		Equal = 0xBB,        // =+
+		Comma = 0xBC,        // ,<
+		Minus = 0xBD,        // -_
+		Period = 0xBE,       // .>
+		Slash = 0xBF,        // /?
+		Backtick = 0xC0,     // `~
+		BracketLeft = 0xDB,  // [{
+		Backslash = 0xDC,    // \|
+		BracketRight = 0xDD, // ]}
+		Apostrophe = 0xDE,   // '"
+		Oem102 = 0xE2,       // <> or \ (ISO)
 
 		// Numpad
 
-		Numpad0 = VK_NUMPAD0,
-		Numpad1 = VK_NUMPAD1,
-		Numpad2 = VK_NUMPAD2,
-		Numpad3 = VK_NUMPAD3,
-		Numpad4 = VK_NUMPAD4,
-		Numpad5 = VK_NUMPAD5,
-		Numpad6 = VK_NUMPAD6,
-		Numpad7 = VK_NUMPAD7,
-		Numpad8 = VK_NUMPAD8,
-		Numpad9 = VK_NUMPAD9,
-		NumpadAdd = VK_ADD,
-		NumpadSubtract = VK_SUBTRACT,
-		NumpadMultiply = VK_MULTIPLY,
-		NumpadDivide = VK_DIVIDE,
-		NumpadDecimal = VK_DECIMAL,
-		NumLock = VK_NUMLOCK,
+		Numpad0 = 0x60,
+		Numpad1 = 0x61,
+		Numpad2 = 0x62,
+		Numpad3 = 0x63,
+		Numpad4 = 0x64,
+		Numpad5 = 0x65,
+		Numpad6 = 0x66,
+		Numpad7 = 0x67,
+		Numpad8 = 0x68,
+		Numpad9 = 0x69,
+		NumpadAdd = 0x6B,
+		NumpadSubtract = 0x6D,
+		NumpadMultiply = 0x6A,
+		NumpadDivide = 0x6F,
+		NumpadDecimal = 0x6E,
+		NumLock = 0x90,
 
 		// Function keys
 
-		F1 = VK_F1, F2 = VK_F2, F3 = VK_F3, F4 = VK_F4,
-		F5 = VK_F5, F6 = VK_F6, F7 = VK_F7, F8 = VK_F8,
-		F9 = VK_F9, F10 = VK_F10, F11 = VK_F11, F12 = VK_F12,
-		F13 = VK_F13, F14 = VK_F14, F15 = VK_F15, F16 = VK_F16,
-		F17 = VK_F17, F18 = VK_F18, F19 = VK_F19, F20 = VK_F20,
-		F21 = VK_F21, F22 = VK_F22, F23 = VK_F23, F24 = VK_F24,
+		F1 = 0x70, F2 = 0x71, F3 = 0x72, F4 = 0x73,
+		F5 = 0x74, F6 = 0x75, F7 = 0x76, F8 = 0x77,
+		F9 = 0x78, F10 = 0x79, F11 = 0x7A, F12 = 0x7B,
+		F13 = 0x7C, F14 = 0x7D, F15 = 0x7E, F16 = 0x7F,
+		F17 = 0x80, F18 = 0x81, F19 = 0x82, F20 = 0x83,
+		F21 = 0x84, F22 = 0x85, F23 = 0x86, F24 = 0x87,
 
 		// Control / navigation
 
-		Escape = VK_ESCAPE,
-		Enter = VK_RETURN,
-		Tab = VK_TAB,
-		Backspace = VK_BACK,
-		Insert = VK_INSERT,
-		Delete = VK_DELETE,
-		Home = VK_HOME,
-		End = VK_END,
-		PageUp = VK_PRIOR,
-		PageDown = VK_NEXT,
+		Escape = 0x1B,
+		Enter = 0x0D,
+		Tab = 0x09,
+		Backspace = 0x08,
+		Insert = 0x2D,
+		Delete = 0x2E,
+		Home = 0x24,
+		End = 0x23,
+		PageUp = 0x21,
+		PageDown = 0x22,
 
 		// Modifier keys
 
-		LeftShift = VK_LSHIFT,
-		RightShift = VK_RSHIFT,
-		LeftControl = VK_LCONTROL,
-		RightControl = VK_RCONTROL,
-		LeftAlt = VK_LMENU,
-		RightAlt = VK_RMENU,
-		CapsLock = VK_CAPITAL,
+		LeftShift = 0xA0,
+		RightShift = 0xA1,
+		LeftControl = 0xA2,
+		RightControl = 0xA3,
+		LeftAlt = 0xA4,
+		RightAlt = 0xA5,
+		CapsLock = 0x14,
 
 		// System keys
 
-		PrintScreen = VK_SNAPSHOT,
-		ScrollLock = VK_SCROLL,
-		Pause = VK_PAUSE,
-		Menu = VK_APPS,
+		PrintScreen = 0x2C,
+		ScrollLock = 0x91,
+		Pause = 0x13,
+		Menu = 0x5D,
 
 		// Arrow keys
 
-		Up = VK_UP,
-		Down = VK_DOWN,
-		Left = VK_LEFT,
-		Right = VK_RIGHT,
+		Up = 0x26,
+		Down = 0x28,
+		Left = 0x25,
+		Right = 0x27,
 
 		// Spacebar
 
-		Space = VK_SPACE,
+		Space = 0x20,
 
 		// Mouse buttons
 
-		MouseLeft = VK_LBUTTON,
-		MouseRight = VK_RBUTTON,
-		MouseMiddle = VK_MBUTTON,
-		MouseX1 = VK_XBUTTON1,
-		MouseX2 = VK_XBUTTON2,
+		MouseLeft = 0x01,
+		MouseRight = 0x02,
+		MouseMiddle = 0x04,
+		MouseX1 = 0x05,
+		MouseX2 = 0x06,
 
 		// Extended mouse buttons
 
@@ -127,71 +134,88 @@ namespace KalaKit
 
 		// Media & browser keys
 
-		MediaPlayPause = VK_MEDIA_PLAY_PAUSE,
-		MediaStop = VK_MEDIA_STOP,
-		MediaNextTrack = VK_MEDIA_NEXT_TRACK,
-		MediaPrevTrack = VK_MEDIA_PREV_TRACK,
-		VolumeUp = VK_VOLUME_UP,
-		VolumeDown = VK_VOLUME_DOWN,
-		VolumeMute = VK_VOLUME_MUTE,
-		LaunchMail = VK_LAUNCH_MAIL,
-		LaunchApp1 = VK_LAUNCH_APP1,
-		LaunchApp2 = VK_LAUNCH_APP2,
-		BrowserBack = VK_BROWSER_BACK,
-		BrowserForward = VK_BROWSER_FORWARD,
-		BrowserRefresh = VK_BROWSER_REFRESH,
-		BrowserStop = VK_BROWSER_STOP,
-		BrowserSearch = VK_BROWSER_SEARCH,
-		BrowserFavorites = VK_BROWSER_FAVORITES,
-		BrowserHome = VK_BROWSER_HOME
+		MediaPlayPause = 0xB3,
+		MediaStop = 0xB2,
+		MediaNextTrack = 0xB0,
+		MediaPrevTrack = 0xB1,
+		VolumeUp = 0xAF,
+		VolumeDown = 0xAE,
+		VolumeMute = 0xAD,
+		LaunchMail = 0xB4,
+		LaunchApp1 = 0xB6,
+		LaunchApp2 = 0xB7,
+		BrowserBack = 0xA6,
+		BrowserForward = 0xA7,
+		BrowserRefresh = 0xA8,
+		BrowserStop = 0xA9,
+		BrowserSearch = 0xAA,
+		BrowserFavorites = 0xAB,
+		BrowserHome = 0xAC
 	};
 
 	/// <summary>
-	/// Debug message type printed to console. These are usable 
-	/// only if your program is in Debug mode and most of these,
-	/// except those marked with the (required ...) part requires
+	/// Debug message types printed to console, combine them with | to print
+	/// several at once. These are usable only if your program is in Debug mode
+	/// and most of these, except those marked with the (required ...) part requires
 	/// that one of its function type is assigned somewhere in 
 	/// your program code for them to actually return something.
 	/// </summary>
-	enum class DebugType
+	enum class DebugType : uint32_t
 	{
-		DEBUG_NONE,                    //Default option, assigning this does nothing
+		DEBUG_NONE = 0,                          //Default option, assigning this does nothing
 
 		//
 		// INPUT ENUMS
 		//
 
-		DEBUG_KEY_HELD,                //Print key held updates (requires IsKeyDown)
-		DEBUG_KEY_PRESSED,             //Print key pressed updates (requires WasKeyPressed)
-		DEBUG_COMBO_PRESSED,           //Print combo pressed updates (requires WasComboPressed)
-		DEBUG_DOUBLE_CLICKED,          //Print mouse double click updates (requires WasDoubleClicked)
-		DEBUG_IS_MOUSE_DRAGGING,       //Print mouse dragging updates (requires IsMouseDragging)
-		DEBUG_MOUSE_POSITION,          //Print mouse position updates (requires GetMousePosition)
-		DEBUG_MOUSE_DELTA,             //Print regular mouse delta updates (requires GetMouseDelta)
-		DEBUG_RAW_MOUSE_DELTA,         //Print raw mouse delta updates (requires GetRawMouseDelta)
-		DEBUG_MOUSE_WHEEL_DELTA,       //Print scroll wheel updates (requires GetMouseWheelDelta)
-		DEBUG_MOUSE_VISIBILITY,        //Print scroll mouse visibility updates (requires SetMouseVisibility)
-		DEBUG_MOUSE_LOCK_STATE,        //Print scroll lock state updates (requires SetMouseLockState)
-		DEBUG_PROCESS_MESSAGE_TEST,    //Print all processing messages user input sends
+		DEBUG_KEY_HELD = 1u << 0,                //Print key held updates (requires IsKeyDown)
+		DEBUG_KEY_PRESSED = 1u << 1,             //Print key pressed updates (requires WasKeyPressed)
+		DEBUG_COMBO_PRESSED = 1u << 2,           //Print combo pressed updates (requires WasComboPressed)
+		DEBUG_DOUBLE_CLICKED = 1u << 3,          //Print mouse double click updates (requires WasDoubleClicked)
+		DEBUG_IS_MOUSE_DRAGGING = 1u << 4,       //Print mouse dragging updates (requires IsMouseDragging)
+		DEBUG_MOUSE_POSITION = 1u << 5,          //Print mouse position updates (requires GetMousePosition)
+		DEBUG_MOUSE_DELTA = 1u << 6,             //Print regular mouse delta updates (requires GetMouseDelta)
+		DEBUG_RAW_MOUSE_DELTA = 1u << 7,         //Print raw mouse delta updates (requires GetRawMouseDelta)
+		DEBUG_MOUSE_WHEEL_DELTA = 1u << 8,       //Print scroll wheel updates (requires GetMouseWheelDelta)
+		DEBUG_MOUSE_VISIBILITY = 1u << 9,        //Print scroll mouse visibility updates (requires SetMouseVisibility)
+		DEBUG_MOUSE_LOCK_STATE = 1u << 10,       //Print scroll lock state updates (requires SetMouseLockState)
+		DEBUG_PROCESS_MESSAGE_TEST = 1u << 11,   //Print all processing messages user input sends
 
 		//
 		// WINDOW ENUMS
 		//
 
-		DEBUG_WINDOW_TITLE,            //Print window title change updates (requires SetWindowTitle)
-		DEBUG_WINDOW_BORDERLESS_STATE, //Print window borderless state updates (requires SetWindowBorderlessState)
-		DEBUG_WINDOW_HIDDEN_STATE,     //Print window hidden state updates (requires SetWindowHiddenState)
-		DEBUG_WINDOW_SET_POSITION,     //Print window position updates (requires SetWindowPosition)
-		DEBUG_WINDOW_SET_FULL_SIZE,    //Print window full size updates (requires SetWindowFullSize)
-		DEBUG_WIŃDOW_SET_CONTENT_SIZE, //Print window content size updates (requires GetWindowContentSize)
-		DEBUG_WINDOW_SET_MINMAX_SIZE,  //Print new min and max window size whenever it is updated (requires SetMinMaxSize)
-		DEBUG_WINDOW_RESIZE,           //Print new resolution whenever window rescales
-		DEBUG_WINDOW_REPAINT,          //Print new color whenever window repaints
-		DEBUG_WINDOW_CORNER_EDGE,      //Print ID code and name of each corner and edge when cursor goes over it
-
-		DEBUG_ALL                      //Print ALL debug updates
+		DEBUG_WINDOW_TITLE = 1u << 16,            //Print window title change updates (requires SetWindowTitle)
+		DEBUG_WINDOW_BORDERLESS_STATE = 1u << 17, //Print window borderless state updates (requires SetWindowBorderlessState)
+		DEBUG_WINDOW_HIDDEN_STATE = 1u << 18,     //Print window hidden state updates (requires SetWindowHiddenState)
+		DEBUG_WINDOW_SET_POSITION = 1u << 19,     //Print window position updates (requires SetWindowPosition)
+		DEBUG_WINDOW_SET_FULL_SIZE = 1u << 20,    //Print window full size updates (requires SetWindowFullSize)
+		DEBUG_WINDOW_SET_CONTENT_SIZE = 1u << 21, //Print window content size updates (requires GetWindowContentSize)
+		DEBUG_WINDOW_SET_MINMAX_SIZE = 1u << 22,  //Print new min and max window size whenever it is updated (requires SetMinMaxSize)
+		DEBUG_WINDOW_RESIZE = 1u << 23,           //Print new resolution whenever window rescales
+		DEBUG_WINDOW_REPAINT = 1u << 24,          //Print new color whenever window repaints
+		DEBUG_WINDOW_CORNER_EDGE = 1u << 25,      //Print ID code and name of each corner and edge when cursor goes over it
+
+		DEBUG_INPUT_ALL = 0x0000FFFFu,            //Print all input debug updates
+		DEBUG_WINDOW_ALL = 0xFFFF0000u,           //Print all window debug updates
+		DEBUG_ALL = 0xFFFFFFFFu                   //Print ALL debug updates
 	};
 
+	constexpr DebugType operator|(DebugType a, DebugType b)
+	{
+		return static_cast<DebugType>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+	}
+	constexpr DebugType operator&(DebugType a, DebugType b)
+	{
+		return static_cast<DebugType>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
+	}
+	constexpr DebugType operator~(DebugType a)
+	{
+		return static_cast<DebugType>(~static_cast<uint32_t>(a));
+	}
+	constexpr DebugType& operator|=(DebugType& a, DebugType b) { return a = a | b; }
+	constexpr DebugType& operator&=(DebugType& a, DebugType b) { return a = a & b; }
+
 	/// <summary>
 	/// A state the window can be switched to from its current state.
 	/// </summary>
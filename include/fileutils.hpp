@@ -98,6 +98,15 @@ namespace KalaKit
 			const path& folderPath,
 			const string& fileName,
 			const string& extension = "");
+
+		/// <summary>
+		/// Pack every file inside the folder and its subfolders into a single pack file.
+		/// Entries are named by their path relative to the folder with forward slashes.
+		/// Open the result with PackFile.
+		/// </summary>
+		/// <param name="folderPath">Full path to the folder that will be packed.</param>
+		/// <param name="packPath">Full path to the pack file that will be created or overwritten.</param>
+		static bool PackDirectory(const string& folderPath, const string& packPath);
 	private:
 		static string GetValueBetweenParentheses(const string& input);
 	};
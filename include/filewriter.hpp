@@ -0,0 +1,125 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#ifdef _WIN32
+	#ifdef KALAUTILS_DLL_EXPORT
+		#define KALAUTILS_API __declspec(dllexport)
+	#else
+		#define KALAUTILS_API __declspec(dllimport)
+	#endif
+#else
+	#define KALAUTILS_API
+#endif
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace KalaKit
+{
+	using std::string;
+	using std::string_view;
+	using std::vector;
+
+	struct FileWriterOptions
+	{
+		//size of the aligned write buffer, rounded up to a multiple of 4KB
+		size_t bufferSize = size_t(1) << 20;
+		//bypass the page cache, the unaligned tail is written normally on commit
+		bool useDirectIO = false;
+		//reserve this many bytes up front to avoid fragmentation, 0 skips it
+		uint64_t preallocateSize = 0;
+		//write to a temporary file and rename it over the target on commit
+		bool isAtomic = true;
+	};
+
+	/// <summary>
+	/// Buffered file writer for large outputs. Small writes are gathered into
+	/// an aligned buffer, large writes go out together with the buffered bytes
+	/// in a single vectored write. Atomic writers only replace the target on
+	/// Commit, so readers never see a half written file.
+	/// </summary>
+	class KALAUTILS_API FileWriter
+	{
+	public:
+		FileWriter() = default;
+		/// <summary>
+		/// Discards the temporary file of an uncommitted atomic writer,
+		/// non-atomic writers are flushed and closed without syncing.
+		/// </summary>
+		~FileWriter();
+
+		FileWriter(const FileWriter&) = delete;
+		FileWriter& operator=(const FileWriter&) = delete;
+
+		/// <summary>
+		/// Create or truncate the file and prepare it for writing.
+		/// </summary>
+		/// <param name="filePath">Full path to the file that will be written.</param>
+		bool Open(const string& filePath, const FileWriterOptions& options = {});
+
+		bool Write(const void* data, size_t size);
+		bool Write(string_view data) { return Write(data.data(), data.size()); }
+
+		/// <summary>
+		/// Hand all buffered bytes to the OS. Direct IO writers keep the
+		/// unaligned tail buffered until Commit.
+		/// </summary>
+		bool Flush();
+
+		/// <summary>
+		/// Write everything, optionally make it durable and move the file into place.
+		/// The writer is closed afterwards.
+		/// </summary>
+		/// <param name="sync">Wait for the data and the rename to reach the disk.</param>
+		bool Commit(bool sync = true);
+
+		/// <summary>
+		/// Close the writer and delete the temporary file of an atomic writer.
+		/// </summary>
+		void Abort();
+
+		/// <summary>
+		/// Commit many writers at once. Writeback of every file is started before
+		/// waiting on any of them, and each parent folder is synced only once
+		/// after all files have been renamed.
+		/// </summary>
+		static bool CommitAll(const vector<FileWriter*>& writers, bool sync = true);
+
+		bool IsOpen() const;
+		uint64_t GetBytesWritten() const { return fileOffset + bufferSize; }
+		const string& GetPath() const { return targetPath; }
+	private:
+		bool WriteToFile(const char* first, size_t firstSize, const char* second, size_t secondSize);
+		bool FinishWrites();
+		bool SyncData();
+		bool CloseFile();
+		bool Publish();
+		void Release();
+		//cleanup of a failed or aborted writer, also works after the file was closed
+		void Discard();
+
+		string targetPath;
+		string tempPath;
+		FileWriterOptions options{};
+
+		char* buffer = nullptr;
+		size_t bufferCapacity = 0;
+		size_t bufferSize = 0;
+		//bytes already handed to the OS
+		uint64_t fileOffset = 0;
+		bool isDirect = false;
+
+#ifdef _WIN32
+		void* handle = nullptr;
+#else
+		int fd = -1;
+#endif
+	};
+}
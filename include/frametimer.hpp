@@ -0,0 +1,127 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#ifdef _WIN32
+	#ifdef KALAUTILS_DLL_EXPORT
+		#define KALAUTILS_API __declspec(dllexport)
+	#else
+		#define KALAUTILS_API __declspec(dllimport)
+	#endif
+#else
+	#define KALAUTILS_API
+#endif
+
+#include <cstdint>
+#include <cstddef>
+
+namespace KalaKit
+{
+	struct KALAUTILS_API FrameStats
+	{
+		size_t sampleCount;
+		//all values are in nanoseconds
+		uint64_t mean;
+		uint64_t p99;
+		uint64_t min;
+		uint64_t max;
+		//standard deviation of the frame time
+		uint64_t jitter;
+		//how far frame starts landed from their target time, only measured while pacing
+		uint64_t pacingErrorMean;
+		uint64_t pacingErrorMax;
+	};
+
+	/// <summary>
+	/// Measures and regulates frames of the main loop.
+	/// Call BeginFrame once at the start of every frame, it waits until the target
+	/// frame time has passed by sleeping most of the wait and spinning the rest,
+	/// then updates the delta time, the fixed timestep accumulator and the statistics.
+	/// </summary>
+	class KALAUTILS_API FrameTimer
+	{
+	public:
+		//how many recent frames the statistics are taken from
+		static constexpr size_t historySize = 256;
+
+		/// <summary>
+		/// Monotonic steady clock time in nanoseconds, the same clock as input event timestamps.
+		/// </summary>
+		static uint64_t Now();
+
+		/// <summary>
+		/// Frames per second BeginFrame paces to, 0 runs unlimited.
+		/// </summary>
+		void SetTargetRate(double framesPerSecond);
+		double GetTargetRate() const;
+
+		/// <summary>
+		/// How close to the target time sleeping stops and spinning starts.
+		/// Raised automatically while the OS oversleeps by more than this.
+		/// </summary>
+		void SetSpinThreshold(uint64_t nanoseconds) { spinThreshold = nanoseconds; sleepMargin = nanoseconds; }
+		uint64_t GetSpinThreshold() const { return spinThreshold; }
+
+		/// <summary>
+		/// Length of one fixed update step in seconds.
+		/// </summary>
+		void SetFixedTimestep(double seconds);
+		double GetFixedTimestep() const { return static_cast<double>(fixedStep) / 1e9; }
+
+		/// <summary>
+		/// Most fixed steps a single frame can queue, so a long stall
+		/// cannot make every following frame fall further behind.
+		/// </summary>
+		void SetMaxFixedSteps(uint32_t newMaxFixedSteps) { maxFixedSteps = newMaxFixedSteps; }
+
+		/// <summary>
+		/// Start of a new frame. Waits for the target frame time, then measures the frame.
+		/// Returns the time since the previous BeginFrame call in seconds.
+		/// </summary>
+		double BeginFrame();
+
+		/// <summary>
+		/// Returns true and removes one step from the accumulator while a whole fixed step is queued.
+		/// Use as: while (timer.ConsumeFixedStep()) Update(timer.GetFixedTimestep());
+		/// </summary>
+		bool ConsumeFixedStep();
+		/// <summary>
+		/// How far the accumulator is into the next fixed step, 0 - 1, for interpolating rendered state.
+		/// </summary>
+		double GetFixedAlpha() const;
+
+		double GetDeltaTime() const { return static_cast<double>(frameTime) / 1e9; }
+		uint64_t GetFrameCount() const { return frameCount; }
+
+		FrameStats GetStats() const;
+
+		/// <summary>
+		/// Forget all measured frames, the next BeginFrame starts timing from scratch.
+		/// </summary>
+		void Reset();
+	private:
+		void WaitUntil(uint64_t deadline);
+
+		//nanoseconds per frame, 0 if unpaced
+		uint64_t targetPeriod = 0;
+		uint64_t spinThreshold = 2000000;
+		//spin threshold plus the recently measured oversleep
+		uint64_t sleepMargin = 2000000;
+
+		uint64_t fixedStep = 16666667;
+		uint64_t accumulator = 0;
+		uint32_t maxFixedSteps = 8;
+
+		uint64_t lastFrameStart = 0;
+		uint64_t nextDeadline = 0;
+		uint64_t frameTime = 0;
+		uint64_t frameCount = 0;
+
+		uint64_t frameTimes[historySize]{};
+		uint64_t pacingErrors[historySize]{};
+		size_t pacedCount = 0;
+	};
+}
@@ -0,0 +1,134 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#ifdef _WIN32
+	#ifdef KALAUTILS_DLL_EXPORT
+		#define KALAUTILS_API __declspec(dllexport)
+	#else
+		#define KALAUTILS_API __declspec(dllimport)
+	#endif
+#else
+	#define KALAUTILS_API
+#endif
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "osutils.hpp"
+#include "enums.hpp"
+#include "inpututils.hpp"
+
+namespace KalaKit
+{
+	using std::string;
+	using std::vector;
+
+	/// <summary>
+	/// Platform side of input. A backend feeds events into the InputUtils
+	/// event queue and applies cursor changes requested through InputUtils,
+	/// the key and mouse state logic itself never touches the OS.
+	/// </summary>
+	class KALAUTILS_API InputBackend
+	{
+	public:
+		virtual ~InputBackend() = default;
+
+		/// <summary>
+		/// Push every pending OS event into the InputUtils event queue.
+		/// Called by InputUtils::ProcessEvents before the queue is drained.
+		/// </summary>
+		virtual void PollEvents() = 0;
+
+		virtual void SetCursorVisible(bool isVisible) = 0;
+		/// <summary>
+		/// Confine the cursor to the window, or release it.
+		/// </summary>
+		virtual void SetCursorLocked(bool isLocked) = 0;
+		virtual void CenterCursor() = 0;
+
+		virtual const char* GetName() const = 0;
+	};
+
+#ifdef _WIN32
+	/// <summary>
+	/// Cursor control through the Win32 API. Key and mouse events are still
+	/// pushed by the window procedure, so PollEvents has nothing to do.
+	/// </summary>
+	class KALAUTILS_API Win32InputBackend : public InputBackend
+	{
+	public:
+		void PollEvents() override {}
+		void SetCursorVisible(bool isVisible) override;
+		void SetCursorLocked(bool isLocked) override;
+		void CenterCursor() override;
+		const char* GetName() const override { return "Win32"; }
+	};
+#endif
+
+	/// <summary>
+	/// Backend without any OS connection. Injected events are queued
+	/// on the next poll and cursor requests are only recorded,
+	/// which allows running input logic in tests and benchmarks without a display.
+	/// </summary>
+	class KALAUTILS_API SyntheticInputBackend : public InputBackend
+	{
+	public:
+		void InjectKey(Key key, bool isDown, uint64_t timestamp = 0);
+		void InjectMouseMove(POS delta, uint64_t timestamp = 0);
+		void InjectMousePosition(POS position, uint64_t timestamp = 0);
+		void InjectRawMouseMove(POS delta, uint64_t timestamp = 0);
+		void InjectMouseWheel(int delta, uint64_t timestamp = 0);
+
+		void PollEvents() override;
+		void SetCursorVisible(bool isVisible) override { isCursorVisible = isVisible; }
+		void SetCursorLocked(bool isLocked) override { isCursorLocked = isLocked; }
+		void CenterCursor() override { centerCount++; }
+		const char* GetName() const override { return "Synthetic"; }
+
+		bool IsCursorVisible() const { return isCursorVisible; }
+		bool IsCursorLocked() const { return isCursorLocked; }
+		uint64_t GetCenterCount() const { return centerCount; }
+	private:
+		vector<InputEvent> pendingEvents{};
+		bool isCursorVisible = true;
+		bool isCursorLocked = false;
+		uint64_t centerCount = 0;
+	};
+
+#ifdef __linux__
+	/// <summary>
+	/// Reads keyboard and mouse events straight from /dev/input/event* devices.
+	/// Needs read access to the devices, usually through the 'input' group.
+	/// Has no cursor of its own, so cursor requests are ignored.
+	/// </summary>
+	class KALAUTILS_API EvdevInputBackend : public InputBackend
+	{
+	public:
+		EvdevInputBackend() = default;
+		~EvdevInputBackend() override;
+
+		EvdevInputBackend(const EvdevInputBackend&) = delete;
+		EvdevInputBackend& operator=(const EvdevInputBackend&) = delete;
+
+		/// <summary>
+		/// Start reading from a device, can be called for several devices.
+		/// </summary>
+		/// <param name="devicePath">Full path to the device, such as /dev/input/event3.</param>
+		bool AddDevice(const string& devicePath);
+		void CloseDevices();
+
+		void PollEvents() override;
+		void SetCursorVisible(bool) override {}
+		void SetCursorLocked(bool) override {}
+		void CenterCursor() override {}
+		const char* GetName() const override { return "Evdev"; }
+	private:
+		vector<int> devices{};
+	};
+#endif
+}
@@ -0,0 +1,79 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#ifdef _WIN32
+	#ifdef KALAUTILS_DLL_EXPORT
+		#define KALAUTILS_API __declspec(dllexport)
+	#else
+		#define KALAUTILS_API __declspec(dllimport)
+	#endif
+#else
+	#define KALAUTILS_API
+#endif
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include "inpututils.hpp"
+
+namespace KalaKit
+{
+	using std::string;
+	using std::atomic;
+
+	struct KALAUTILS_API LatencyStats
+	{
+		uint64_t count;
+		//all values are in nanoseconds
+		uint64_t p50;
+		uint64_t p99;
+		uint64_t max;
+		uint64_t mean;
+		//events that were applied but never read by a query before the next frame
+		uint64_t unconsumed;
+	};
+
+	/// <summary>
+	/// Histograms of how long input events wait between arriving in the
+	/// event queue and the first InputUtils query that sees them, per event type.
+	/// Recording is lock-free and costs a single relaxed load while disabled.
+	/// </summary>
+	class KALAUTILS_API InputLatency
+	{
+	public:
+		static bool IsEnabled() { return isEnabled.load(std::memory_order_relaxed); }
+		static void SetEnabled(bool newEnabledState) { isEnabled.store(newEnabledState, std::memory_order_relaxed); }
+
+		/// <summary>
+		/// Add one measured latency. Called by InputUtils, safe from any thread.
+		/// </summary>
+		static void Record(InputEventType type, uint64_t latency);
+
+		/// <summary>
+		/// Count events that were never queried, they are kept out of the histogram.
+		/// Called by InputUtils, safe from any thread.
+		/// </summary>
+		static void RecordUnconsumed(InputEventType type, uint64_t count = 1);
+
+		/// <summary>
+		/// Percentiles are accurate to within 25% of the value, max and mean are exact.
+		/// </summary>
+		static LatencyStats GetStats(InputEventType type);
+
+		/// <summary>
+		/// Stats of every event type as a JSON object keyed by event type name.
+		/// </summary>
+		static string ToJson();
+		static bool DumpJson(const string& filePath);
+
+		static void Reset();
+	private:
+		static inline atomic<bool> isEnabled{ false };
+	};
+}
@@ -0,0 +1,78 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#ifdef _WIN32
+	#ifdef KALAUTILS_DLL_EXPORT
+		#define KALAUTILS_API __declspec(dllexport)
+	#else
+		#define KALAUTILS_API __declspec(dllimport)
+	#endif
+#else
+	#define KALAUTILS_API
+#endif
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+#include "inpututils.hpp"
+
+namespace KalaKit
+{
+	using std::string;
+	using std::vector;
+	using std::function;
+
+	/// <summary>
+	/// Records the input event stream applied by InputUtils::ProcessEvents into a
+	/// compact binary file and feeds it back later, frame by frame or at full speed.
+	/// Replay only goes through the input event queue, so it needs no window.
+	/// </summary>
+	class KALAUTILS_API InputRecorder
+	{
+	public:
+		/// <summary>
+		/// Start writing every processed frame to the file. Overwrites existing files.
+		/// </summary>
+		/// <param name="filePath">Full path to the recording that will be created.</param>
+		static bool StartRecording(const string& filePath);
+		/// <summary>
+		/// Write the remaining buffered frames and close the recording.
+		/// </summary>
+		static bool StopRecording();
+		static bool IsRecording();
+
+		/// <summary>
+		/// Load a recording for replay.
+		/// </summary>
+		/// <param name="filePath">Full path to an existing recording.</param>
+		static bool StartReplay(const string& filePath);
+		static void StopReplay();
+		static bool IsReplaying();
+
+		/// <summary>
+		/// Queue the events of the next recorded frame with their original timestamps,
+		/// then call InputUtils::ProcessEvents as usual. Returns false once the recording has ended,
+		/// is damaged or a frame holds more events than the input queue can take.
+		/// </summary>
+		static bool ReplayFrame();
+
+		/// <summary>
+		/// Replay every remaining frame as fast as possible. Each frame is processed,
+		/// passed to the callback and reset, just like a regular update loop.
+		/// Returns how many frames were replayed.
+		/// </summary>
+		static uint64_t ReplayAll(const function<void()>& onFrame);
+
+		/// <summary>
+		/// Append one processed frame to the recording.
+		/// Called by InputUtils::ProcessEvents, should not be called manually.
+		/// </summary>
+		static void RecordFrame(const vector<InputEvent>& events, uint64_t frameTimestamp);
+	};
+}
@@ -16,17 +16,215 @@
 #endif
 
 #include <initializer_list>
-#include <unordered_map>
 #include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <bit>
 
 #include "osutils.hpp"
 #include "enums.hpp"
+#include "spscqueue.hpp"
+#include "seqlock.hpp"
 
 namespace KalaKit
 {
 	using std::initializer_list;
-	using std::unordered_map;
 	using std::string;
+	using std::vector;
+	using std::atomic;
+
+	class InputBackend;
+
+	/// <summary>
+	/// Fixed size set of key codes 0x000 - 0x1FF with one bit per key.
+	/// Queries never allocate and whole-set operations work on 64 keys at a time.
+	/// </summary>
+	struct KALAUTILS_API KeyBitset
+	{
+		static constexpr size_t keyCount = 0x200;
+		static constexpr size_t wordCount = keyCount / 64;
+
+		uint64_t words[wordCount]{};
+
+		void Set(Key key)
+		{
+			size_t index = ToIndex(key);
+			words[index >> 6] |= uint64_t(1) << (index & 63);
+		}
+		void Reset(Key key)
+		{
+			size_t index = ToIndex(key);
+			words[index >> 6] &= ~(uint64_t(1) << (index & 63));
+		}
+		bool Test(Key key) const
+		{
+			size_t index = ToIndex(key);
+			return (words[index >> 6] >> (index & 63)) & 1;
+		}
+
+		bool Any() const
+		{
+			uint64_t combined = 0;
+			for (uint64_t word : words) combined |= word;
+			return combined != 0;
+		}
+		size_t Count() const
+		{
+			size_t count = 0;
+			for (uint64_t word : words) count += static_cast<size_t>(std::popcount(word));
+			return count;
+		}
+		void ClearAll()
+		{
+			for (uint64_t& word : words) word = 0;
+		}
+
+		/// <summary>
+		/// Call the callback for every key in the set, in ascending key code order.
+		/// </summary>
+		template <typename Callback>
+		void ForEach(Callback&& callback) const
+		{
+			for (size_t i = 0; i < wordCount; i++)
+			{
+				uint64_t word = words[i];
+				while (word != 0)
+				{
+					size_t bit = static_cast<size_t>(std::countr_zero(word));
+					word &= word - 1;
+					callback(static_cast<Key>(i * 64 + bit));
+				}
+			}
+		}
+	private:
+		//codes outside the range wrap around instead of writing out of bounds
+		static size_t ToIndex(Key key) { return static_cast<size_t>(key) & (keyCount - 1); }
+	};
+
+	enum class InputEventType : uint8_t
+	{
+		KEY_PRESSED,    //keyboard key or mouse button went down
+		KEY_RELEASED,   //keyboard key or mouse button went up
+		MOUSE_MOVE,     //cursor moved by x, y in client space
+		MOUSE_POSITION, //cursor is now at x, y in client space
+		RAW_MOUSE_MOVE, //raw hardware motion of x, y
+		MOUSE_WHEEL     //wheel moved by x steps
+	};
+
+	/// <summary>
+	/// Single input event as reported by the platform layer.
+	/// </summary>
+	struct KALAUTILS_API InputEvent
+	{
+		//steady clock nanoseconds when the event happened
+		uint64_t timestamp;
+		InputEventType type;
+		Key key;
+		int x;
+		int y;
+	};
+
+	struct KALAUTILS_API RawMouseSample
+	{
+		//steady clock nanoseconds when the motion happened
+		uint64_t timestamp;
+		int x;
+		int y;
+	};
+
+	struct KALAUTILS_API MouseVelocity
+	{
+		//pixels per second
+		float x;
+		float y;
+	};
+
+	/// <summary>
+	/// Fixed capacity ring of raw mouse motion samples. Keeps every sample
+	/// of the current frame and as many older ones as fit, so high polling
+	/// rate mice can be smoothed below frame granularity.
+	/// </summary>
+	class KALAUTILS_API RawMouseHistory
+	{
+	public:
+		//one second of samples at 8 kHz
+		static constexpr size_t capacity = 8192;
+
+		void Push(const RawMouseSample& sample);
+		/// <summary>
+		/// Start a new frame, samples pushed after this belong to the new frame.
+		/// </summary>
+		void BeginFrame() { frameStart = totalCount; }
+		void Clear();
+
+		/// <summary>
+		/// How many samples arrived this frame, atmost the capacity.
+		/// </summary>
+		size_t GetFrameSampleCount() const;
+		/// <summary>
+		/// Sample of this frame by index, 0 is the oldest.
+		/// </summary>
+		const RawMouseSample& GetFrameSample(size_t index) const;
+
+		/// <summary>
+		/// Call the callback for every sample of this frame, oldest first.
+		/// </summary>
+		template <typename Callback>
+		void ForEachFrameSample(Callback&& callback) const
+		{
+			size_t count = GetFrameSampleCount();
+			for (size_t i = 0; i < count; i++)
+			{
+				callback(GetFrameSample(i));
+			}
+		}
+
+		/// <summary>
+		/// Sum of all motion with a timestamp after startTime and up to endTime.
+		/// Only samples still inside the ring are counted.
+		/// </summary>
+		POS Integrate(uint64_t startTime, uint64_t endTime) const;
+
+		/// <summary>
+		/// Average velocity over the window ending at endTime,
+		/// an endTime of 0 uses the timestamp of the newest sample.
+		/// </summary>
+		/// <param name="window">Length of the window in nanoseconds.</param>
+		MouseVelocity GetVelocity(uint64_t window, uint64_t endTime = 0) const;
+
+		uint64_t GetNewestTimestamp() const;
+	private:
+		RawMouseSample samples[capacity]{};
+		//how many samples were ever pushed, the newest is at (totalCount - 1) % capacity
+		uint64_t totalCount = 0;
+		uint64_t frameStart = 0;
+	};
+
+	/// <summary>
+	/// Immutable copy of the input state of one frame,
+	/// safe to read from any thread through InputUtils::GetSnapshot.
+	/// </summary>
+	struct KALAUTILS_API InputSnapshot
+	{
+		//how many frames were published before this one
+		uint64_t frameIndex;
+		//steady clock nanoseconds when the frame was published
+		uint64_t timestamp;
+
+		KeyBitset heldKeys;
+		KeyBitset pressedKeys;
+		KeyBitset changedKeys;
+
+		POS mousePosition;
+		POS mouseDelta;
+		POS rawMouseDelta;
+		int mouseWheelDelta;
+
+		bool isMouseVisible;
+		bool isMouseLocked;
+	};
 
 	class KALAUTILS_API InputUtils
 	{
@@ -40,6 +238,28 @@ namespace KalaKit
 		/// </summary>
 		static bool IsKeyPressed(Key key);
 
+		/// <summary>
+		/// Return true if any key was pressed this frame.
+		/// </summary>
+		static bool IsAnyKeyPressed() { return keyPressed.Any(); }
+		/// <summary>
+		/// Return true if any key is currently held down.
+		/// </summary>
+		static bool IsAnyKeyHeld() { return keyHeld.Any(); }
+
+		/// <summary>
+		/// Every key that is currently held down.
+		/// </summary>
+		static const KeyBitset& GetHeldKeys() { return keyHeld; }
+		/// <summary>
+		/// Every key that was pressed this frame.
+		/// </summary>
+		static const KeyBitset& GetPressedKeys() { return keyPressed; }
+		/// <summary>
+		/// Every key that went down or up this frame.
+		/// </summary>
+		static const KeyBitset& GetChangedKeys() { return keyChanged; }
+
 		/// <summary>
 		/// Return true after assigned initializer list of keys is held 
 		/// up to last key in correct order, and if last key is pressed.
@@ -87,6 +307,16 @@ namespace KalaKit
 		/// </summary>
 		static void SetRawMouseDelta(POS newMouseRawDelta);
 
+		/// <summary>
+		/// Every raw motion sample of this frame and the recent frames before it.
+		/// Filled by ProcessEvents from raw mouse move events.
+		/// </summary>
+		static const RawMouseHistory& GetRawMouseHistory() { return rawMouseHistory; }
+		/// <summary>
+		/// Average raw mouse velocity in pixels per second over the last window nanoseconds of motion.
+		/// </summary>
+		static MouseVelocity GetRawMouseVelocity(uint64_t window) { return rawMouseHistory.GetVelocity(window); }
+
 		/// <summary>
 		/// Get how many scroll steps the mouse wheel moved since the last frame.
 		/// Positive = scroll up, Negative = scroll down
@@ -122,6 +352,62 @@ namespace KalaKit
 		/// </summary>
 		static void ResetFrameInput();
 
+		/// <summary>
+		/// Assign the platform backend used for polling events and cursor control.
+		/// The backend must outlive its use, nullptr restores the default backend.
+		/// </summary>
+		static void SetBackend(InputBackend* newBackend) { backend = newBackend; }
+		/// <summary>
+		/// Get the assigned backend, or the default one for this platform:
+		/// Win32 on Windows, synthetic everywhere else.
+		/// </summary>
+		static InputBackend* GetBackend();
+
+		/// <summary>
+		/// Poll the backend, then apply every queued event to the input state in the order they happened.
+		/// Call once per frame on the game thread before reading any input.
+		/// </summary>
+		static void ProcessEvents();
+
+		/// <summary>
+		/// Copy the current input state into the shared snapshot. Called at the end of
+		/// ProcessEvents, call it again if the state is changed by hand afterwards.
+		/// Never blocks, even while other threads are reading.
+		/// </summary>
+		static void PublishSnapshot();
+		/// <summary>
+		/// Latest published frame, consistent as a whole and readable from any thread without locks.
+		/// </summary>
+		static InputSnapshot GetSnapshot() { return snapshot.Load(); }
+
+		/// <summary>
+		/// Every event applied by the last ProcessEvents call, oldest first.
+		/// Keeps sub-frame order and timing, so a press and release inside one frame can both be seen.
+		/// </summary>
+		static const vector<InputEvent>& GetFrameEvents() { return frameEvents; }
+
+		/// <summary>
+		/// How many events were dropped because the queue was full.
+		/// </summary>
+		static uint64_t GetDroppedEventCount() { return droppedEventCount.load(std::memory_order_relaxed); }
+
+		/// <summary>
+		/// Current steady clock time in nanoseconds, the clock used for event timestamps.
+		/// </summary>
+		static uint64_t GetEventTimestamp();
+
+		//
+		// EVENT PRODUCERS
+		// Safe to call from one platform thread while the game thread runs ProcessEvents.
+		// A timestamp of 0 uses the current time.
+		//
+
+		static bool PushKeyEvent(Key key, bool isDown, uint64_t timestamp = 0);
+		static bool PushMouseMoveEvent(POS delta, uint64_t timestamp = 0);
+		static bool PushMousePositionEvent(POS position, uint64_t timestamp = 0);
+		static bool PushRawMouseMoveEvent(POS delta, uint64_t timestamp = 0);
+		static bool PushMouseWheelEvent(int delta, uint64_t timestamp = 0);
+
 		/// <summary>
 		/// Locks cursor to the center of the window.
 		/// Should not be called manually.
@@ -136,8 +422,14 @@ namespace KalaKit
 		/// <param name="isDown"></param>
 		static void SetKeyState(Key key, bool isDown)
 		{
-			keyHeld[key] = isDown;
-			if (isDown) keyPressed[key] = true;
+			if (keyHeld.Test(key) != isDown) keyChanged.Set(key);
+
+			if (isDown)
+			{
+				keyHeld.Set(key);
+				keyPressed.Set(key);
+			}
+			else keyHeld.Reset(key);
 		}
 	private:
 		/// <summary>
@@ -150,17 +442,46 @@ namespace KalaKit
 		static inline bool isMouseLocked = false;
 
 		//Where the cursor is on screen or in window.
-		static inline POINT mousePosition = { 0, 0 };
+		static inline POS mousePosition = { 0, 0 };
 		//How much the cursor moved since the last frame.
-		static inline POINT mouseDelta = { 0, 0 };
+		static inline POS mouseDelta = { 0, 0 };
 		//Raw, unfiltered mouse move since last frame.
-		static inline POINT rawMouseDelta = { 0, 0 };
+		static inline POS rawMouseDelta = { 0, 0 };
 
 		//How many steps scrollwheel scrolled since last frame.
 		static inline int mouseWheelDelta = 0;
 
-		static inline unordered_map<Key, bool> keyHeld;
-		static inline unordered_map<Key, bool> keyPressed;
+		static inline RawMouseHistory rawMouseHistory{};
+
+		//
+		// LATENCY TRACKING
+		// arrival time of the oldest event not yet seen by a query, 0 if none
+		//
+
+		static void ConsumeKeyLatency(Key key);
+		static void ConsumeEventLatency(InputEventType type);
+		static void DiscardUnconsumedLatency();
+
+		static inline uint64_t keyEventTimes[KeyBitset::keyCount]{};
+		static inline InputEventType keyEventTypes[KeyBitset::keyCount]{};
+		static inline uint64_t pendingEventTimes[static_cast<size_t>(InputEventType::MOUSE_WHEEL) + 1]{};
+		//how many arrival times above are set, lets ProcessEvents skip the sweep
+		static inline size_t pendingLatencyCount = 0;
+
+		static inline KeyBitset keyHeld{};
+		static inline KeyBitset keyPressed{};
+		static inline KeyBitset keyChanged{};
+
+		static bool PushEvent(InputEventType type, Key key, int x, int y, uint64_t timestamp);
+
+		static inline InputBackend* backend = nullptr;
+
+		static inline SpscQueue<InputEvent, 4096> eventQueue{};
+		static inline vector<InputEvent> frameEvents{};
+		static inline atomic<uint64_t> droppedEventCount{ 0 };
+
+		static inline Seqlock<InputSnapshot> snapshot{};
+		static inline uint64_t publishedFrameCount = 0;
 
 		static string ToString(Key key);
 	};
@@ -0,0 +1,227 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string_view>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#include "enums.hpp"
+
+namespace KalaKit
+{
+	using std::string_view;
+	using std::array;
+
+	struct KeyNameEntry
+	{
+		string_view name;
+		Key key;
+	};
+
+	namespace KeyNamesInternal
+	{
+		inline constexpr KeyNameEntry entries[] =
+		{
+			{ "A", Key::A }, { "B", Key::B }, { "C", Key::C }, { "D", Key::D }, { "E", Key::E },
+			{ "F", Key::F }, { "G", Key::G }, { "H", Key::H }, { "I", Key::I }, { "J", Key::J },
+			{ "K", Key::K }, { "L", Key::L }, { "M", Key::M }, { "N", Key::N }, { "O", Key::O },
+			{ "P", Key::P }, { "Q", Key::Q }, { "R", Key::R }, { "S", Key::S }, { "T", Key::T },
+			{ "U", Key::U }, { "V", Key::V }, { "W", Key::W }, { "X", Key::X }, { "Y", Key::Y },
+			{ "Z", Key::Z },
+
+			{ "Num0", Key::Num0 }, { "Num1", Key::Num1 }, { "Num2", Key::Num2 }, { "Num3", Key::Num3 },
+			{ "Num4", Key::Num4 }, { "Num5", Key::Num5 }, { "Num6", Key::Num6 }, { "Num7", Key::Num7 },
+			{ "Num8", Key::Num8 }, { "Num9", Key::Num9 },
+
+			{ "Semicolon", Key::Semicolon }, { "Equal", Key::Equal }, { "Comma", Key::Comma },
+			{ "Minus", Key::Minus }, { "Period", Key::Period }, { "Slash", Key::Slash },
+			{ "Backtick", Key::Backtick }, { "BracketLeft", Key::BracketLeft },
+			{ "Backslash", Key::Backslash }, { "BracketRight", Key::BracketRight },
+			{ "Apostrophe", Key::Apostrophe }, { "Oem102", Key::Oem102 },
+
+			{ "Numpad0", Key::Numpad0 }, { "Numpad1", Key::Numpad1 }, { "Numpad2", Key::Numpad2 },
+			{ "Numpad3", Key::Numpad3 }, { "Numpad4", Key::Numpad4 }, { "Numpad5", Key::Numpad5 },
+			{ "Numpad6", Key::Numpad6 }, { "Numpad7", Key::Numpad7 }, { "Numpad8", Key::Numpad8 },
+			{ "Numpad9", Key::Numpad9 }, { "NumpadAdd", Key::NumpadAdd },
+			{ "NumpadSubtract", Key::NumpadSubtract }, { "NumpadMultiply", Key::NumpadMultiply },
+			{ "NumpadDivide", Key::NumpadDivide }, { "NumpadDecimal", Key::NumpadDecimal },
+			{ "NumLock", Key::NumLock },
+
+			{ "F1", Key::F1 }, { "F2", Key::F2 }, { "F3", Key::F3 }, { "F4", Key::F4 },
+			{ "F5", Key::F5 }, { "F6", Key::F6 }, { "F7", Key::F7 }, { "F8", Key::F8 },
+			{ "F9", Key::F9 }, { "F10", Key::F10 }, { "F11", Key::F11 }, { "F12", Key::F12 },
+			{ "F13", Key::F13 }, { "F14", Key::F14 }, { "F15", Key::F15 }, { "F16", Key::F16 },
+			{ "F17", Key::F17 }, { "F18", Key::F18 }, { "F19", Key::F19 }, { "F20", Key::F20 },
+			{ "F21", Key::F21 }, { "F22", Key::F22 }, { "F23", Key::F23 }, { "F24", Key::F24 },
+
+			{ "Escape", Key::Escape }, { "Enter", Key::Enter }, { "Tab", Key::Tab },
+			{ "Backspace", Key::Backspace }, { "Insert", Key::Insert }, { "Delete", Key::Delete },
+			{ "Home", Key::Home }, { "End", Key::End }, { "PageUp", Key::PageUp },
+			{ "PageDown", Key::PageDown },
+
+			{ "LeftShift", Key::LeftShift }, { "RightShift", Key::RightShift },
+			{ "LeftControl", Key::LeftControl }, { "RightControl", Key::RightControl },
+			{ "LeftAlt", Key::LeftAlt }, { "RightAlt", Key::RightAlt }, { "CapsLock", Key::CapsLock },
+
+			{ "PrintScreen", Key::PrintScreen }, { "ScrollLock", Key::ScrollLock },
+			{ "Pause", Key::Pause }, { "Menu", Key::Menu },
+
+			{ "Up", Key::Up }, { "Down", Key::Down }, { "Left", Key::Left }, { "Right", Key::Right },
+
+			{ "Space", Key::Space },
+
+			{ "MouseLeft", Key::MouseLeft }, { "MouseRight", Key::MouseRight },
+			{ "MouseMiddle", Key::MouseMiddle }, { "MouseX1", Key::MouseX1 }, { "MouseX2", Key::MouseX2 },
+			{ "MouseX3", Key::MouseX3 }, { "MouseX4", Key::MouseX4 }, { "MouseX5", Key::MouseX5 },
+			{ "MouseX6", Key::MouseX6 }, { "MouseX7", Key::MouseX7 }, { "MouseX8", Key::MouseX8 },
+			{ "MouseX9", Key::MouseX9 }, { "MouseX10", Key::MouseX10 },
+
+			{ "MediaPlayPause", Key::MediaPlayPause }, { "MediaStop", Key::MediaStop },
+			{ "MediaNextTrack", Key::MediaNextTrack }, { "MediaPrevTrack", Key::MediaPrevTrack },
+			{ "VolumeUp", Key::VolumeUp }, { "VolumeDown", Key::VolumeDown },
+			{ "VolumeMute", Key::VolumeMute }, { "LaunchMail", Key::LaunchMail },
+			{ "LaunchApp1", Key::LaunchApp1 }, { "LaunchApp2", Key::LaunchApp2 },
+			{ "BrowserBack", Key::BrowserBack }, { "BrowserForward", Key::BrowserForward },
+			{ "BrowserRefresh", Key::BrowserRefresh }, { "BrowserStop", Key::BrowserStop },
+			{ "BrowserSearch", Key::BrowserSearch }, { "BrowserFavorites", Key::BrowserFavorites },
+			{ "BrowserHome", Key::BrowserHome }
+		};
+
+		inline constexpr size_t entryCount = sizeof(entries) / sizeof(entries[0]);
+
+		//every key code is below 0x200
+		inline constexpr size_t keyCodeCount = 0x200;
+
+		//sparse enough that a collision free seed is found after a handful of tries
+		inline constexpr size_t slotCount = 4096;
+		inline constexpr uint8_t emptySlot = 0xFF;
+
+		static_assert(entryCount < emptySlot, "Too many key names for 8 bit slots.");
+
+		constexpr char ToLower(char c)
+		{
+			return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+		}
+
+		constexpr bool EqualsIgnoreCase(string_view a, string_view b)
+		{
+			if (a.size() != b.size()) return false;
+			for (size_t i = 0; i < a.size(); i++)
+			{
+				if (ToLower(a[i]) != ToLower(b[i])) return false;
+			}
+			return true;
+		}
+
+		//case-insensitive FNV-1a with the seed mixed into the offset basis
+		constexpr size_t HashName(string_view name, uint64_t seed)
+		{
+			uint64_t hash = 0xCBF29CE484222325ull ^ (seed * 0x9E3779B97F4A7C15ull);
+			for (char c : name)
+			{
+				hash ^= static_cast<uint8_t>(ToLower(c));
+				hash *= 0x100000001B3ull;
+			}
+			hash ^= hash >> 29;
+			return static_cast<size_t>(hash & (slotCount - 1));
+		}
+
+		constexpr uint64_t FindSeed()
+		{
+			for (uint64_t seed = 0; seed < 10000; seed++)
+			{
+				uint64_t used[slotCount / 64]{};
+				bool isPerfect = true;
+				for (size_t i = 0; i < entryCount && isPerfect; i++)
+				{
+					size_t slot = HashName(entries[i].name, seed);
+					uint64_t bit = uint64_t(1) << (slot & 63);
+					isPerfect = (used[slot >> 6] & bit) == 0;
+					used[slot >> 6] |= bit;
+				}
+				if (isPerfect) return seed;
+			}
+			return ~uint64_t(0);
+		}
+
+		inline constexpr uint64_t seed = FindSeed();
+		static_assert(seed != ~uint64_t(0), "No perfect hash seed found for key names.");
+
+		constexpr array<uint8_t, slotCount> BuildSlots()
+		{
+			array<uint8_t, slotCount> slots{};
+			for (auto& slot : slots) slot = emptySlot;
+			for (size_t i = 0; i < entryCount; i++)
+			{
+				slots[HashName(entries[i].name, seed)] = static_cast<uint8_t>(i);
+			}
+			return slots;
+		}
+
+		constexpr array<uint8_t, keyCodeCount> BuildCodes()
+		{
+			array<uint8_t, keyCodeCount> codes{};
+			for (auto& code : codes) code = emptySlot;
+			for (size_t i = 0; i < entryCount; i++)
+			{
+				codes[static_cast<size_t>(entries[i].key) & (keyCodeCount - 1)] = static_cast<uint8_t>(i);
+			}
+			return codes;
+		}
+
+		//name hash to entry index
+		inline constexpr array<uint8_t, slotCount> slots = BuildSlots();
+		//key code to entry index
+		inline constexpr array<uint8_t, keyCodeCount> codes = BuildCodes();
+	}
+
+	/// <summary>
+	/// Compile-time tables between every Key and its enumerator name.
+	/// Key to name is a dense array lookup, name to key is a case-insensitive
+	/// perfect hash followed by one string compare. Nothing is built at startup.
+	/// </summary>
+	class KeyNames
+	{
+	public:
+		/// <summary>
+		/// Enumerator name of the key, or an empty view if the code has no name.
+		/// </summary>
+		static constexpr string_view ToName(Key key)
+		{
+			size_t code = static_cast<size_t>(key);
+			if (code >= KeyNamesInternal::keyCodeCount) return {};
+
+			uint8_t index = KeyNamesInternal::codes[code];
+			if (index == KeyNamesInternal::emptySlot) return {};
+
+			return KeyNamesInternal::entries[index].name;
+		}
+
+		/// <summary>
+		/// Find the key whose name matches ignoring case, returns false if there is none.
+		/// </summary>
+		static constexpr bool FromName(string_view name, Key& outKey)
+		{
+			uint8_t index = KeyNamesInternal::slots[
+				KeyNamesInternal::HashName(name, KeyNamesInternal::seed)];
+			if (index == KeyNamesInternal::emptySlot) return false;
+
+			const KeyNameEntry& entry = KeyNamesInternal::entries[index];
+			if (!KeyNamesInternal::EqualsIgnoreCase(entry.name, name)) return false;
+
+			outKey = entry.key;
+			return true;
+		}
+
+		/// <summary>
+		/// Every named key, in the order they are declared in Key.
+		/// </summary>
+		static constexpr const KeyNameEntry* GetEntries() { return KeyNamesInternal::entries; }
+		static constexpr size_t GetEntryCount() { return KeyNamesInternal::entryCount; }
+	};
+}
@@ -0,0 +1,111 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#ifdef _WIN32
+	#ifdef KALAUTILS_DLL_EXPORT
+		#define KALAUTILS_API __declspec(dllexport)
+	#else
+		#define KALAUTILS_API __declspec(dllimport)
+	#endif
+#else
+	#define KALAUTILS_API
+#endif
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+#include "osutils.hpp"
+
+namespace KalaKit
+{
+	using std::string;
+	using std::string_view;
+	using std::vector;
+
+	/// <summary>
+	/// Sparse line offset index for random access into large text files.
+	/// The file is memory mapped and scanned once, the start offset of every
+	/// stride-th line is recorded, so jumping to any line only scans
+	/// atmost stride lines from the nearest checkpoint.
+	/// Lines start at offset 0 and after every '\n'.
+	/// </summary>
+	class KALAUTILS_API LineIndex
+	{
+	public:
+		static constexpr uint32_t defaultStride = 256;
+
+		/// <summary>
+		/// Map the file and build the index from scratch.
+		/// </summary>
+		/// <param name="filePath">Where is the file located?</param>
+		/// <param name="threadCount">Threads used for scanning, 0 picks hardware concurrency.</param>
+		/// <param name="stride">How many lines are between two recorded offsets.</param>
+		bool Build(
+			const string& filePath,
+			unsigned int threadCount = 1,
+			uint32_t stride = defaultStride);
+
+		/// <summary>
+		/// Load the index saved next to the file. If it is missing or the file was
+		/// rewritten the index is built from scratch, if the file only grew then
+		/// just the appended bytes are scanned.
+		/// </summary>
+		/// <param name="filePath">Where is the file located?</param>
+		/// <param name="threadCount">Threads used if the index needs to be built.</param>
+		bool Load(const string& filePath, unsigned int threadCount = 1);
+
+		/// <summary>
+		/// Save the index next to the file so later runs can skip the scan.
+		/// </summary>
+		bool Save() const;
+
+		/// <summary>
+		/// Remap the file and scan only the bytes appended since the last build or update.
+		/// Rebuilds the index if the file got smaller or its existing bytes changed.
+		/// </summary>
+		bool Update();
+
+		void Close();
+		bool IsOpen() const { return file.IsOpen(); }
+
+		uint64_t GetLineCount() const;
+
+		/// <summary>
+		/// Get the byte offset where the line starts, line numbers start from 0.
+		/// </summary>
+		bool GetLineOffset(uint64_t line, uint64_t& outOffset) const;
+
+		/// <summary>
+		/// Get the contents of the line without its line ending.
+		/// The view stays valid until the next Build, Update or Close.
+		/// </summary>
+		string_view GetLine(uint64_t line) const;
+
+		/// <summary>
+		/// Where the index of this file is saved.
+		/// </summary>
+		static string GetIndexPath(const string& filePath);
+	private:
+		bool ScanAppended(uint64_t previousSize);
+		uint64_t HashRegion(uint64_t end) const;
+
+		MappedFile file;
+		string filePath;
+		uint32_t stride = defaultStride;
+
+		//how many '\n' bytes are inside the indexed part of the file
+		uint64_t newlineCount = 0;
+		//how many bytes of the file have been scanned
+		uint64_t indexedSize = 0;
+		//hash of the indexed bytes taken when they were scanned, the mapping may change since
+		uint64_t fingerprint = 0;
+		//checkpoints[k] is the start offset of line k * stride
+		vector<uint64_t> checkpoints;
+	};
+}
@@ -0,0 +1,427 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#ifdef _WIN32
+	#ifdef KALAUTILS_DLL_EXPORT
+		#define KALAUTILS_API __declspec(dllexport)
+	#else
+		#define KALAUTILS_API __declspec(dllimport)
+	#endif
+#else
+	#define KALAUTILS_API
+#endif
+
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+//lowest LogLevel value that is compiled in, statements below it are removed
+//together with their arguments. LOG_DEBUG prints nothing outside of Debug mode by default
+#ifndef KALAUTILS_LOG_MIN_LEVEL
+	#if KALAUTILS_DEBUG
+		#define KALAUTILS_LOG_MIN_LEVEL 0
+	#else
+		#define KALAUTILS_LOG_MIN_LEVEL 1
+	#endif
+#endif
+
+/// <summary>
+/// Log a streamed message to a channel, level is a LogLevel enumerator name like LOG_LEVEL_ERROR.
+/// The message is only evaluated if the level is compiled in, reaches the level
+/// of the channel and the channel is not over its rate limit.
+/// </summary>
+#define KALAKIT_LOG(channel, level, msg) \
+	do \
+	{ \
+		if constexpr (KalaKit::LogLevel::level >= KalaKit::compiledLogLevel) \
+		{ \
+			static KalaKit::LogChannel& kalaKitLogChannel = KalaKit::LogChannel::Get(channel); \
+			if (kalaKitLogChannel.ShouldLog(KalaKit::LogLevel::level)) \
+			{ \
+				KalaKit::LogLine( \
+					kalaKitLogChannel.GetName(), \
+					KalaKit::GetLogLevelName(KalaKit::LogLevel::level)).Stream() << msg; \
+			} \
+		} \
+	} while (0)
+
+/// <summary>
+/// Log a format string with {} placeholders without formatting it on the calling thread.
+/// Each call site registers its format once, afterwards a call only copies
+/// a timestamp and the raw argument bytes into the log ring of the thread.
+/// Filtered the same way as KALAKIT_LOG.
+/// </summary>
+#define KALAKIT_LOG_FORMAT(channel, level, ...) \
+	do \
+	{ \
+		if constexpr (KalaKit::LogLevel::level >= KalaKit::compiledLogLevel) \
+		{ \
+			static KalaKit::LogChannel& kalaKitLogChannel = KalaKit::LogChannel::Get(channel); \
+			if (kalaKitLogChannel.ShouldLog(KalaKit::LogLevel::level)) \
+			{ \
+				KalaKit::Logger::WriteFormat( \
+					[]{}, \
+					kalaKitLogChannel.GetName(), \
+					KalaKit::GetLogLevelName(KalaKit::LogLevel::level), \
+					__VA_ARGS__); \
+			} \
+		} \
+	} while (0)
+
+namespace KalaKit
+{
+	using std::string;
+	using std::string_view;
+	using std::ostream;
+
+	enum class LogLevel : uint8_t
+	{
+		LOG_LEVEL_DEBUG,
+		LOG_LEVEL_INFO,
+		LOG_LEVEL_SUCCESS,
+		LOG_LEVEL_WARNING,
+		LOG_LEVEL_ERROR,
+		LOG_LEVEL_NONE //Only used as a threshold, turns a channel off
+	};
+
+	//lowest level the KALAKIT_LOG macros compile in
+	constexpr LogLevel compiledLogLevel = static_cast<LogLevel>(KALAUTILS_LOG_MIN_LEVEL);
+
+	constexpr const char* GetLogLevelName(LogLevel level)
+	{
+		switch (level)
+		{
+		case LogLevel::LOG_LEVEL_DEBUG: return "DEBUG";
+		case LogLevel::LOG_LEVEL_INFO: return "INFO";
+		case LogLevel::LOG_LEVEL_SUCCESS: return "SUCCESS";
+		case LogLevel::LOG_LEVEL_WARNING: return "WARNING";
+		case LogLevel::LOG_LEVEL_ERROR: return "ERROR";
+		default: return "NONE";
+		}
+	}
+
+	/// <summary>
+	/// Named log channel with its own level threshold and rate limit,
+	/// every module of KalaUtils logs to a channel named after its module tag like KALAKIT_FILEUTILS.
+	/// Channels are created on first use and live until the program exits.
+	/// </summary>
+	class KALAUTILS_API LogChannel
+	{
+	public:
+		/// <summary>
+		/// The channel with this name, created with the default level if it does not exist yet.
+		/// </summary>
+		static LogChannel& Get(string_view name);
+
+		/// <summary>
+		/// Level new channels start with, LOG_LEVEL_DEBUG by default.
+		/// Setting it also applies it to every existing channel.
+		/// </summary>
+		static LogLevel GetDefaultLevel();
+		static void SetDefaultLevel(LogLevel newLevel);
+
+		const char* GetName() const { return name.c_str(); }
+
+		LogLevel GetLevel() const { return level.load(std::memory_order_relaxed); }
+		/// <summary>
+		/// Lines below this level are skipped without evaluating their message.
+		/// </summary>
+		void SetLevel(LogLevel newLevel) { level.store(newLevel, std::memory_order_relaxed); }
+
+		/// <summary>
+		/// Allow at most linesPerSecond lines on average with bursts of up to burstSize lines,
+		/// the rest are skipped and reported with the next line that gets through.
+		/// 0 lines per second removes the limit, which is the default.
+		/// </summary>
+		void SetRateLimit(uint32_t linesPerSecond, uint32_t burstSize);
+		/// <summary>
+		/// Lines skipped by the rate limit since the program started.
+		/// </summary>
+		uint64_t GetSuppressedCount() const { return suppressedCount.load(std::memory_order_relaxed); }
+
+		/// <summary>
+		/// True if a line of this level should be written, takes from the rate limit if it is.
+		/// </summary>
+		bool ShouldLog(LogLevel lineLevel)
+		{
+			if (lineLevel < level.load(std::memory_order_relaxed)) return false;
+			if (emissionInterval.load(std::memory_order_relaxed) == 0) return true;
+
+			return TakeRateLimit();
+		}
+	private:
+		explicit LogChannel(string_view newName);
+
+		bool TakeRateLimit();
+
+		string name;
+		std::atomic<LogLevel> level{ LogLevel::LOG_LEVEL_DEBUG };
+
+		//token bucket kept as the time the bucket is full again,
+		//in nanoseconds. interval 0 means no limit
+		std::atomic<uint64_t> emissionInterval{ 0 };
+		std::atomic<uint64_t> burstTolerance{ 0 };
+		std::atomic<uint64_t> fullAt{ 0 };
+
+		std::atomic<uint64_t> suppressedCount{ 0 };
+		std::atomic<uint64_t> unreportedCount{ 0 };
+	};
+
+	enum class LogOverflowPolicy
+	{
+		LOG_OVERFLOW_BLOCK, //Wait for the writer thread to make room, no line is lost
+		LOG_OVERFLOW_DROP   //Drop the line and count it, the caller never waits
+	};
+
+	/// <summary>
+	/// How one argument of a format log call is stored, every value except strings takes 8 bytes.
+	/// </summary>
+	enum class LogArgumentType : uint8_t
+	{
+		ARG_INT,
+		ARG_UINT,
+		ARG_FLOAT,
+		ARG_BOOL,
+		ARG_POINTER,
+		ARG_STRING //32 bit length followed by the characters
+	};
+
+	template <typename T>
+	constexpr LogArgumentType GetLogArgumentType()
+	{
+		using Type = std::decay_t<T>;
+
+		if constexpr (std::is_same_v<Type, bool>) return LogArgumentType::ARG_BOOL;
+		else if constexpr (std::is_convertible_v<const T&, string_view>) return LogArgumentType::ARG_STRING;
+		else if constexpr (std::is_enum_v<Type>)
+		{
+			return std::is_signed_v<std::underlying_type_t<Type>>
+				? LogArgumentType::ARG_INT
+				: LogArgumentType::ARG_UINT;
+		}
+		else if constexpr (std::is_integral_v<Type>)
+		{
+			return std::is_signed_v<Type>
+				? LogArgumentType::ARG_INT
+				: LogArgumentType::ARG_UINT;
+		}
+		else if constexpr (std::is_floating_point_v<Type>) return LogArgumentType::ARG_FLOAT;
+		else
+		{
+			static_assert(std::is_pointer_v<Type>, "Format log arguments must be numbers, enums, strings or pointers.");
+			return LogArgumentType::ARG_POINTER;
+		}
+	}
+
+	/// <summary>
+	/// Central logger every WRITE_LOG macro writes through.
+	/// Each thread formats its lines into its own lock-free ring buffer and
+	/// a background thread writes all queued lines in batches to the
+	/// console and the optional log file, so logging never waits on stdout.
+	/// Lines of one thread stay in order, lines of different threads are written ring by ring.
+	/// </summary>
+	class KALAUTILS_API Logger
+	{
+	public:
+		//bytes of queued log text each thread can hold before the overflow policy applies
+		static constexpr size_t ringCapacity = 65536;
+		//longer string arguments of format log calls are cut
+		static constexpr size_t maxStringArgumentSize = 4096;
+
+		/// <summary>
+		/// Queue one complete line, including its trailing newline.
+		/// Lines longer than the ring capacity are cut.
+		/// </summary>
+		static void Write(string_view line);
+
+		static LogOverflowPolicy GetOverflowPolicy();
+		static void SetOverflowPolicy(LogOverflowPolicy newPolicy);
+		/// <summary>
+		/// Lines dropped with LOG_OVERFLOW_DROP since the program started.
+		/// </summary>
+		static uint64_t GetDroppedCount();
+
+		/// <summary>
+		/// Write to stdout, enabled by default.
+		/// </summary>
+		static void SetConsoleOutput(bool isEnabled);
+		/// <summary>
+		/// Also append every line to this file, an empty path closes the current file.
+		/// </summary>
+		static bool SetFileOutput(const string& filePath);
+
+		/// <summary>
+		/// Write raw binary records to this file instead of text to the console and the log file,
+		/// format log calls are then never formatted by this program.
+		/// Turn the file into text with DecodeBinaryLog. An empty path goes back to text output.
+		/// </summary>
+		static bool SetBinaryOutput(const string& filePath);
+		static bool IsBinaryOutput();
+		/// <summary>
+		/// Write a binary log as text, in the same format as text output.
+		/// Format log lines are prefixed with their timestamp in seconds if includeTimestamps is true.
+		/// </summary>
+		static bool DecodeBinaryLog(
+			const string& binaryLogPath,
+			const string& textLogPath,
+			bool includeTimestamps = true);
+
+		/// <summary>
+		/// Used by the KALAKIT_LOG_FORMAT macro, the empty lambda makes every call site
+		/// its own instantiation so its format is registered exactly once.
+		/// </summary>
+		template <typename CallSite, typename... Args>
+		static void WriteFormat(
+			CallSite,
+			const char* module,
+			const char* type,
+			const char* format,
+			const Args&... args)
+		{
+			static constexpr std::array<LogArgumentType, sizeof...(Args)> argumentTypes =
+			{
+				GetLogArgumentType<Args>()...
+			};
+			static const uint32_t formatId = RegisterFormat(
+				module,
+				type,
+				format,
+				argumentTypes.data(),
+				static_cast<uint32_t>(sizeof...(Args)));
+
+			size_t payloadSize = sizeof(uint64_t) + (GetEncodedSize(args) + ... + 0);
+
+			char* out = BeginRecord(formatId, payloadSize);
+			if (out == nullptr) return;
+
+			uint64_t timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count());
+			memcpy(out, &timestamp, sizeof(timestamp));
+			out += sizeof(timestamp);
+
+			((out = Encode(out, args)), ...);
+
+			CommitRecord();
+		}
+
+		/// <summary>
+		/// Wait until every line queued before this call has been written.
+		/// </summary>
+		static void Flush();
+		/// <summary>
+		/// Write everything still queued and stop the writer thread.
+		/// Lines logged afterwards are written directly by the calling thread.
+		/// Done automatically when the program exits.
+		/// </summary>
+		static void Shutdown();
+
+		/// <summary>
+		/// Write all queued lines before the program dies from a crash signal,
+		/// an unhandled exception or std::terminate, so the last lines before a crash are kept.
+		/// </summary>
+		static void InstallCrashHandler();
+	private:
+		static uint32_t RegisterFormat(
+			const char* module,
+			const char* type,
+			const char* format,
+			const LogArgumentType* argumentTypes,
+			uint32_t argumentCount);
+
+		/// <summary>
+		/// Reserve a record in the ring of the calling thread and return where its payload goes,
+		/// nullptr if the record was dropped. Every non null result must be followed by CommitRecord.
+		/// </summary>
+		static char* BeginRecord(uint32_t formatId, size_t payloadSize);
+		static void CommitRecord();
+
+		template <typename T>
+		static size_t GetEncodedSize(const T& value)
+		{
+			if constexpr (GetLogArgumentType<T>() == LogArgumentType::ARG_STRING)
+			{
+				return sizeof(uint32_t) + ToStringView(value).size();
+			}
+			else return sizeof(uint64_t);
+		}
+
+		template <typename T>
+		static char* Encode(char* out, const T& value)
+		{
+			constexpr LogArgumentType type = GetLogArgumentType<T>();
+
+			if constexpr (type == LogArgumentType::ARG_STRING)
+			{
+				string_view text = ToStringView(value);
+				uint32_t size = static_cast<uint32_t>(text.size());
+				memcpy(out, &size, sizeof(size));
+				memcpy(out + sizeof(size), text.data(), text.size());
+				return out + sizeof(size) + text.size();
+			}
+			else
+			{
+				uint64_t bits = 0;
+				if constexpr (type == LogArgumentType::ARG_FLOAT)
+				{
+					double number = static_cast<double>(value);
+					memcpy(&bits, &number, sizeof(bits));
+				}
+				else if constexpr (type == LogArgumentType::ARG_POINTER)
+				{
+					bits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+				}
+				else if constexpr (type == LogArgumentType::ARG_INT)
+				{
+					bits = static_cast<uint64_t>(static_cast<int64_t>(value));
+				}
+				else bits = static_cast<uint64_t>(value);
+
+				memcpy(out, &bits, sizeof(bits));
+				return out + sizeof(bits);
+			}
+		}
+
+		template <typename T>
+		static string_view ToStringView(const T& value)
+		{
+			string_view text{};
+			if constexpr (std::is_pointer_v<T>)
+			{
+				if (value != nullptr) text = value;
+			}
+			else text = value;
+
+			return text.substr(0, maxStringArgumentSize);
+		}
+	};
+
+	/// <summary>
+	/// One log line being formatted by the WRITE_LOG macro, queued when the line goes out of scope.
+	/// Should not be used manually.
+	/// </summary>
+	class KALAUTILS_API LogLine
+	{
+	public:
+		LogLine(const char* module, const char* type);
+		~LogLine();
+
+		LogLine(const LogLine&) = delete;
+		LogLine& operator=(const LogLine&) = delete;
+
+		ostream& Stream();
+	private:
+		//where this line starts in the formatting buffer of the thread, lets log calls nest
+		size_t start = 0;
+	};
+}
@@ -15,10 +15,51 @@
 	#define KALAUTILS_API
 #endif
 
+#include <string>
+#include <string_view>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define KALAKIT_HAS_TSC 1
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <x86intrin.h>
+	#endif
+#endif
+
 #ifdef _WIN32
 #include <Windows.h>
+#elif X11_ENABLED
+#include <X11/Xlib.h>
+#else
+struct wl_display;
+struct wl_surface;
 #endif
 
+//compile one function for an instruction set the rest of the program is not built for,
+//only call it after OSUtils::GetCpuInfo has confirmed the CPU supports it.
+//MSVC allows every intrinsic in every function so nothing is needed there
+#if defined(__GNUC__) || defined(__clang__)
+	#define KALAKIT_TARGET(isa) __attribute__((target(isa)))
+#else
+	#define KALAKIT_TARGET(isa)
+#endif
+
+#define KALAKIT_CONCAT_INNER(a, b) a##b
+#define KALAKIT_CONCAT(a, b) KALAKIT_CONCAT_INNER(a, b)
+
+/// <summary>
+/// Time the rest of the enclosing scope into the named TimerCounter.
+/// The counter is looked up once per call site.
+/// </summary>
+#define KALAKIT_SCOPED_TIMER(name) \
+	static KalaKit::TimerCounter& KALAKIT_CONCAT(kalaKitTimerCounter, __LINE__) = KalaKit::TimerCounter::Get(name); \
+	KalaKit::ScopedTimer KALAKIT_CONCAT(kalaKitScopedTimer, __LINE__)(KALAKIT_CONCAT(kalaKitTimerCounter, __LINE__))
+
 namespace KalaKit
 {
 #ifdef _WIN32
@@ -39,27 +80,287 @@ namespace KalaKit
 	};
 
 	#if X11_ENABLED
-		#include <X11/Xlib.h>
 		struct WINDOW // The current window that is created and running.
 		{
 			::Display* display;
 			::Window window;
 		};
 	#else
-		struct wl_display;
-		struct wl_surface;
-
 		struct WINDOW // The current window that is created and running.
 		{
-			wl_display* display;
-			wl_surface* window;
+			::wl_display* display;
+			::wl_surface* window;
 		};
 	#endif
 #endif
 
+	using std::string;
+	using std::string_view;
+	using std::vector;
+
+	/// <summary>
+	/// Read-only memory mapping of a whole file.
+	/// The mapping stays valid until Close is called or the object is destroyed.
+	/// </summary>
+	class KALAUTILS_API MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		/// <summary>
+		/// Map the file into memory, closes any previously mapped file first.
+		/// </summary>
+		/// <param name="filePath">Where is the file located?</param>
+		bool Open(const string& filePath);
+		/// <summary>
+		/// Unmap the file.
+		/// </summary>
+		void Close();
+
+		bool IsOpen() const { return isOpen; }
+		/// <summary>
+		/// Start of the mapped bytes, nullptr if the file is empty.
+		/// </summary>
+		const char* GetData() const { return data; }
+		size_t GetSize() const { return size; }
+	private:
+		const char* data = nullptr;
+		size_t size = 0;
+		bool isOpen = false;
+#ifdef _WIN32
+		HANDLE mappingHandle = nullptr;
+#endif
+	};
+
+	/// <summary>
+	/// Instruction set levels kernels are written for, each level includes the ones below it.
+	/// </summary>
+	enum class CpuIsaLevel
+	{
+		ISA_BASELINE, //SSE2 on x86-64, or any other architecture
+		ISA_SSE42,    //SSE4.2 and POPCNT
+		ISA_AVX2,     //AVX2, FMA, BMI1 and BMI2, enabled by the OS
+		ISA_AVX512    //AVX-512 F, BW, DQ and VL, enabled by the OS
+	};
+
+	/// <summary>
+	/// What the CPU running the program supports and how its caches and cores are laid out.
+	/// Sizes and counts are 0 if they could not be detected.
+	/// </summary>
+	struct KALAUTILS_API CpuInfo
+	{
+		string vendor;
+		string brand;
+
+		bool hasSse2;
+		bool hasSse42;
+		bool hasPopcnt;
+		bool hasAvx;
+		bool hasAvx2;
+		bool hasFma;
+		bool hasBmi1;
+		bool hasBmi2;
+		bool hasAvx512f;
+		bool hasAvx512bw;
+		bool hasAvx512dq;
+		bool hasAvx512vl;
+		//the TSC ticks at a constant rate in every power state
+		bool hasInvariantTsc;
+
+		//highest level every kernel may use, capped by the KALAUTILS_MAX_ISA environment variable
+		CpuIsaLevel isaLevel;
+
+		//per core for L1 and L2, usually shared for L3, in bytes
+		uint32_t l1DataCacheSize;
+		uint32_t l2CacheSize;
+		uint32_t l3CacheSize;
+		uint32_t cacheLineSize;
+
+		uint32_t physicalCoreCount;
+		uint32_t logicalCoreCount;
+		uint32_t numaNodeCount;
+	};
+
+	/// <summary>
+	/// Where OSUtils::ReadTicks takes its ticks from.
+	/// </summary>
+	enum class TickSource
+	{
+		TICKS_STEADY, //std::chrono::steady_clock nanoseconds
+		TICKS_TSC     //the invariant TSC, read with rdtsc
+	};
+
+	/// <summary>
+	/// One implementation of a kernel per instruction set level, unused levels stay nullptr.
+	/// </summary>
+	template <typename Function>
+	struct KernelSet
+	{
+		Function baseline;
+		Function sse42 = nullptr;
+		Function avx2 = nullptr;
+		Function avx512 = nullptr;
+	};
+
 	class KALAUTILS_API OSUtils
 	{
+	public:
+		/// <summary>
+		/// Detected once with CPUID on first use, caches, cores and NUMA nodes
+		/// come from /sys on Linux and GetLogicalProcessorInformationEx on Windows.
+		/// </summary>
+		static const CpuInfo& GetCpuInfo();
+
+		/// <summary>
+		/// The kernel of the highest level the CPU supports.
+		/// Store the result in a namespace scope constant so it is picked once when the
+		/// program or library is loaded and every later call is a plain indirect call.
+		/// KALAUTILS_MAX_ISA=baseline, sse42 or avx2 forces a lower level for testing.
+		/// </summary>
+		template <typename Function>
+		static Function SelectKernel(const KernelSet<Function>& kernels)
+		{
+			CpuIsaLevel level = GetCpuInfo().isaLevel;
+
+			if (level >= CpuIsaLevel::ISA_AVX512
+				&& kernels.avx512 != nullptr)
+			{
+				return kernels.avx512;
+			}
+			if (level >= CpuIsaLevel::ISA_AVX2
+				&& kernels.avx2 != nullptr)
+			{
+				return kernels.avx2;
+			}
+			if (level >= CpuIsaLevel::ISA_SSE42
+				&& kernels.sse42 != nullptr)
+			{
+				return kernels.sse42;
+			}
+			return kernels.baseline;
+		}
+
+		/// <summary>
+		/// Read the fastest monotonic counter, the TSC where it is invariant and steady clock
+		/// nanoseconds everywhere else. Only differences of ticks are meaningful,
+		/// turn them into time with TicksToNanoseconds.
+		/// </summary>
+		static uint64_t ReadTicks()
+		{
+#ifdef KALAKIT_HAS_TSC
+			static const bool isTsc = GetTickSource() == TickSource::TICKS_TSC;
+			if (isTsc) return __rdtsc();
+#endif
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+
+		/// <summary>
+		/// Chosen and calibrated against the monotonic clock on first use,
+		/// which takes about 10 milliseconds when the TSC is used.
+		/// </summary>
+		static TickSource GetTickSource();
+		static double GetTicksPerSecond();
+		static uint64_t TicksToNanoseconds(uint64_t ticks);
+
+		/// <summary>
+		/// Monotonic time in nanoseconds from ReadTicks, on the same timeline as steady_clock
+		/// when the calibration was taken. Can drift from it by tens of microseconds per second,
+		/// use steady_clock for timestamps that are compared with other clocks.
+		/// </summary>
+		static uint64_t GetMonotonicNanoseconds();
+	};
+
+	struct KALAUTILS_API TimerStats
+	{
+		string name;
+		uint64_t count;
+		//all values are in nanoseconds
+		uint64_t total;
+		uint64_t min;
+		uint64_t max;
+	};
+
+	/// <summary>
+	/// Named total of the time spent in a piece of code, filled by ScopedTimer.
+	/// Counters are created on first use and live until the program exits.
+	/// </summary>
+	class KALAUTILS_API TimerCounter
+	{
+	public:
+		/// <summary>
+		/// The counter with this name, created if it does not exist yet.
+		/// </summary>
+		static TimerCounter& Get(string_view name);
+		/// <summary>
+		/// Statistics of every counter, in the order they were created.
+		/// </summary>
+		static vector<TimerStats> GetAllStats();
+		static void ResetAll();
+
+		const char* GetName() const { return name.c_str(); }
+
+		/// <summary>
+		/// Count one timed run that took this many ticks of OSUtils::ReadTicks.
+		/// </summary>
+		void Add(uint64_t ticks)
+		{
+			count.fetch_add(1, std::memory_order_relaxed);
+			totalTicks.fetch_add(ticks, std::memory_order_relaxed);
+
+			uint64_t current = minTicks.load(std::memory_order_relaxed);
+			while (ticks < current
+				&& !minTicks.compare_exchange_weak(current, ticks, std::memory_order_relaxed))
+			{
+			}
+
+			current = maxTicks.load(std::memory_order_relaxed);
+			while (ticks > current
+				&& !maxTicks.compare_exchange_weak(current, ticks, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		TimerStats GetStats() const;
+		void Reset();
+	private:
+		explicit TimerCounter(string_view newName);
+
+		string name;
+
+		//own cache line so counters updated from different threads do not slow each other down
+		alignas(64) std::atomic<uint64_t> count{ 0 };
+		std::atomic<uint64_t> totalTicks{ 0 };
+		std::atomic<uint64_t> minTicks{ UINT64_MAX };
+		std::atomic<uint64_t> maxTicks{ 0 };
+	};
+
+	/// <summary>
+	/// Adds the ticks between its construction and destruction to a TimerCounter.
+	/// </summary>
+	class ScopedTimer
+	{
+	public:
+		explicit ScopedTimer(TimerCounter& newCounter)
+			: counter(newCounter),
+			start(OSUtils::ReadTicks())
+		{
+		}
+		~ScopedTimer()
+		{
+			counter.Add(OSUtils::ReadTicks() - start);
+		}
+
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
 	private:
-		static void DummyFunction();
+		TimerCounter& counter;
+		uint64_t start;
 	};
 }
\ No newline at end of file
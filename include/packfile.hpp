@@ -0,0 +1,122 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#ifdef _WIN32
+	#ifdef KALAUTILS_DLL_EXPORT
+		#define KALAUTILS_API __declspec(dllexport)
+	#else
+		#define KALAUTILS_API __declspec(dllimport)
+	#endif
+#else
+	#define KALAUTILS_API
+#endif
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+#include "osutils.hpp"
+
+namespace KalaKit
+{
+	using std::string;
+	using std::string_view;
+	using std::vector;
+
+	/// <summary>
+	/// Fixed header at the start of every pack file.
+	/// All values are stored in little-endian byte order.
+	/// </summary>
+	struct PackHeader
+	{
+		char magic[4];         //always 'KPAK'
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t slotCount;    //power of two, atleast twice the entry count
+		uint64_t tocOffset;    //PackEntry array sorted by path hash
+		uint64_t slotOffset;   //uint32_t open addressing table, entry index + 1, 0 = empty
+		uint64_t namesOffset;  //concatenated entry paths
+		uint64_t namesSize;
+		uint64_t reserved[2];
+	};
+
+	/// <summary>
+	/// One table of contents entry in a pack file.
+	/// </summary>
+	struct PackEntry
+	{
+		uint64_t hash;
+		uint64_t offset;       //always aligned to PackFile::alignment
+		uint64_t size;
+		uint32_t nameOffset;
+		uint32_t nameLength;
+	};
+
+	/// <summary>
+	/// A file that will be written into a pack.
+	/// </summary>
+	struct PackSource
+	{
+		string entryPath;      //path used for lookups, always with forward slashes
+		string filePath;       //where the file is on disk right now
+	};
+
+	/// <summary>
+	/// Read-only view of a pack file. The whole pack is memory mapped,
+	/// lookups hash the path once and return views straight into the mapping.
+	/// </summary>
+	class KALAUTILS_API PackFile
+	{
+	public:
+		static constexpr uint32_t version = 1;
+		static constexpr uint64_t alignment = 4096;
+
+		/// <summary>
+		/// Write all sources into a single pack file.
+		/// </summary>
+		/// <param name="packPath">Full path to the pack that will be created or overwritten.</param>
+		/// <param name="sources">Files that will be stored in the pack.</param>
+		static bool Write(const string& packPath, const vector<PackSource>& sources);
+
+		/// <summary>
+		/// Hash used for the table of contents, 64-bit FNV-1a of the entry path.
+		/// </summary>
+		static uint64_t HashPath(string_view entryPath);
+
+		/// <summary>
+		/// Map the pack and validate its header.
+		/// </summary>
+		/// <param name="packPath">Where is the pack located?</param>
+		bool Open(const string& packPath);
+		void Close();
+		bool IsOpen() const { return header != nullptr; }
+
+		/// <summary>
+		/// Find an entry by path in O(1). On success outData points into the mapping
+		/// and stays valid until the pack is closed.
+		/// </summary>
+		bool TryGet(string_view entryPath, string_view& outData) const;
+		/// <summary>
+		/// Return the contents of the entry, or an empty view if it does not exist.
+		/// </summary>
+		string_view Get(string_view entryPath) const;
+		bool Contains(string_view entryPath) const;
+
+		size_t GetEntryCount() const;
+		string_view GetEntryPath(size_t index) const;
+		string_view GetEntryData(size_t index) const;
+	private:
+		const PackEntry* FindEntry(string_view entryPath) const;
+
+		MappedFile file;
+		const PackHeader* header = nullptr;
+		const PackEntry* entries = nullptr;
+		const uint32_t* slots = nullptr;
+		const char* names = nullptr;
+	};
+}
@@ -0,0 +1,142 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#ifdef _WIN32
+	#ifdef KALAUTILS_DLL_EXPORT
+		#define KALAUTILS_API __declspec(dllexport)
+	#else
+		#define KALAUTILS_API __declspec(dllimport)
+	#endif
+#else
+	#define KALAUTILS_API
+#endif
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "windowutils.hpp"
+
+namespace KalaKit
+{
+	using std::vector;
+
+	/// <summary>
+	/// Area of the back buffer that changed since the last present, in pixels.
+	/// </summary>
+	struct KALAUTILS_API DamageRect
+	{
+		int x;
+		int y;
+		int width;
+		int height;
+	};
+
+	/// <summary>
+	/// CPU rendered pixels shown in a window without copying the frame.
+	/// Pixels are 32 bit 0xAARRGGBB values, rows are GetStride pixels apart.
+	/// On X11 the buffers live in MIT-SHM shared memory the X server reads directly
+	/// and fall back to XPutImage when the server cannot share memory with us,
+	/// on Windows they are DIB sections blitted straight to the window.
+	/// </summary>
+	class KALAUTILS_API PresentBuffer
+	{
+	public:
+		//damage rectangles kept per frame before they are merged into one
+		static constexpr size_t maxDamageRects = 16;
+
+		PresentBuffer() = default;
+		~PresentBuffer();
+
+		PresentBuffer(const PresentBuffer&) = delete;
+		PresentBuffer& operator=(const PresentBuffer&) = delete;
+
+		/// <summary>
+		/// Allocate the buffers for a registered window, the main window if no handle is passed.
+		/// Returns false if the window is not valid or its visual is not 32 bits per pixel.
+		/// </summary>
+		bool Create(int width, int height, WindowHandle handle = {});
+		/// <summary>
+		/// Reallocate the buffers at a new size, all pixels are lost.
+		/// </summary>
+		bool Resize(int width, int height);
+		void Destroy();
+
+		bool IsCreated() const { return bufferCount != 0; }
+		/// <summary>
+		/// True if presenting never copies the pixels through the display connection.
+		/// </summary>
+		bool IsShared() const { return isShared; }
+
+		/// <summary>
+		/// The buffer to draw the next frame into, valid until the next Present call.
+		/// </summary>
+		uint32_t* GetBackBuffer() const { return backBuffer; }
+		int GetWidth() const { return width; }
+		int GetHeight() const { return height; }
+		/// <summary>
+		/// Pixels from the start of one row to the start of the next.
+		/// </summary>
+		int GetStride() const { return stride; }
+
+		/// <summary>
+		/// How many presents ago the back buffer was last shown, 0 if it has never been shown.
+		/// Only pixels changed during the last (age - 1) frames have to be drawn again,
+		/// with 0 the whole buffer has to be drawn.
+		/// </summary>
+		uint32_t GetBufferAge() const;
+
+		/// <summary>
+		/// Mark an area as changed, only changed areas are sent by Present.
+		/// Rectangles are clipped to the buffer.
+		/// </summary>
+		void AddDamage(const DamageRect& rect);
+
+		/// <summary>
+		/// Show the changed areas of the back buffer, or all of it if nothing was marked,
+		/// then swap to the other buffer. Waits only if the display server has not
+		/// finished reading the buffer that becomes the new back buffer.
+		/// </summary>
+		void Present();
+	private:
+		static constexpr uint32_t maxBufferCount = 2;
+
+		bool CreateBuffers();
+		void DestroyBuffers();
+		void PresentDamage();
+		void WaitForBuffer(uint32_t index);
+
+		WindowHandle handle = WindowHandle::Invalid();
+		//kept so the buffers can be released after the window is unregistered
+		WINDOW nativeWindow{};
+
+		int width = 0;
+		int height = 0;
+		int stride = 0;
+		bool isShared = false;
+
+		uint32_t bufferCount = 0;
+		uint32_t backIndex = 0;
+		uint32_t* backBuffer = nullptr;
+		uint32_t* pixels[maxBufferCount]{};
+
+		//present number each buffer was last shown at, 0 if never
+		uint64_t presentedAt[maxBufferCount]{};
+		uint64_t presentCount = 0;
+		//true until the display server reports it is done reading the buffer
+		bool isInFlight[maxBufferCount]{};
+
+		vector<DamageRect> damage;
+
+		//XImage and XShmSegmentInfo or HBITMAP, and the GC or memory DC,
+		//kept opaque so this header does not depend on the MIT-SHM headers
+		void* images[maxBufferCount]{};
+		void* sharedInfos[maxBufferCount]{};
+		void* graphicsContext = nullptr;
+		vector<uint32_t> fallbackPixels[maxBufferCount];
+	};
+}
@@ -0,0 +1,91 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace KalaKit
+{
+	using std::atomic;
+	using std::atomic_thread_fence;
+	using std::memory_order_relaxed;
+	using std::memory_order_acquire;
+	using std::memory_order_release;
+
+	/// <summary>
+	/// Single writer, many reader sequence lock around a trivially copyable value.
+	/// The writer never waits, readers retry their copy if a write overlapped it.
+	/// The value is stored as atomic words so torn reads are detected instead of being undefined.
+	/// </summary>
+	template <typename T>
+	class Seqlock
+	{
+		static_assert(std::is_trivially_copyable_v<T>,
+			"Seqlock value must be trivially copyable.");
+	public:
+		/// <summary>
+		/// Writer only. Replaces the stored value without blocking.
+		/// </summary>
+		void Store(const T& value)
+		{
+			uint64_t buffer[wordCount]{};
+			memcpy(buffer, &value, sizeof(T));
+
+			uint64_t currentSequence = sequence.load(memory_order_relaxed);
+
+			//odd sequence tells readers a write is in progress
+			sequence.store(currentSequence + 1, memory_order_relaxed);
+			atomic_thread_fence(memory_order_release);
+
+			for (size_t i = 0; i < wordCount; i++)
+			{
+				words[i].store(buffer[i], memory_order_relaxed);
+			}
+
+			sequence.store(currentSequence + 2, memory_order_release);
+		}
+
+		/// <summary>
+		/// Any thread. Copies the latest complete value, retrying while the writer is inside Store.
+		/// </summary>
+		T Load() const
+		{
+			uint64_t buffer[wordCount]{};
+
+			while (true)
+			{
+				uint64_t before = sequence.load(memory_order_acquire);
+				if (before & 1) continue;
+
+				for (size_t i = 0; i < wordCount; i++)
+				{
+					buffer[i] = words[i].load(memory_order_relaxed);
+				}
+
+				atomic_thread_fence(memory_order_acquire);
+				if (sequence.load(memory_order_relaxed) == before) break;
+			}
+
+			T value;
+			memcpy(&value, buffer, sizeof(T));
+			return value;
+		}
+
+		/// <summary>
+		/// How many times Store has been called.
+		/// </summary>
+		uint64_t GetVersion() const { return sequence.load(memory_order_acquire) / 2; }
+	private:
+		static constexpr size_t wordCount = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+		alignas(64) atomic<uint64_t> sequence{ 0 };
+		atomic<uint64_t> words[wordCount]{};
+	};
+}
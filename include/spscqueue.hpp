@@ -0,0 +1,83 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace KalaKit
+{
+	using std::atomic;
+	using std::memory_order_relaxed;
+	using std::memory_order_acquire;
+	using std::memory_order_release;
+
+	/// <summary>
+	/// Fixed capacity lock-free ring for exactly one producer thread and one consumer thread.
+	/// Each side only writes its own index and keeps a cached copy of the other side's index,
+	/// so the shared cache lines are touched only when the cached copy runs out.
+	/// </summary>
+	template <typename T, size_t Capacity>
+	class SpscQueue
+	{
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+			"SpscQueue capacity must be a power of two.");
+	public:
+		/// <summary>
+		/// Producer only. Returns false without blocking if the queue is full.
+		/// </summary>
+		bool TryPush(const T& value)
+		{
+			size_t currentTail = tail.load(memory_order_relaxed);
+			if (currentTail - cachedHead == Capacity)
+			{
+				cachedHead = head.load(memory_order_acquire);
+				if (currentTail - cachedHead == Capacity) return false;
+			}
+
+			slots[currentTail & (Capacity - 1)] = value;
+			tail.store(currentTail + 1, memory_order_release);
+			return true;
+		}
+
+		/// <summary>
+		/// Consumer only. Returns false without blocking if the queue is empty.
+		/// </summary>
+		bool TryPop(T& outValue)
+		{
+			size_t currentHead = head.load(memory_order_relaxed);
+			if (currentHead == cachedTail)
+			{
+				cachedTail = tail.load(memory_order_acquire);
+				if (currentHead == cachedTail) return false;
+			}
+
+			outValue = slots[currentHead & (Capacity - 1)];
+			head.store(currentHead + 1, memory_order_release);
+			return true;
+		}
+
+		/// <summary>
+		/// Approximate number of queued items, exact only when called from either side while the other is idle.
+		/// </summary>
+		size_t GetSize() const
+		{
+			return tail.load(memory_order_acquire) - head.load(memory_order_acquire);
+		}
+
+		static constexpr size_t GetCapacity() { return Capacity; }
+	private:
+		//consumer side
+		alignas(64) atomic<size_t> head{ 0 };
+		size_t cachedTail = 0;
+
+		//producer side
+		alignas(64) atomic<size_t> tail{ 0 };
+		size_t cachedHead = 0;
+
+		alignas(64) T slots[Capacity]{};
+	};
+}
@@ -15,7 +15,20 @@
 	#define KALAUTILS_API
 #endif
 
+//debug types that can ever be printed, checks for every other type compile away.
+//LOG_DEBUG prints nothing outside of Debug mode so nothing is compiled in by default there
+#ifndef KALAUTILS_DEBUG_MASK
+	#if KALAUTILS_DEBUG
+		#define KALAUTILS_DEBUG_MASK 0xFFFFFFFFu
+	#else
+		#define KALAUTILS_DEBUG_MASK 0u
+	#endif
+#endif
+
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
 
 #include "osutils.hpp"
 #include "enums.hpp"
@@ -23,22 +36,90 @@
 namespace KalaKit
 {
 	using std::string;
+	using std::vector;
+
+	/// <summary>
+	/// Refers to one registered window. A handle stays safe to use after its window
+	/// is unregistered, the generation no longer matches and every call rejects it.
+	/// A default constructed handle refers to the main window.
+	/// </summary>
+	struct KALAUTILS_API WindowHandle
+	{
+		static constexpr uint32_t mainIndex = 0xFFFFFFFF;
+		static constexpr uint32_t invalidIndex = 0xFFFFFFFE;
+
+		uint32_t index = mainIndex;
+		//live windows start from generation 1
+		uint32_t generation = 0;
+
+		static WindowHandle Invalid() { return { invalidIndex, 0 }; }
+		bool IsMainWindow() const { return index == mainIndex; }
+		bool operator==(const WindowHandle& other) const = default;
+	};
 
 	class KALAUTILS_API WindowUtils
 	{
 	public:
-		static inline WINDOW window;
+		//
+		// WINDOW REGISTRY
+		//
+
+		/// <summary>
+		/// Start tracking a native window, registering the same window twice returns the same handle.
+		/// The first registered window becomes the main window.
+		/// </summary>
+		static WindowHandle RegisterWindow(const WINDOW& nativeWindow);
+		/// <summary>
+		/// Stop tracking the window, its handle becomes invalid.
+		/// </summary>
+		static void UnregisterWindow(WindowHandle handle);
+		static bool IsWindowValid(WindowHandle handle);
+
+		/// <summary>
+		/// Find the handle of a native window in constant time,
+		/// used to route window procedure and X11 events to the right window.
+		/// Returns an invalid handle if the window is not registered.
+		/// </summary>
+		static WindowHandle GetWindowHandle(const WINDOW& nativeWindow);
+		static WINDOW GetNativeWindow(WindowHandle handle = {});
+
+		/// <summary>
+		/// The window used when no handle is passed.
+		/// </summary>
+		static WindowHandle GetMainWindow();
+		static void SetMainWindow(WindowHandle handle);
+
+		static size_t GetWindowCount();
+		/// <summary>
+		/// Handles of every registered window.
+		/// </summary>
+		static vector<WindowHandle> GetWindows();
 
 		/// <summary>
-		/// Get the currently assigned debug type.
+		/// Get the currently assigned debug types.
 		/// </summary>
-		static DebugType GetDebugType();
+		static DebugType GetDebugType() { return debugType; }
 		/// <summary>
 		/// Used for printing all input actions or specific ones 
 		/// to console with cout if a console is attached to the window.
+		/// Combine several debug types with | to print all of them.
 		/// You MUST be in Debug mode or else these messages will not be printed.
 		/// </summary>
-		static void SetDebugType(DebugType newDebugType);
+		static void SetDebugType(DebugType newDebugType) { debugType = newDebugType; }
+		static void EnableDebugType(DebugType type) { debugType |= type; }
+		static void DisableDebugType(DebugType type) { debugType &= ~type; }
+
+		/// <summary>
+		/// True if any of the debug types is assigned and compiled in with KALAUTILS_DEBUG_MASK.
+		/// Always false at compile time when the mask excludes all of them.
+		/// </summary>
+		static bool IsDebugTypeEnabled(DebugType type)
+		{
+			constexpr uint32_t compiledMask = KALAUTILS_DEBUG_MASK;
+			if ((static_cast<uint32_t>(type) & compiledMask) == 0) return false;
+
+			return (debugType & type) != DebugType::DEBUG_NONE;
+		}
 
 		static bool GetWindowFocusRequiredState();
 		/// <summary>
@@ -48,71 +129,76 @@ namespace KalaKit
 		/// </summary>
 		static void SetWindowFocusRequiredState(bool newWindowFocusRequiredState);
 
+		//
+		// PER WINDOW STATE
+		// Every call below works on the main window unless a handle is passed.
+		//
+
 		/// <summary>
 		/// Assign a title to the window.
 		/// </summary>
-		static void SetWindowTitle(const string& title);
+		static void SetWindowTitle(const string& title, WindowHandle handle = {});
 
 		/// <summary>
 		/// Set the window to one of the possible states.
 		/// </summary>
-		static void SetWindowState(WindowState state);
+		static void SetWindowState(WindowState state, WindowHandle handle = {});
 
 		/// <summary>
 		/// Return true if the window is borderless.
 		/// </summary>
-		static bool IsWindowBorderless();
+		static bool IsWindowBorderless(WindowHandle handle = {});
 		/// <summary>
 		/// Allows to set the borderless state of the window,
 		/// if true, then the window will be set to borderless.
 		/// </summary>
-		static void SetWindowBorderlessState(bool newBorderlessState);
+		static void SetWindowBorderlessState(bool newBorderlessState, WindowHandle handle = {});
 
 		/// <summary>
 		/// Return true if the window is hidden.
 		/// </summary>
-		static bool IsWindowHidden();
+		static bool IsWindowHidden(WindowHandle handle = {});
 		/// <summary>
 		/// Allows to set the hidden state of the window,
 		/// if true, then the window will be set to hidden.
 		/// </summary>
-		static void SetWindowHiddenState(bool newWindowHiddenState);
+		static void SetWindowHiddenState(bool newWindowHiddenState, WindowHandle handle = {});
 
 		/// <summary>
 		/// Gets the position of the window.
 		/// </summary>
-		static POS GetWindowPosition();
+		static POS GetWindowPosition(WindowHandle handle = {});
 		/// <summary>
 		/// Sets the position of the window.
 		/// </summary>
-		static void SetWindowPosition(int width, int height);
+		static void SetWindowPosition(int width, int height, WindowHandle handle = {});
 
 		/// <summary>
 		/// Gets the total outer size (includes borders and top bar)
 		/// </summary>
-		static POS GetWindowFullSize();
+		static POS GetWindowFullSize(WindowHandle handle = {});
 		/// <summary>
 		/// Sets the total outer size of the window (includes borders and top bar)
 		/// </summary>
-		static void SetWindowFullSize(int width, int height);
+		static void SetWindowFullSize(int width, int height, WindowHandle handle = {});
 
 		/// <summary>
 		/// Gets the drawable/client area (without borders and top bar)
 		/// </summary>
-		static POS GetWindowContentSize();
+		static POS GetWindowContentSize(WindowHandle handle = {});
 		/// <summary>
 		/// Sets the drawable/client area (without borders and top bar)
 		/// </summary>
-		static void SetWindowContentSize(int width, int height);
+		static void SetWindowContentSize(int width, int height, WindowHandle handle = {});
 
 		/// <summary>
 		/// Get window maximum allowed size.
 		/// </summary>
-		static POS GetWindowMaxSize();
+		static POS GetWindowMaxSize(WindowHandle handle = {});
 		/// <summary>
 		/// Get window minimum allowed size.
 		/// </summary>
-		static POS GetWindowMinSize();
+		static POS GetWindowMinSize(WindowHandle handle = {});
 		/// <summary>
 		/// Set window minimum and maximum allowed size.
 		/// </summary>
@@ -120,45 +206,55 @@ namespace KalaKit
 			int maxWidth,
 			int maxHeight,
 			int minWidth,
-			int minHeight);
-	private:
-		/// <summary>
-		/// Used for checking whether window should be focused or not 
-		/// to enable any input to be registered.
-		/// </summary>
-		static inline bool isWindowFocusRequired;
+			int minHeight,
+			WindowHandle handle = {});
 
 		/// <summary>
-		/// Used for checking if this window is visible to the user or not.
-		/// If true, then this window is visible.
+		/// Apply every position and size change made since the last call with a single
+		/// OS call per window and send all queued requests to the display server.
+		/// The position and size setters only record the change, call this once per frame.
 		/// </summary>
-		static inline bool isWindowVisible = true;
+		static void FlushWindowChanges();
 
 		/// <summary>
-		/// Used for checking if this window is borderless or not.
-		/// If true, then this window is borderless.
+		/// Query the OS for the window geometry, visibility and style and replace the cached values.
+		/// Done automatically by the first getter, afterwards the window events keep the cache current.
 		/// </summary>
-		static inline bool isWindowBorderless = false;
+		static void RefreshWindowState(WindowHandle handle = {});
+
+		//
+		// WINDOW EVENTS
+		// Called by the window procedure or event loop so getters never have to query the OS.
+		// Should not be called manually.
+		//
 
 		/// <summary>
-		/// Currently assigned debug type
+		/// Content area origin in screen coordinates, as reported by WM_MOVE.
+		/// ConfigureNotify only reports screen coordinates for events sent by the window manager,
+		/// pass X11 events to OnWindowConfigured instead.
 		/// </summary>
-		static inline DebugType debugType = DebugType::DEBUG_NONE;
-
+		static void OnWindowMoved(POS contentPosition, WindowHandle handle = {});
+		static void OnWindowResized(POS contentSize, WindowHandle handle = {});
+		static void OnWindowVisibilityChanged(bool isVisible, WindowHandle handle = {});
+#if !defined(_WIN32) && X11_ENABLED
 		/// <summary>
-		/// Store original window flags when switching 
-		/// between borderless and non-borderless
+		/// Update position and size of the registered window from a ConfigureNotify event.
+		/// Events from the X server are relative to the window manager frame, so only the size
+		/// is taken from them and the position comes from the synthetic event the window manager
+		/// sends after every move. Events of unregistered windows are ignored.
 		/// </summary>
-		static inline LONG originalStyle = 0;
+		static void OnWindowConfigured(const XConfigureEvent& event);
+#endif
+	private:
 		/// <summary>
-		/// Store original size, position and show state 
-		/// when switching between borderless and non-borderless
+		/// Used for checking whether window should be focused or not 
+		/// to enable any input to be registered.
 		/// </summary>
-		static inline WINDOWPLACEMENT originalPlacement = { sizeof(WINDOWPLACEMENT) };
+		static inline bool isWindowFocusRequired;
 
-		static inline int maxWidth = 7680;
-		static inline int maxHeight = 4320;
-		static inline int minWidth = 800;
-		static inline int minHeight = 600;
+		/// <summary>
+		/// Currently assigned debug types
+		/// </summary>
+		static inline DebugType debugType = DebugType::DEBUG_NONE;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,324 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+//main log macro
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_ACTIONMAP", level, msg)
+
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include "actionmap.hpp"
+#include "stringutils.hpp"
+#include "keynames.hpp"
+#include "logger.hpp"
+
+using std::ifstream;
+using std::istringstream;
+using std::stringstream;
+using std::fill;
+using std::getline;
+
+namespace KalaKit
+{
+	namespace
+	{
+		const Key modifierKeys[] =
+		{
+			Key::LeftShift, Key::RightShift,
+			Key::LeftControl, Key::RightControl,
+			Key::LeftAlt, Key::RightAlt
+		};
+
+		string Trim(const string& value)
+		{
+			size_t start = value.find_first_not_of(" \t\r");
+			if (start == string::npos) return "";
+
+			size_t end = value.find_last_not_of(" \t\r");
+			return value.substr(start, end - start + 1);
+		}
+	}
+
+	ActionID ActionMap::AddBinding(
+		const string& actionName,
+		BindingType type,
+		initializer_list<Key> keys,
+		bool isExactModifiers)
+	{
+		return AddBinding(actionName, type, vector<Key>(keys), isExactModifiers);
+	}
+
+	ActionID ActionMap::AddBinding(
+		const string& actionName,
+		BindingType type,
+		const vector<Key>& keys,
+		bool isExactModifiers)
+	{
+		if (keys.empty())
+		{
+			LOG_ERROR("Cannot bind action '" << actionName << "' without any keys!");
+			return invalidAction;
+		}
+
+		KeyBitset heldMask{};
+		KeyBitset pressedMask{};
+		KeyBitset forbiddenMask{};
+
+		if (type == BindingType::CHORD)
+		{
+			for (Key key : keys)
+			{
+				heldMask.Set(key);
+				pressedMask.Set(key);
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i + 1 < keys.size(); i++)
+			{
+				heldMask.Set(keys[i]);
+			}
+			pressedMask.Set(keys.back());
+		}
+
+		if (isExactModifiers)
+		{
+			for (Key modifier : modifierKeys)
+			{
+				forbiddenMask.Set(modifier);
+			}
+			for (Key key : keys)
+			{
+				forbiddenMask.Reset(key);
+			}
+		}
+
+		ActionID action = GetOrCreateAction(actionName);
+
+		size_t binding = bindingActions.size();
+		if (binding == bindingCapacity) Reserve(bindingCapacity == 0 ? 64 : bindingCapacity * 2);
+
+		for (size_t w = 0; w < KeyBitset::wordCount; w++)
+		{
+			heldMasks[w * bindingCapacity + binding] = heldMask.words[w];
+			pressedMasks[w * bindingCapacity + binding] = pressedMask.words[w];
+			forbiddenMasks[w * bindingCapacity + binding] = forbiddenMask.words[w];
+
+			if ((heldMask.words[w] | pressedMask.words[w] | forbiddenMask.words[w]) != 0)
+			{
+				usedWords |= static_cast<uint8_t>(1u << w);
+			}
+		}
+		bindingActions.push_back(action);
+
+		return action;
+	}
+
+	bool ActionMap::LoadFromString(const string& config)
+	{
+		bool success = true;
+
+		istringstream stream(config);
+		string line{};
+		size_t lineNumber = 0;
+		while (getline(stream, line))
+		{
+			lineNumber++;
+
+			line = Trim(line);
+			if (line.empty() || line[0] == '#') continue;
+
+			size_t separator = line.find('=');
+			string actionName = separator == string::npos ? "" : Trim(line.substr(0, separator));
+			if (actionName.empty())
+			{
+				LOG_ERROR("Line " << lineNumber << " of action config is not in 'action = keys' format!");
+				success = false;
+				continue;
+			}
+
+			string keysText = Trim(line.substr(separator + 1));
+
+			bool isExactModifiers = keysText.rfind("exact ", 0) == 0;
+			if (isExactModifiers) keysText = Trim(keysText.substr(6));
+
+			bool isCombo = keysText.find('>') != string::npos;
+			vector<string> keyNames = StringUtils::Split(keysText, isCombo ? '>' : '+');
+
+			vector<Key> keys{};
+			bool isValid = !keyNames.empty();
+			for (const auto& keyName : keyNames)
+			{
+				Key key{};
+				if (!KeyNames::FromName(Trim(keyName), key))
+				{
+					LOG_ERROR("Unknown key '" << Trim(keyName) << "' on line " << lineNumber << " of action config!");
+					isValid = false;
+					break;
+				}
+				keys.push_back(key);
+			}
+
+			if (!isValid
+				|| AddBinding(
+					actionName,
+					isCombo ? BindingType::COMBO : BindingType::CHORD,
+					keys,
+					isExactModifiers) == invalidAction)
+			{
+				success = false;
+			}
+		}
+
+		return success;
+	}
+
+	bool ActionMap::LoadFromFile(const string& filePath)
+	{
+		ifstream file(filePath);
+		if (!file.is_open())
+		{
+			LOG_ERROR("Failed to open action config '" << filePath << "'!");
+			return false;
+		}
+
+		stringstream buffer{};
+		buffer << file.rdbuf();
+		return LoadFromString(buffer.str());
+	}
+
+	void ActionMap::Clear()
+	{
+		bindingCapacity = 0;
+		heldMasks.clear();
+		pressedMasks.clear();
+		forbiddenMasks.clear();
+		bindingActions.clear();
+		usedWords = 0;
+		failedTests.clear();
+		pressedHits.clear();
+
+		actionNames.clear();
+		actionLookup.clear();
+		triggeredActions.clear();
+	}
+
+	void ActionMap::Update()
+	{
+		Update(InputUtils::GetHeldKeys(), InputUtils::GetPressedKeys());
+	}
+
+	void ActionMap::Update(const KeyBitset& held, const KeyBitset& pressed)
+	{
+		size_t count = bindingActions.size();
+		uint64_t* failed = failedTests.data();
+		uint64_t* hits = pressedHits.data();
+
+		fill(failed, failed + count, 0);
+		fill(hits, hits + count, 0);
+
+		for (size_t w = 0; w < KeyBitset::wordCount; w++)
+		{
+			if ((usedWords & (1u << w)) == 0) continue;
+
+			const uint64_t heldWord = held.words[w];
+			const uint64_t pressedWord = pressed.words[w];
+			//a key pressed and released within the frame still counts as held for this frame
+			const uint64_t downWord = heldWord | pressedWord;
+			const uint64_t* heldMask = heldMasks.data() + w * bindingCapacity;
+			const uint64_t* pressedMask = pressedMasks.data() + w * bindingCapacity;
+			const uint64_t* forbiddenMask = forbiddenMasks.data() + w * bindingCapacity;
+
+			//branchless so the compiler can vectorize across bindings
+			for (size_t b = 0; b < count; b++)
+			{
+				failed[b] |= ((downWord & heldMask[b]) ^ heldMask[b]) | (heldWord & forbiddenMask[b]);
+				hits[b] |= pressedWord & pressedMask[b];
+			}
+		}
+
+		fill(triggeredActions.begin(), triggeredActions.end(), 0);
+		for (size_t b = 0; b < count; b++)
+		{
+			if (failed[b] == 0
+				&& hits[b] != 0)
+			{
+				ActionID action = bindingActions[b];
+				triggeredActions[action >> 6] |= uint64_t(1) << (action & 63);
+			}
+		}
+	}
+
+	bool ActionMap::IsTriggered(ActionID action) const
+	{
+		if (action >= actionNames.size()) return false;
+		return (triggeredActions[action >> 6] >> (action & 63)) & 1;
+	}
+
+	bool ActionMap::IsTriggered(const string& actionName) const
+	{
+		return IsTriggered(GetActionID(actionName));
+	}
+
+	ActionID ActionMap::GetActionID(const string& actionName) const
+	{
+		auto it = actionLookup.find(actionName);
+		return it == actionLookup.end() ? invalidAction : it->second;
+	}
+
+	const string& ActionMap::GetActionName(ActionID action) const
+	{
+		static const string empty{};
+		return action < actionNames.size() ? actionNames[action] : empty;
+	}
+
+	ActionID ActionMap::GetOrCreateAction(const string& actionName)
+	{
+		auto it = actionLookup.find(actionName);
+		if (it != actionLookup.end()) return it->second;
+
+		ActionID action = static_cast<ActionID>(actionNames.size());
+		actionNames.push_back(actionName);
+		actionLookup.emplace(actionName, action);
+		triggeredActions.resize((actionNames.size() + 63) / 64, 0);
+
+		return action;
+	}
+
+	void ActionMap::Reserve(size_t newCapacity)
+	{
+		size_t count = bindingActions.size();
+
+		//masks are word-major, so every word row moves to its new offset
+		auto relayout = [&](vector<uint64_t>& masks)
+			{
+				vector<uint64_t> resized(KeyBitset::wordCount * newCapacity, 0);
+				for (size_t w = 0; w < KeyBitset::wordCount; w++)
+				{
+					for (size_t b = 0; b < count; b++)
+					{
+						resized[w * newCapacity + b] = masks[w * bindingCapacity + b];
+					}
+				}
+				masks.swap(resized);
+			};
+
+		relayout(heldMasks);
+		relayout(pressedMasks);
+		relayout(forbiddenMasks);
+
+		failedTests.resize(newCapacity, 0);
+		pressedHits.resize(newCapacity, 0);
+		bindingActions.reserve(newCapacity);
+
+		bindingCapacity = newCapacity;
+	}
+}
@@ -0,0 +1,791 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+//main log macro
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_ASYNCFILEUTILS", level, msg)
+
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
+
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "asyncfileutils.hpp"
+#include "logger.hpp"
+
+using std::thread;
+using std::mutex;
+using std::lock_guard;
+using std::unique_lock;
+using std::condition_variable;
+using std::vector;
+using std::ifstream;
+using std::ofstream;
+using std::error_code;
+using std::filesystem::status;
+using std::filesystem::file_size;
+using std::filesystem::is_directory;
+using std::filesystem::exists;
+
+namespace KalaKit
+{
+	namespace
+	{
+		//intrusive FIFO so queueing a request never allocates
+		struct RequestQueue
+		{
+			AsyncFileRequest* head = nullptr;
+			AsyncFileRequest* tail = nullptr;
+
+			bool Empty() const { return head == nullptr; }
+
+			void Push(AsyncFileRequest* request)
+			{
+				request->next = nullptr;
+				if (tail) tail->next = request;
+				else head = request;
+				tail = request;
+			}
+
+			AsyncFileRequest* Pop()
+			{
+				AsyncFileRequest* request = head;
+				if (request)
+				{
+					head = request->next;
+					if (!head) tail = nullptr;
+					request->next = nullptr;
+				}
+				return request;
+			}
+		};
+
+		bool isInitialized = false;
+		bool useIoUring = false;
+
+		//only touched by the thread that submits and polls
+		size_t inFlightCount = 0;
+
+		//requests whose coroutine can be resumed
+		mutex completedMutex;
+		condition_variable completedCondition;
+		RequestQueue completedQueue;
+
+		//thread pool fallback
+		mutex workMutex;
+		condition_variable workCondition;
+		RequestQueue workQueue;
+		vector<thread> workers;
+		bool stopWorkers = false;
+
+		void CompleteRequest(AsyncFileRequest* request)
+		{
+			lock_guard<mutex> lock(completedMutex);
+			completedQueue.Push(request);
+			completedCondition.notify_one();
+		}
+
+		void RunBlocking(AsyncFileRequest* request)
+		{
+#ifdef __linux__
+			switch (request->operation)
+			{
+			case AsyncFileOperation::OPERATION_READ:
+			{
+				int fd = open(request->path.c_str(), O_RDONLY | O_CLOEXEC);
+				if (fd < 0)
+				{
+					request->error = errno;
+					return;
+				}
+
+				struct stat info{};
+				if (fstat(fd, &info) != 0)
+				{
+					request->error = errno;
+					close(fd);
+					return;
+				}
+
+				request->data.resize(static_cast<size_t>(info.st_size));
+				size_t total = 0;
+				while (total < request->data.size())
+				{
+					ssize_t result = read(
+						fd,
+						request->data.data() + total,
+						request->data.size() - total);
+
+					if (result < 0)
+					{
+						if (errno == EINTR) continue;
+						request->error = errno;
+						break;
+					}
+					if (result == 0) break;
+					total += static_cast<size_t>(result);
+				}
+				request->data.resize(total);
+				close(fd);
+				break;
+			}
+			case AsyncFileOperation::OPERATION_WRITE:
+			{
+				int fd = open(
+					request->path.c_str(),
+					O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+					0644);
+				if (fd < 0)
+				{
+					request->error = errno;
+					return;
+				}
+
+				size_t total = 0;
+				while (total < request->data.size())
+				{
+					ssize_t result = write(
+						fd,
+						request->data.data() + total,
+						request->data.size() - total);
+
+					if (result < 0)
+					{
+						if (errno == EINTR) continue;
+						request->error = errno;
+						break;
+					}
+					total += static_cast<size_t>(result);
+				}
+				if (close(fd) != 0 && request->error == 0) request->error = errno;
+				break;
+			}
+			case AsyncFileOperation::OPERATION_STAT:
+			{
+				struct stat info{};
+				if (stat(request->path.c_str(), &info) != 0)
+				{
+					request->error = errno;
+					return;
+				}
+
+				request->stat.exists = true;
+				request->stat.isDirectory = S_ISDIR(info.st_mode);
+				request->stat.size = static_cast<uintmax_t>(info.st_size);
+				break;
+			}
+			}
+#else
+			switch (request->operation)
+			{
+			case AsyncFileOperation::OPERATION_READ:
+			{
+				ifstream file(request->path, std::ios::binary | std::ios::ate);
+				if (!file.is_open())
+				{
+					request->error = ENOENT;
+					return;
+				}
+
+				std::streamoff size = file.tellg();
+				request->data.resize(static_cast<size_t>(size));
+				file.seekg(0);
+				file.read(request->data.data(), size);
+				if (file.gcount() != size) request->error = EIO;
+				break;
+			}
+			case AsyncFileOperation::OPERATION_WRITE:
+			{
+				ofstream file(request->path, std::ios::binary | std::ios::trunc);
+				if (!file.is_open())
+				{
+					request->error = EACCES;
+					return;
+				}
+
+				file.write(request->data.data(), request->data.size());
+				file.close();
+				if (!file) request->error = EIO;
+				break;
+			}
+			case AsyncFileOperation::OPERATION_STAT:
+			{
+				error_code ec{};
+				if (!exists(request->path, ec))
+				{
+					request->error = ENOENT;
+					return;
+				}
+
+				request->stat.exists = true;
+				request->stat.isDirectory = is_directory(request->path, ec);
+				if (!request->stat.isDirectory)
+				{
+					request->stat.size = file_size(request->path, ec);
+				}
+				break;
+			}
+			}
+#endif
+		}
+
+		void WorkerLoop()
+		{
+			while (true)
+			{
+				AsyncFileRequest* request = nullptr;
+				{
+					unique_lock<mutex> lock(workMutex);
+					workCondition.wait(lock, [] { return stopWorkers || !workQueue.Empty(); });
+					if (workQueue.Empty()) return;
+					request = workQueue.Pop();
+				}
+
+				RunBlocking(request);
+				CompleteRequest(request);
+			}
+		}
+
+#ifdef __linux__
+		//
+		// IO_URING REACTOR
+		//
+
+		//operations a request moves through
+		enum RequestStage
+		{
+			STAGE_OPEN = 0,
+			STAGE_TRANSFER = 1
+		};
+
+		//largest single read or write, sqe length is 32 bits
+		constexpr size_t maxTransferSize = size_t(1) << 30;
+
+		struct IoUring
+		{
+			int ringFd = -1;
+
+			unsigned* sqTail = nullptr;
+			unsigned* sqMask = nullptr;
+			unsigned* sqArray = nullptr;
+			unsigned sqEntries = 0;
+			io_uring_sqe* sqes = nullptr;
+
+			unsigned* cqHead = nullptr;
+			unsigned* cqTail = nullptr;
+			unsigned* cqMask = nullptr;
+			io_uring_cqe* cqes = nullptr;
+
+			void* sqRing = nullptr;
+			size_t sqRingSize = 0;
+			void* cqRing = nullptr;
+			size_t cqRingSize = 0;
+			size_t sqesSize = 0;
+
+			//written to the submission ring but not yet passed to io_uring_enter
+			unsigned pendingSubmit = 0;
+			//passed to the kernel and waiting for a completion
+			unsigned inKernel = 0;
+		};
+
+		IoUring ring{};
+
+		//requests that could not get a submission slot yet
+		RequestQueue waitingForSlot;
+
+		bool IsRingOperationSupported(const io_uring_probe* probe, unsigned op)
+		{
+			return op <= probe->last_op
+				&& (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+		}
+
+		void DestroyRing()
+		{
+			if (ring.sqes) munmap(ring.sqes, ring.sqesSize);
+			if (ring.cqRing && ring.cqRing != ring.sqRing) munmap(ring.cqRing, ring.cqRingSize);
+			if (ring.sqRing) munmap(ring.sqRing, ring.sqRingSize);
+			if (ring.ringFd >= 0) close(ring.ringFd);
+			ring = IoUring{};
+		}
+
+		bool CreateRing(unsigned int queueDepth)
+		{
+			io_uring_params params{};
+			int fd = static_cast<int>(syscall(__NR_io_uring_setup, queueDepth, &params));
+			if (fd < 0) return false;
+			ring.ringFd = fd;
+
+			//the kernel must support every operation the reactor issues
+			vector<unsigned char> probeBuffer(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op));
+			io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probeBuffer.data());
+			if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) < 0
+				|| !IsRingOperationSupported(probe, IORING_OP_OPENAT)
+				|| !IsRingOperationSupported(probe, IORING_OP_READ)
+				|| !IsRingOperationSupported(probe, IORING_OP_WRITE)
+				|| !IsRingOperationSupported(probe, IORING_OP_STATX))
+			{
+				DestroyRing();
+				return false;
+			}
+
+			ring.sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			ring.cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+			if (singleMap)
+			{
+				if (ring.cqRingSize > ring.sqRingSize) ring.sqRingSize = ring.cqRingSize;
+				ring.cqRingSize = ring.sqRingSize;
+			}
+
+			void* sqRing = mmap(
+				nullptr,
+				ring.sqRingSize,
+				PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE,
+				fd,
+				IORING_OFF_SQ_RING);
+			if (sqRing == MAP_FAILED)
+			{
+				DestroyRing();
+				return false;
+			}
+			ring.sqRing = sqRing;
+
+			void* cqRing = sqRing;
+			if (!singleMap)
+			{
+				cqRing = mmap(
+					nullptr,
+					ring.cqRingSize,
+					PROT_READ | PROT_WRITE,
+					MAP_SHARED | MAP_POPULATE,
+					fd,
+					IORING_OFF_CQ_RING);
+				if (cqRing == MAP_FAILED)
+				{
+					DestroyRing();
+					return false;
+				}
+			}
+			ring.cqRing = cqRing;
+
+			ring.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+			void* sqes = mmap(
+				nullptr,
+				ring.sqesSize,
+				PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE,
+				fd,
+				IORING_OFF_SQES);
+			if (sqes == MAP_FAILED)
+			{
+				DestroyRing();
+				return false;
+			}
+			ring.sqes = static_cast<io_uring_sqe*>(sqes);
+
+			char* sq = static_cast<char*>(sqRing);
+			ring.sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+			ring.sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+			ring.sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+			ring.sqEntries = params.sq_entries;
+
+			char* cq = static_cast<char*>(cqRing);
+			ring.cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+			ring.cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+			ring.cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+			ring.cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+			return true;
+		}
+
+		io_uring_sqe* GetSubmissionEntry()
+		{
+			//never hand out more entries than the ring can complete at once
+			if (ring.pendingSubmit + ring.inKernel >= ring.sqEntries) return nullptr;
+
+			unsigned tail = *ring.sqTail;
+			unsigned index = tail & *ring.sqMask;
+			io_uring_sqe* sqe = &ring.sqes[index];
+			memset(sqe, 0, sizeof(io_uring_sqe));
+			ring.sqArray[index] = index;
+			__atomic_store_n(ring.sqTail, tail + 1, __ATOMIC_RELEASE);
+			ring.pendingSubmit++;
+			return sqe;
+		}
+
+		//queue the next operation of the request, or park it until a slot frees up
+		void IssueStage(AsyncFileRequest* request)
+		{
+			io_uring_sqe* sqe = GetSubmissionEntry();
+			if (!sqe)
+			{
+				waitingForSlot.Push(request);
+				return;
+			}
+
+			sqe->user_data = reinterpret_cast<uint64_t>(request);
+
+			if (request->operation == AsyncFileOperation::OPERATION_STAT)
+			{
+				sqe->opcode = IORING_OP_STATX;
+				sqe->fd = AT_FDCWD;
+				sqe->addr = reinterpret_cast<uint64_t>(request->path.c_str());
+				sqe->len = STATX_TYPE | STATX_SIZE;
+				sqe->off = reinterpret_cast<uint64_t>(request->statBuffer);
+				return;
+			}
+
+			if (request->stage == STAGE_OPEN)
+			{
+				bool isRead = request->operation == AsyncFileOperation::OPERATION_READ;
+				sqe->opcode = IORING_OP_OPENAT;
+				sqe->fd = AT_FDCWD;
+				sqe->addr = reinterpret_cast<uint64_t>(request->path.c_str());
+				sqe->len = isRead ? 0 : 0644;
+				sqe->open_flags = isRead
+					? O_RDONLY | O_CLOEXEC
+					: O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+				return;
+			}
+
+			size_t remaining = request->data.size() - request->offset;
+			if (remaining > maxTransferSize) remaining = maxTransferSize;
+
+			sqe->opcode = request->operation == AsyncFileOperation::OPERATION_READ
+				? IORING_OP_READ
+				: IORING_OP_WRITE;
+			sqe->fd = request->fd;
+			sqe->addr = reinterpret_cast<uint64_t>(request->data.data() + request->offset);
+			sqe->len = static_cast<unsigned>(remaining);
+			sqe->off = request->offset;
+		}
+
+		void FinishRingRequest(AsyncFileRequest* request)
+		{
+			//close is cheap compared to the transfer, no need to round-trip it through the ring
+			if (request->fd >= 0)
+			{
+				if (close(request->fd) != 0
+					&& request->operation == AsyncFileOperation::OPERATION_WRITE
+					&& request->error == 0)
+				{
+					request->error = errno;
+				}
+				request->fd = -1;
+			}
+
+			CompleteRequest(request);
+		}
+
+		void HandleCompletion(AsyncFileRequest* request, int result)
+		{
+			if (request->operation == AsyncFileOperation::OPERATION_STAT)
+			{
+				if (result < 0)
+				{
+					request->error = -result;
+				}
+				else
+				{
+					const struct statx* info = reinterpret_cast<const struct statx*>(request->statBuffer);
+					request->stat.exists = true;
+					request->stat.isDirectory = S_ISDIR(info->stx_mode);
+					request->stat.size = static_cast<uintmax_t>(info->stx_size);
+				}
+				FinishRingRequest(request);
+				return;
+			}
+
+			if (result < 0)
+			{
+				request->error = -result;
+				FinishRingRequest(request);
+				return;
+			}
+
+			if (request->stage == STAGE_OPEN)
+			{
+				request->fd = result;
+				request->stage = STAGE_TRANSFER;
+				request->offset = 0;
+
+				if (request->operation == AsyncFileOperation::OPERATION_READ)
+				{
+					//the inode is already loaded by open, fstat does not touch the disk
+					struct stat info{};
+					if (fstat(request->fd, &info) != 0)
+					{
+						request->error = errno;
+						FinishRingRequest(request);
+						return;
+					}
+					request->data.resize(static_cast<size_t>(info.st_size));
+				}
+
+				if (request->data.empty())
+				{
+					FinishRingRequest(request);
+					return;
+				}
+
+				IssueStage(request);
+				return;
+			}
+
+			//short read means the file shrank after fstat
+			if (result == 0)
+			{
+				if (request->operation == AsyncFileOperation::OPERATION_READ)
+				{
+					request->data.resize(request->offset);
+				}
+				else request->error = EIO;
+
+				FinishRingRequest(request);
+				return;
+			}
+
+			request->offset += static_cast<size_t>(result);
+			if (request->offset < request->data.size())
+			{
+				IssueStage(request);
+				return;
+			}
+
+			FinishRingRequest(request);
+		}
+
+		void ReapCompletions()
+		{
+			unsigned head = *ring.cqHead;
+			unsigned tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+
+			while (head != tail)
+			{
+				const io_uring_cqe& cqe = ring.cqes[head & *ring.cqMask];
+				AsyncFileRequest* request = reinterpret_cast<AsyncFileRequest*>(cqe.user_data);
+				int result = cqe.res;
+
+				head++;
+				ring.inKernel--;
+				HandleCompletion(request, result);
+			}
+
+			__atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+		}
+
+		void SubmitAndReap(bool wait)
+		{
+			//parked requests get the slots freed by the previous reap
+			while (!waitingForSlot.Empty()
+				&& ring.pendingSubmit + ring.inKernel < ring.sqEntries)
+			{
+				IssueStage(waitingForSlot.Pop());
+			}
+
+			unsigned flags = 0;
+			unsigned minComplete = 0;
+			if (wait
+				&& ring.inKernel + ring.pendingSubmit > 0)
+			{
+				flags |= IORING_ENTER_GETEVENTS;
+				minComplete = 1;
+			}
+
+			if (ring.pendingSubmit > 0
+				|| flags != 0)
+			{
+				long submitted = syscall(
+					__NR_io_uring_enter,
+					ring.ringFd,
+					ring.pendingSubmit,
+					minComplete,
+					flags,
+					nullptr,
+					0);
+
+				if (submitted < 0)
+				{
+					if (errno != EINTR
+						&& errno != EAGAIN
+						&& errno != EBUSY)
+					{
+						LOG_ERROR("io_uring_enter failed: " << strerror(errno));
+					}
+				}
+				else
+				{
+					ring.pendingSubmit -= static_cast<unsigned>(submitted);
+					ring.inKernel += static_cast<unsigned>(submitted);
+				}
+			}
+
+			ReapCompletions();
+		}
+#endif
+	}
+
+	bool AsyncFileUtils::Initialize(unsigned int threadCount, unsigned int queueDepth)
+	{
+		if (isInitialized) return true;
+
+#ifdef __linux__
+		if (CreateRing(queueDepth))
+		{
+			useIoUring = true;
+			isInitialized = true;
+
+			LOG_DEBUG("Initialized io_uring reactor with " << ring.sqEntries << " entries.");
+			return true;
+		}
+#endif
+
+		if (threadCount == 0) threadCount = thread::hardware_concurrency();
+		if (threadCount == 0) threadCount = 4;
+
+		stopWorkers = false;
+		for (unsigned int i = 0; i < threadCount; i++)
+		{
+			workers.emplace_back(WorkerLoop);
+		}
+
+		useIoUring = false;
+		isInitialized = true;
+
+		LOG_DEBUG("Initialized thread pool reactor with " << threadCount << " threads.");
+		return true;
+	}
+
+	void AsyncFileUtils::Shutdown()
+	{
+		if (!isInitialized) return;
+
+		if (inFlightCount > 0)
+		{
+			LOG_ERROR("Shutting down with " << inFlightCount << " requests in flight, waiting for them to finish.");
+			RunUntilIdle();
+		}
+
+#ifdef __linux__
+		if (useIoUring) DestroyRing();
+#endif
+
+		{
+			lock_guard<mutex> lock(workMutex);
+			stopWorkers = true;
+		}
+		workCondition.notify_all();
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+		workers.clear();
+
+		useIoUring = false;
+		isInitialized = false;
+	}
+
+	bool AsyncFileUtils::IsUsingIoUring()
+	{
+		return useIoUring;
+	}
+
+	void AsyncFileUtils::Submit(AsyncFileRequest* request)
+	{
+		if (!isInitialized) Initialize();
+
+		inFlightCount++;
+		request->error = 0;
+		request->stage = 0;
+		request->offset = 0;
+		request->fd = -1;
+
+#ifdef __linux__
+		if (useIoUring)
+		{
+			IssueStage(request);
+			return;
+		}
+#endif
+
+		{
+			lock_guard<mutex> lock(workMutex);
+			workQueue.Push(request);
+		}
+		workCondition.notify_one();
+	}
+
+	size_t AsyncFileUtils::Poll(bool wait)
+	{
+		if (!isInitialized) return 0;
+
+		RequestQueue ready{};
+
+#ifdef __linux__
+		if (useIoUring)
+		{
+			bool hasReady = false;
+			{
+				lock_guard<mutex> lock(completedMutex);
+				hasReady = !completedQueue.Empty();
+			}
+			SubmitAndReap(wait && !hasReady);
+		}
+#endif
+
+		{
+			unique_lock<mutex> lock(completedMutex);
+			if (wait
+				&& !useIoUring
+				&& inFlightCount > 0)
+			{
+				completedCondition.wait(lock, [] { return !completedQueue.Empty(); });
+			}
+			ready = completedQueue;
+			completedQueue = RequestQueue{};
+		}
+
+		//resuming may submit new requests, they land in a fresh queue
+		size_t resumed = 0;
+		while (AsyncFileRequest* request = ready.Pop())
+		{
+			inFlightCount--;
+			resumed++;
+			request->continuation.resume();
+		}
+
+		return resumed;
+	}
+
+	void AsyncFileUtils::RunUntilIdle()
+	{
+		while (inFlightCount > 0)
+		{
+			Poll(true);
+		}
+	}
+
+	size_t AsyncFileUtils::GetInFlightCount()
+	{
+		return inFlightCount;
+	}
+}
@@ -0,0 +1,1208 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+//main log macro
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_COMPRESSIONUTILS", level, msg)
+
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
+
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <new>
+#include <algorithm>
+
+#include "compressionutils.hpp"
+#include "logger.hpp"
+
+using std::thread;
+using std::atomic;
+using std::memcpy;
+using std::memset;
+using std::countr_zero;
+using std::rotl;
+using std::bad_alloc;
+using std::min;
+
+namespace KalaKit
+{
+	//the block and frame formats are little-endian, so are all supported targets
+	static_assert(std::endian::native == std::endian::little, "LZ4 code assumes a little-endian target");
+
+	namespace
+	{
+		constexpr uint32_t frameMagic = 0x184D2204;
+		constexpr uint32_t skippableMagic = 0x184D2A50;
+		constexpr uint32_t skippableMask = 0xFFFFFFF0;
+		constexpr uint32_t uncompressedBlockFlag = 0x80000000;
+
+		constexpr size_t minMatch = 4;
+		constexpr size_t lastLiterals = 5;
+		constexpr size_t matchFindLimit = 12;
+		constexpr size_t maxDistance = 65535;
+		constexpr size_t maxInputSize = 0x7E000000;
+		constexpr size_t historySize = 64 * 1024;
+
+		//same table size as the reference implementation at its default memory usage
+		constexpr uint32_t hashLog = 12;
+		constexpr uint32_t skipTrigger = 6;
+
+		//used by the decoder to expand matches whose offset is below 8
+		constexpr int offsetIncrement[8] = { 0, 1, 2, 1, 0, 4, 4, 4 };
+		constexpr int offsetDecrement[8] = { 0, 0, 0, -1, -4, 1, 2, 3 };
+
+		constexpr uint32_t prime1 = 2654435761U;
+		constexpr uint32_t prime2 = 2246822519U;
+		constexpr uint32_t prime3 = 3266489917U;
+		constexpr uint32_t prime4 = 668265263U;
+		constexpr uint32_t prime5 = 374761393U;
+
+		inline uint16_t Read16(const void* ptr) { uint16_t value; memcpy(&value, ptr, 2); return value; }
+		inline uint32_t Read32(const void* ptr) { uint32_t value; memcpy(&value, ptr, 4); return value; }
+		inline uint64_t Read64(const void* ptr) { uint64_t value; memcpy(&value, ptr, 8); return value; }
+		inline void Write16(void* ptr, uint16_t value) { memcpy(ptr, &value, 2); }
+		inline void Write32(void* ptr, uint32_t value) { memcpy(ptr, &value, 4); }
+		inline void Write64(void* ptr, uint64_t value) { memcpy(ptr, &value, 8); }
+
+		inline uint32_t HashSequence(uint32_t sequence)
+		{
+			return (sequence * prime1) >> (32 - hashLog);
+		}
+
+		inline uint32_t XXH32Round(uint32_t accumulator, uint32_t input)
+		{
+			accumulator += input * prime2;
+			accumulator = rotl(accumulator, 13);
+			return accumulator * prime1;
+		}
+
+		uint32_t XXH32(const void* data, size_t size)
+		{
+			XXH32State state{};
+			state.Reset(0);
+			state.Update(data, size);
+			return state.Digest();
+		}
+
+		//how many bytes match after the first minMatch bytes
+		inline size_t CountMatch(const uint8_t* in, const uint8_t* match, const uint8_t* inLimit)
+		{
+			const uint8_t* start = in;
+			while (in + 8 <= inLimit)
+			{
+				uint64_t diff = Read64(match) ^ Read64(in);
+				if (diff) return static_cast<size_t>(in - start) + (countr_zero(diff) >> 3);
+				in += 8;
+				match += 8;
+			}
+			while (in < inLimit && *match == *in)
+			{
+				in++;
+				match++;
+			}
+			return static_cast<size_t>(in - start);
+		}
+
+		inline uint8_t* WriteLength(uint8_t* op, size_t length)
+		{
+			for (; length >= 255; length -= 255) *op++ = 255;
+			*op++ = static_cast<uint8_t>(length);
+			return op;
+		}
+
+		size_t CompressBlockImpl(
+			const char* source,
+			size_t srcSize,
+			char* dest,
+			size_t dstCapacity,
+			uint32_t* hashTable)
+		{
+			if (srcSize > maxInputSize) return 0;
+
+			const uint8_t* src = reinterpret_cast<const uint8_t*>(source);
+			const uint8_t* ip = src;
+			const uint8_t* anchor = src;
+			const uint8_t* iend = src + srcSize;
+			uint8_t* op = reinterpret_cast<uint8_t*>(dest);
+			uint8_t* oend = op + dstCapacity;
+
+			memset(hashTable, 0, sizeof(uint32_t) << hashLog);
+
+			//blocks this small are stored as a single literal run
+			if (srcSize > matchFindLimit)
+			{
+				//last match must start atleast 12 bytes before the end
+				//and the last 5 bytes are always literals
+				const uint8_t* matchFindEnd = iend - matchFindLimit;
+				const uint8_t* matchLimit = iend - lastLiterals;
+
+				hashTable[HashSequence(Read32(ip))] = 0;
+				ip++;
+
+				while (true)
+				{
+					//search forward, skipping faster the longer nothing matches
+					const uint8_t* match = nullptr;
+					const uint8_t* forwardIp = ip;
+					uint32_t searchCount = 1u << skipTrigger;
+					while (true)
+					{
+						ip = forwardIp;
+						forwardIp += searchCount++ >> skipTrigger;
+						if (ip > matchFindEnd) goto last_literals;
+
+						uint32_t sequence = Read32(ip);
+						uint32_t hash = HashSequence(sequence);
+						match = src + hashTable[hash];
+						hashTable[hash] = static_cast<uint32_t>(ip - src);
+
+						if (static_cast<size_t>(ip - match) <= maxDistance
+							&& Read32(match) == sequence)
+						{
+							break;
+						}
+					}
+
+					//extend the match backwards into the pending literals
+					while (ip > anchor
+						&& match > src
+						&& ip[-1] == match[-1])
+					{
+						ip--;
+						match--;
+					}
+
+					size_t literalLength = static_cast<size_t>(ip - anchor);
+					if (static_cast<size_t>(oend - op) < 1 + literalLength + literalLength / 255 + 1 + 2)
+					{
+						return 0;
+					}
+
+					uint8_t* token = op++;
+					if (literalLength >= 15)
+					{
+						*token = 15 << 4;
+						op = WriteLength(op, literalLength - 15);
+					}
+					else *token = static_cast<uint8_t>(literalLength << 4);
+
+					memcpy(op, anchor, literalLength);
+					op += literalLength;
+
+					//emit matches back to back while the next position matches immediately
+					while (true)
+					{
+						Write16(op, static_cast<uint16_t>(ip - match));
+						op += 2;
+
+						size_t matchLength = CountMatch(ip + minMatch, match + minMatch, matchLimit);
+						ip += matchLength + minMatch;
+
+						if (static_cast<size_t>(oend - op) < matchLength / 255 + 1)
+						{
+							return 0;
+						}
+
+						if (matchLength >= 15)
+						{
+							*token += 15;
+							op = WriteLength(op, matchLength - 15);
+						}
+						else *token += static_cast<uint8_t>(matchLength);
+
+						anchor = ip;
+						if (ip > matchFindEnd) goto last_literals;
+
+						hashTable[HashSequence(Read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src);
+
+						uint32_t sequence = Read32(ip);
+						uint32_t hash = HashSequence(sequence);
+						match = src + hashTable[hash];
+						hashTable[hash] = static_cast<uint32_t>(ip - src);
+
+						if (static_cast<size_t>(ip - match) > maxDistance
+							|| Read32(match) != sequence)
+						{
+							break;
+						}
+
+						if (static_cast<size_t>(oend - op) < 1 + 2) return 0;
+						token = op++;
+						*token = 0;
+					}
+
+					ip++;
+				}
+			}
+
+		last_literals:
+			size_t lastRun = static_cast<size_t>(iend - anchor);
+			if (static_cast<size_t>(oend - op) < 1 + lastRun + (lastRun + 255 - 15) / 255)
+			{
+				return 0;
+			}
+
+			if (lastRun >= 15)
+			{
+				*op++ = 15 << 4;
+				op = WriteLength(op, lastRun - 15);
+			}
+			else *op++ = static_cast<uint8_t>(lastRun << 4);
+
+			memcpy(op, anchor, lastRun);
+			op += lastRun;
+
+			return static_cast<size_t>(op - reinterpret_cast<uint8_t*>(dest));
+		}
+
+		//matches may reach back to historyStart, which is dest for independent blocks
+		//or the start of the previous 64KB of output for linked blocks
+		bool DecompressBlockImpl(
+			const char* source,
+			size_t srcSize,
+			char* dest,
+			size_t dstCapacity,
+			const char* historyStart,
+			size_t& outSize)
+		{
+			const uint8_t* ip = reinterpret_cast<const uint8_t*>(source);
+			const uint8_t* iend = ip + srcSize;
+			uint8_t* op = reinterpret_cast<uint8_t*>(dest);
+			uint8_t* oend = op + dstCapacity;
+			const uint8_t* lowLimit = reinterpret_cast<const uint8_t*>(historyStart);
+
+			if (srcSize == 0) return false;
+
+			while (true)
+			{
+				if (ip >= iend) return false;
+				unsigned int token = *ip++;
+				size_t length = token >> 4;
+				size_t offset = 0;
+
+				//shortcut for the common case of a short literal run followed by a short match,
+				//with enough room on both sides for fixed-size copies
+				if (length < 15
+					&& (token & 15) < 15
+					&& iend - ip >= 16 + 2
+					&& oend - op >= 32)
+				{
+					memcpy(op, ip, 16);
+					op += length;
+					ip += length;
+
+					offset = Read16(ip);
+					ip += 2;
+					length = (token & 15) + minMatch;
+
+					if (offset >= 8
+						&& static_cast<size_t>(op - lowLimit) >= offset)
+					{
+						const uint8_t* match = op - offset;
+						memcpy(op, match, 8);
+						memcpy(op + 8, match + 8, 8);
+						memcpy(op + 16, match + 16, 2);
+						op += length;
+						continue;
+					}
+				}
+				else
+				{
+					if (length == 15)
+					{
+						unsigned int extra = 0;
+						do
+						{
+							if (ip >= iend) return false;
+							extra = *ip++;
+							length += extra;
+						} while (extra == 255);
+					}
+
+					if (static_cast<size_t>(iend - ip) < length
+						|| static_cast<size_t>(oend - op) < length)
+					{
+						return false;
+					}
+
+					if (length <= 16
+						&& iend - ip >= 16
+						&& oend - op >= 16)
+					{
+						memcpy(op, ip, 16);
+					}
+					else memcpy(op, ip, length);
+					op += length;
+					ip += length;
+
+					//the last sequence has literals only
+					if (ip == iend) break;
+
+					if (iend - ip < 2) return false;
+					offset = Read16(ip);
+					ip += 2;
+
+					length = token & 15;
+					if (length == 15)
+					{
+						unsigned int extra = 0;
+						do
+						{
+							if (ip >= iend) return false;
+							extra = *ip++;
+							length += extra;
+						} while (extra == 255);
+					}
+					length += minMatch;
+				}
+
+				if (offset == 0
+					|| static_cast<size_t>(op - lowLimit) < offset
+					|| static_cast<size_t>(oend - op) < length)
+				{
+					return false;
+				}
+				const uint8_t* match = op - offset;
+
+				uint8_t* copyEnd = op + length;
+				if (static_cast<size_t>(oend - op) >= length + 16)
+				{
+					//spread short offsets until the source is atleast 8 bytes behind
+					if (offset < 8)
+					{
+						op[0] = match[0];
+						op[1] = match[1];
+						op[2] = match[2];
+						op[3] = match[3];
+						match += offsetIncrement[offset];
+						memcpy(op + 4, match, 4);
+						match -= offsetDecrement[offset];
+						op += 8;
+					}
+
+					if (op - match >= 16)
+					{
+						do
+						{
+							memcpy(op, match, 16);
+							op += 16;
+							match += 16;
+						} while (op < copyEnd);
+					}
+					else
+					{
+						do
+						{
+							memcpy(op, match, 8);
+							op += 8;
+							match += 8;
+						} while (op < copyEnd);
+					}
+				}
+				else
+				{
+					//near the end of the buffer, repeats the last offset bytes
+					while (op < copyEnd) *op++ = *match++;
+				}
+				op = copyEnd;
+			}
+
+			outSize = static_cast<size_t>(op - reinterpret_cast<uint8_t*>(dest));
+			return true;
+		}
+
+		unsigned int ResolveThreadCount(unsigned int threadCount, size_t workCount)
+		{
+			if (threadCount == 0) threadCount = thread::hardware_concurrency();
+			if (threadCount == 0) threadCount = 1;
+			if (threadCount > workCount) threadCount = static_cast<unsigned int>(workCount);
+			return threadCount == 0 ? 1 : threadCount;
+		}
+
+		//runs job(index) for every index, spread across threadCount threads
+		template<typename Job>
+		void RunParallel(size_t count, unsigned int threadCount, const Job& job)
+		{
+			threadCount = ResolveThreadCount(threadCount, count);
+			if (threadCount <= 1)
+			{
+				for (size_t i = 0; i < count; i++) job(i);
+				return;
+			}
+
+			atomic<size_t> nextIndex{ 0 };
+			auto worker = [&]()
+				{
+					for (size_t i = nextIndex++; i < count; i = nextIndex++) job(i);
+				};
+
+			vector<thread> threads;
+			threads.reserve(threadCount - 1);
+			for (unsigned int i = 1; i < threadCount; i++) threads.emplace_back(worker);
+			worker();
+			for (auto& t : threads) t.join();
+		}
+
+		//magic, descriptor and header checksum
+		size_t WriteFrameHeader(char* out, LZ4BlockSize blockSize, bool hasContentSize, uint64_t contentSize)
+		{
+			Write32(out, frameMagic);
+
+			uint8_t flags = 0x40  //version 01
+				| 0x20            //independent blocks
+				| 0x04;           //content checksum
+			if (hasContentSize) flags |= 0x08;
+
+			size_t position = 4;
+			out[position++] = static_cast<char>(flags);
+			out[position++] = static_cast<char>(static_cast<uint8_t>(blockSize) << 4);
+			if (hasContentSize)
+			{
+				Write64(out + position, contentSize);
+				position += 8;
+			}
+
+			out[position] = static_cast<char>((XXH32(out + 4, position - 4) >> 8) & 0xFF);
+			return position + 1;
+		}
+
+		struct FrameDescriptor
+		{
+			bool isIndependent = true;
+			bool hasBlockChecksum = false;
+			bool hasContentSize = false;
+			bool hasContentChecksum = false;
+			uint64_t contentSize = 0;
+			size_t blockMaxSize = 0;
+			size_t headerSize = 0;
+		};
+
+		//parses everything after the magic number, returns false on unsupported or corrupt headers
+		bool ParseFrameDescriptor(const char* data, size_t size, FrameDescriptor& descriptor)
+		{
+			if (size < 3) return false;
+
+			uint8_t flags = static_cast<uint8_t>(data[0]);
+			uint8_t blockDescriptor = static_cast<uint8_t>(data[1]);
+
+			if ((flags >> 6) != 1)
+			{
+				LOG_ERROR("Unsupported LZ4 frame version!");
+				return false;
+			}
+			if (flags & 0x01)
+			{
+				LOG_ERROR("LZ4 frames with dictionaries are not supported!");
+				return false;
+			}
+			if ((flags & 0x02) || (blockDescriptor & 0x8F)) return false;
+
+			uint8_t blockSizeId = (blockDescriptor >> 4) & 0x07;
+			if (blockSizeId < 4) return false;
+
+			descriptor.isIndependent = (flags & 0x20) != 0;
+			descriptor.hasBlockChecksum = (flags & 0x10) != 0;
+			descriptor.hasContentSize = (flags & 0x08) != 0;
+			descriptor.hasContentChecksum = (flags & 0x04) != 0;
+			descriptor.blockMaxSize = CompressionUtils::GetBlockSizeBytes(static_cast<LZ4BlockSize>(blockSizeId));
+
+			size_t position = 2;
+			if (descriptor.hasContentSize)
+			{
+				if (size < position + 8 + 1) return false;
+				descriptor.contentSize = Read64(data + position);
+				position += 8;
+			}
+
+			uint8_t headerChecksum = static_cast<uint8_t>((XXH32(data, position) >> 8) & 0xFF);
+			if (static_cast<uint8_t>(data[position]) != headerChecksum)
+			{
+				LOG_ERROR("LZ4 frame header checksum mismatch!");
+				return false;
+			}
+
+			descriptor.headerSize = position + 1;
+			return true;
+		}
+	}
+
+	//
+	// XXH32
+	//
+
+	void XXH32State::Reset(uint32_t newSeed)
+	{
+		seed = newSeed;
+		accumulators[0] = seed + prime1 + prime2;
+		accumulators[1] = seed + prime2;
+		accumulators[2] = seed;
+		accumulators[3] = seed - prime1;
+		totalLength = 0;
+		bufferSize = 0;
+	}
+
+	void XXH32State::Update(const void* data, size_t size)
+	{
+		const unsigned char* input = static_cast<const unsigned char*>(data);
+		const unsigned char* end = input + size;
+		totalLength += size;
+
+		if (bufferSize + size < 16)
+		{
+			memcpy(buffer + bufferSize, input, size);
+			bufferSize += static_cast<uint32_t>(size);
+			return;
+		}
+
+		if (bufferSize > 0)
+		{
+			size_t fill = 16 - bufferSize;
+			memcpy(buffer + bufferSize, input, fill);
+			for (int i = 0; i < 4; i++)
+			{
+				accumulators[i] = XXH32Round(accumulators[i], Read32(buffer + i * 4));
+			}
+			input += fill;
+			bufferSize = 0;
+		}
+
+		uint32_t v1 = accumulators[0];
+		uint32_t v2 = accumulators[1];
+		uint32_t v3 = accumulators[2];
+		uint32_t v4 = accumulators[3];
+		while (end - input >= 16)
+		{
+			v1 = XXH32Round(v1, Read32(input));
+			v2 = XXH32Round(v2, Read32(input + 4));
+			v3 = XXH32Round(v3, Read32(input + 8));
+			v4 = XXH32Round(v4, Read32(input + 12));
+			input += 16;
+		}
+		accumulators[0] = v1;
+		accumulators[1] = v2;
+		accumulators[2] = v3;
+		accumulators[3] = v4;
+
+		bufferSize = static_cast<uint32_t>(end - input);
+		memcpy(buffer, input, bufferSize);
+	}
+
+	uint32_t XXH32State::Digest() const
+	{
+		uint32_t hash = totalLength >= 16
+			? rotl(accumulators[0], 1)
+				+ rotl(accumulators[1], 7)
+				+ rotl(accumulators[2], 12)
+				+ rotl(accumulators[3], 18)
+			: seed + prime5;
+
+		hash += static_cast<uint32_t>(totalLength);
+
+		const unsigned char* input = buffer;
+		const unsigned char* end = buffer + bufferSize;
+		while (end - input >= 4)
+		{
+			hash += Read32(input) * prime3;
+			hash = rotl(hash, 17) * prime4;
+			input += 4;
+		}
+		while (input < end)
+		{
+			hash += (*input) * prime5;
+			hash = rotl(hash, 11) * prime1;
+			input++;
+		}
+
+		hash ^= hash >> 15;
+		hash *= prime2;
+		hash ^= hash >> 13;
+		hash *= prime3;
+		hash ^= hash >> 16;
+		return hash;
+	}
+
+	//
+	// BLOCKS
+	//
+
+	size_t CompressionUtils::CompressBound(size_t inputSize)
+	{
+		return inputSize > maxInputSize ? 0 : inputSize + inputSize / 255 + 16;
+	}
+
+	size_t CompressionUtils::CompressBlock(
+		const char* src,
+		size_t srcSize,
+		char* dst,
+		size_t dstCapacity)
+	{
+		thread_local vector<uint32_t> hashTable(size_t(1) << hashLog);
+		return CompressBlockImpl(src, srcSize, dst, dstCapacity, hashTable.data());
+	}
+
+	bool CompressionUtils::DecompressBlock(
+		const char* src,
+		size_t srcSize,
+		char* dst,
+		size_t dstCapacity,
+		size_t& outSize)
+	{
+		return DecompressBlockImpl(src, srcSize, dst, dstCapacity, dst, outSize);
+	}
+
+	size_t CompressionUtils::GetBlockSizeBytes(LZ4BlockSize blockSize)
+	{
+		return size_t(1) << (8 + 2 * static_cast<uint8_t>(blockSize));
+	}
+
+	//
+	// FRAMES
+	//
+
+	string CompressionUtils::CompressFrame(
+		string_view input,
+		unsigned int threadCount,
+		LZ4BlockSize blockSize)
+	{
+		size_t blockBytes = GetBlockSizeBytes(blockSize);
+		size_t blockCount = (input.size() + blockBytes - 1) / blockBytes;
+
+		//each block is compressed into its own slot, then stitched together in order
+		vector<string> blocks(blockCount);
+		RunParallel(blockCount, threadCount, [&](size_t index)
+			{
+				size_t offset = index * blockBytes;
+				size_t size = input.size() - offset < blockBytes ? input.size() - offset : blockBytes;
+
+				string& block = blocks[index];
+				block.resize(4 + CompressBound(size));
+
+				size_t compressedSize = CompressBlock(input.data() + offset, size, block.data() + 4, block.size() - 4);
+				if (compressedSize == 0
+					|| compressedSize >= size)
+				{
+					//incompressible data is stored as is
+					Write32(block.data(), static_cast<uint32_t>(size) | uncompressedBlockFlag);
+					memcpy(block.data() + 4, input.data() + offset, size);
+					block.resize(4 + size);
+				}
+				else
+				{
+					Write32(block.data(), static_cast<uint32_t>(compressedSize));
+					block.resize(4 + compressedSize);
+				}
+			});
+
+		size_t totalSize = 19 + 4 + 4;
+		for (const auto& block : blocks) totalSize += block.size();
+
+		string frame{};
+		frame.resize(totalSize);
+		size_t position = WriteFrameHeader(frame.data(), blockSize, true, input.size());
+
+		for (const auto& block : blocks)
+		{
+			memcpy(frame.data() + position, block.data(), block.size());
+			position += block.size();
+		}
+
+		Write32(frame.data() + position, 0);
+		position += 4;
+		Write32(frame.data() + position, XXH32(input.data(), input.size()));
+		position += 4;
+
+		frame.resize(position);
+		return frame;
+	}
+
+	bool CompressionUtils::DecompressFrame(
+		string_view frame,
+		string& output,
+		unsigned int threadCount,
+		size_t maxOutputSize)
+	{
+		struct BlockInfo
+		{
+			size_t offset;
+			size_t size;
+			bool isCompressed;
+		};
+
+		const char* data = frame.data();
+		size_t size = frame.size();
+		size_t position = 0;
+		vector<BlockInfo> blocks;
+
+		size_t outputStart = output.size();
+		size_t outputLimit = maxOutputSize == 0 ? SIZE_MAX - outputStart : maxOutputSize;
+
+		//sizes come from untrusted headers, a failed allocation is reported like corrupt data
+		auto resizeOutput = [&output](size_t newSize)
+			{
+				try
+				{
+					output.resize(newSize);
+					return true;
+				}
+				catch (const bad_alloc&)
+				{
+					LOG_ERROR("Failed to allocate " << newSize << " bytes for LZ4 frame output!");
+					return false;
+				}
+			};
+
+		while (position < size)
+		{
+			if (size - position < 4)
+			{
+				LOG_ERROR("Truncated LZ4 frame!");
+				return false;
+			}
+
+			uint32_t magic = Read32(data + position);
+			position += 4;
+
+			if ((magic & skippableMask) == skippableMagic)
+			{
+				if (size - position < 4) return false;
+				uint32_t skipSize = Read32(data + position);
+				position += 4;
+				if (size - position < skipSize) return false;
+				position += skipSize;
+				continue;
+			}
+			if (magic != frameMagic)
+			{
+				LOG_ERROR("Data is not an LZ4 frame!");
+				return false;
+			}
+
+			FrameDescriptor descriptor{};
+			if (!ParseFrameDescriptor(data + position, size - position, descriptor)) return false;
+			position += descriptor.headerSize;
+
+			//collect block locations first so independent blocks can be decoded in parallel
+			blocks.clear();
+			while (true)
+			{
+				if (size - position < 4) return false;
+				uint32_t header = Read32(data + position);
+				position += 4;
+				if (header == 0) break;
+
+				BlockInfo block{};
+				block.isCompressed = (header & uncompressedBlockFlag) == 0;
+				block.size = header & ~uncompressedBlockFlag;
+				block.offset = position;
+
+				size_t checksumSize = descriptor.hasBlockChecksum ? 4 : 0;
+				if (block.size > descriptor.blockMaxSize
+					|| size - position < block.size + checksumSize)
+				{
+					LOG_ERROR("Corrupt LZ4 block header!");
+					return false;
+				}
+
+				if (descriptor.hasBlockChecksum
+					&& XXH32(data + position, block.size) != Read32(data + position + block.size))
+				{
+					LOG_ERROR("LZ4 block checksum mismatch!");
+					return false;
+				}
+
+				position += block.size + checksumSize;
+				blocks.push_back(block);
+			}
+
+			size_t frameStart = output.size();
+			size_t remaining = outputLimit - (frameStart - outputStart);
+			size_t blockMax = descriptor.blockMaxSize;
+			bool isDecoded = false;
+
+			if (descriptor.hasContentSize
+				&& descriptor.contentSize > remaining)
+			{
+				LOG_ERROR("LZ4 frame content size exceeds the output limit!");
+				return false;
+			}
+
+			//parallel path assumes every block but the last is full, as all known encoders write them,
+			//its output is sized up front so it only runs when the content size or caller limit bounds it
+			size_t parallelSize = 0;
+			if (descriptor.hasContentSize)
+			{
+				if (descriptor.contentSize > (blocks.size() - 1) * blockMax
+					&& descriptor.contentSize <= blocks.size() * blockMax)
+				{
+					parallelSize = static_cast<size_t>(descriptor.contentSize);
+				}
+			}
+			else if (maxOutputSize != 0
+				&& blocks.size() <= remaining / blockMax)
+			{
+				parallelSize = blocks.size() * blockMax;
+			}
+
+			if (descriptor.isIndependent
+				&& blocks.size() > 1
+				&& parallelSize != 0
+				&& ResolveThreadCount(threadCount, blocks.size()) > 1)
+			{
+				if (!resizeOutput(frameStart + parallelSize)) return false;
+				vector<size_t> sizes(blocks.size(), 0);
+				atomic<bool> isValid{ true };
+
+				RunParallel(blocks.size(), threadCount, [&](size_t index)
+					{
+						const BlockInfo& block = blocks[index];
+						size_t capacity = min(blockMax, parallelSize - index * blockMax);
+						char* dst = output.data() + frameStart + index * blockMax;
+						if (!block.isCompressed)
+						{
+							if (block.size > capacity)
+							{
+								isValid = false;
+								return;
+							}
+							memcpy(dst, data + block.offset, block.size);
+							sizes[index] = block.size;
+						}
+						else if (!DecompressBlockImpl(data + block.offset, block.size, dst, capacity, dst, sizes[index]))
+						{
+							isValid = false;
+						}
+					});
+
+				if (!isValid)
+				{
+					LOG_ERROR("Corrupt LZ4 block data!");
+					return false;
+				}
+
+				isDecoded = true;
+				for (size_t i = 0; i + 1 < sizes.size(); i++)
+				{
+					if (sizes[i] != blockMax) isDecoded = false;
+				}
+
+				if (isDecoded) output.resize(frameStart + (blocks.size() - 1) * blockMax + sizes.back());
+				else output.resize(frameStart);
+			}
+
+			if (!isDecoded)
+			{
+				for (const auto& block : blocks)
+				{
+					size_t blockStart = output.size();
+					size_t capacity = min(blockMax, outputLimit - (blockStart - outputStart));
+					if (!resizeOutput(blockStart + capacity)) return false;
+					char* dst = output.data() + blockStart;
+
+					size_t written = 0;
+					if (!block.isCompressed)
+					{
+						if (block.size > capacity)
+						{
+							LOG_ERROR("LZ4 frame output exceeds the output limit!");
+							return false;
+						}
+						memcpy(dst, data + block.offset, block.size);
+						written = block.size;
+					}
+					else
+					{
+						//linked blocks may reference up to 64KB of earlier output in this frame
+						const char* history = descriptor.isIndependent
+							? dst
+							: output.data() + (blockStart - frameStart > historySize
+								? blockStart - historySize
+								: frameStart);
+
+						if (!DecompressBlockImpl(data + block.offset, block.size, dst, capacity, history, written))
+						{
+							LOG_ERROR("Corrupt LZ4 block data or output limit exceeded!");
+							return false;
+						}
+					}
+					output.resize(blockStart + written);
+				}
+			}
+
+			size_t frameSize = output.size() - frameStart;
+			if (descriptor.hasContentSize
+				&& descriptor.contentSize != frameSize)
+			{
+				LOG_ERROR("LZ4 frame content size mismatch!");
+				return false;
+			}
+
+			if (descriptor.hasContentChecksum)
+			{
+				if (size - position < 4) return false;
+				if (XXH32(output.data() + frameStart, frameSize) != Read32(data + position))
+				{
+					LOG_ERROR("LZ4 frame content checksum mismatch!");
+					return false;
+				}
+				position += 4;
+			}
+		}
+
+		return true;
+	}
+
+	//
+	// STREAMING WRITER
+	//
+
+	LZ4FrameWriter::LZ4FrameWriter(ostream& newOutput, LZ4BlockSize blockSize)
+		: output(newOutput),
+		blockBytes(CompressionUtils::GetBlockSizeBytes(blockSize))
+	{
+		block.reserve(blockBytes);
+		compressed.resize(4 + CompressionUtils::CompressBound(blockBytes));
+		contentHash.Reset(0);
+
+		char header[19]{};
+		size_t headerSize = WriteFrameHeader(header, blockSize, false, 0);
+		output.write(header, static_cast<std::streamsize>(headerSize));
+	}
+
+	LZ4FrameWriter::~LZ4FrameWriter()
+	{
+		if (!isFinished) Finish();
+	}
+
+	bool LZ4FrameWriter::Write(const void* data, size_t size)
+	{
+		if (isFinished) return false;
+
+		const char* input = static_cast<const char*>(data);
+		contentHash.Update(input, size);
+
+		while (size > 0)
+		{
+			size_t space = blockBytes - block.size();
+			size_t count = size < space ? size : space;
+			block.insert(block.end(), input, input + count);
+			input += count;
+			size -= count;
+
+			if (block.size() == blockBytes
+				&& !FlushBlock())
+			{
+				return false;
+			}
+		}
+
+		return static_cast<bool>(output);
+	}
+
+	bool LZ4FrameWriter::FlushBlock()
+	{
+		if (block.empty()) return true;
+
+		size_t compressedSize = CompressionUtils::CompressBlock(
+			block.data(),
+			block.size(),
+			compressed.data() + 4,
+			compressed.size() - 4);
+
+		if (compressedSize == 0
+			|| compressedSize >= block.size())
+		{
+			char header[4]{};
+			Write32(header, static_cast<uint32_t>(block.size()) | uncompressedBlockFlag);
+			output.write(header, 4);
+			output.write(block.data(), static_cast<std::streamsize>(block.size()));
+		}
+		else
+		{
+			Write32(compressed.data(), static_cast<uint32_t>(compressedSize));
+			output.write(compressed.data(), static_cast<std::streamsize>(4 + compressedSize));
+		}
+
+		block.clear();
+		return static_cast<bool>(output);
+	}
+
+	bool LZ4FrameWriter::Finish()
+	{
+		if (isFinished) return static_cast<bool>(output);
+		isFinished = true;
+
+		if (!FlushBlock()) return false;
+
+		char footer[8]{};
+		Write32(footer, 0);
+		Write32(footer + 4, contentHash.Digest());
+		output.write(footer, 8);
+		output.flush();
+
+		return static_cast<bool>(output);
+	}
+
+	//
+	// STREAMING READER
+	//
+
+	LZ4FrameReader::LZ4FrameReader(istream& newInput)
+		: input(newInput)
+	{
+	}
+
+	size_t LZ4FrameReader::Read(void* buffer, size_t capacity)
+	{
+		char* out = static_cast<char*>(buffer);
+		size_t filled = 0;
+
+		while (filled < capacity)
+		{
+			if (windowStart < windowEnd)
+			{
+				size_t count = windowEnd - windowStart;
+				if (count > capacity - filled) count = capacity - filled;
+				memcpy(out + filled, window.data() + windowStart, count);
+				windowStart += count;
+				filled += count;
+				continue;
+			}
+
+			if (isFinished || hasError) break;
+
+			bool isOk = isInFrame ? ReadNextBlock() : ReadFrameHeader();
+			if (!isOk) hasError = true;
+		}
+
+		return filled;
+	}
+
+	bool LZ4FrameReader::ReadFrameHeader()
+	{
+		char magicBytes[4]{};
+		input.read(magicBytes, 4);
+		if (input.gcount() == 0)
+		{
+			//clean end of stream between frames
+			isFinished = true;
+			return true;
+		}
+		if (input.gcount() != 4) return false;
+
+		uint32_t magic = Read32(magicBytes);
+		if ((magic & skippableMask) == skippableMagic)
+		{
+			char sizeBytes[4]{};
+			if (!input.read(sizeBytes, 4)) return false;
+			input.ignore(Read32(sizeBytes));
+			return static_cast<bool>(input);
+		}
+		if (magic != frameMagic)
+		{
+			LOG_ERROR("Data is not an LZ4 frame!");
+			return false;
+		}
+
+		//descriptor is atmost flags, block descriptor, content size, dictionary id and checksum
+		char descriptorBytes[15]{};
+		if (!input.read(descriptorBytes, 2)) return false;
+		size_t descriptorSize = 3
+			+ ((descriptorBytes[0] & 0x08) ? 8 : 0)
+			+ ((descriptorBytes[0] & 0x01) ? 4 : 0);
+		if (!input.read(descriptorBytes + 2, static_cast<std::streamsize>(descriptorSize - 2))) return false;
+
+		FrameDescriptor descriptor{};
+		if (!ParseFrameDescriptor(descriptorBytes, descriptorSize, descriptor)) return false;
+
+		blockMaxSize = descriptor.blockMaxSize;
+		isIndependent = descriptor.isIndependent;
+		hasBlockChecksum = descriptor.hasBlockChecksum;
+		hasContentChecksum = descriptor.hasContentChecksum;
+		contentHash.Reset(0);
+
+		if (window.size() < historySize + blockMaxSize) window.resize(historySize + blockMaxSize);
+		windowStart = 0;
+		windowEnd = 0;
+
+		isInFrame = true;
+		return true;
+	}
+
+	bool LZ4FrameReader::ReadNextBlock()
+	{
+		char headerBytes[4]{};
+		if (!input.read(headerBytes, 4)) return false;
+		uint32_t header = Read32(headerBytes);
+
+		if (header == 0)
+		{
+			if (hasContentChecksum)
+			{
+				char checksumBytes[4]{};
+				if (!input.read(checksumBytes, 4)) return false;
+				if (Read32(checksumBytes) != contentHash.Digest())
+				{
+					LOG_ERROR("LZ4 frame content checksum mismatch!");
+					return false;
+				}
+			}
+			isInFrame = false;
+			return true;
+		}
+
+		bool isCompressed = (header & uncompressedBlockFlag) == 0;
+		size_t blockSize = header & ~uncompressedBlockFlag;
+		if (blockSize > blockMaxSize) return false;
+
+		compressed.resize(blockSize);
+		if (!input.read(compressed.data(), static_cast<std::streamsize>(blockSize))) return false;
+
+		if (hasBlockChecksum)
+		{
+			char checksumBytes[4]{};
+			if (!input.read(checksumBytes, 4)) return false;
+			if (Read32(checksumBytes) != XXH32(compressed.data(), blockSize))
+			{
+				LOG_ERROR("LZ4 block checksum mismatch!");
+				return false;
+			}
+		}
+
+		//keep the last 64KB of output in front of the new block for linked blocks
+		if (isIndependent) windowEnd = 0;
+		else if (windowEnd + blockMaxSize > window.size())
+		{
+			memmove(window.data(), window.data() + windowEnd - historySize, historySize);
+			windowEnd = historySize;
+		}
+
+		char* dst = window.data() + windowEnd;
+		size_t written = 0;
+		if (!isCompressed)
+		{
+			memcpy(dst, compressed.data(), blockSize);
+			written = blockSize;
+		}
+		else
+		{
+			const char* history = isIndependent ? dst : window.data();
+			if (!DecompressBlockImpl(compressed.data(), blockSize, dst, blockMaxSize, history, written))
+			{
+				LOG_ERROR("Corrupt LZ4 block data!");
+				return false;
+			}
+		}
+
+		contentHash.Update(dst, written);
+		windowStart = windowEnd;
+		windowEnd += written;
+		return true;
+	}
+}
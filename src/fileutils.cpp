@@ -4,31 +4,34 @@
 //Read LICENSE.md for more information.
 
 //main log macro
-#define WRITE_LOG(type, msg) std::cout << "[KALAKIT_FILEUTILS | " << type << "] " << msg << "\n"
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_FILEUTILS", level, msg)
 
-//log types
-#if KALAUTILS_DEBUG
-	#define LOG_DEBUG(msg) WRITE_LOG("DEBUG", msg)
-#else
-	#define LOG_DEBUG(msg)
-#endif
-#define LOG_SUCCESS(msg) WRITE_LOG("SUCCESS", msg)
-#define LOG_ERROR(msg) WRITE_LOG("ERROR", msg)
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <vector>
 #ifdef _WIN32
 #include <Windows.h>
 #endif
 
 #include "fileutils.hpp"
+#include "packfile.hpp"
+#include "logger.hpp"
 
 using std::to_string;
 using std::runtime_error;
 using std::wstring;
 using std::exception;
+using std::vector;
+using std::sort;
 using std::filesystem::exists;
 using std::filesystem::directory_iterator;
+using std::filesystem::recursive_directory_iterator;
 using std::filesystem::copy_options;
 using std::ifstream;
 
@@ -413,6 +416,46 @@ namespace KalaKit
 
         return newFilePath;
     }
+
+    bool FileUtils::PackDirectory(const string& folderPath, const string& packPath)
+    {
+        if (!is_directory(path(folderPath)))
+        {
+            LOG_ERROR("Cannot pack '" + path(folderPath).string() + "' because it is not a folder!");
+            return false;
+        }
+
+        vector<PackSource> sources;
+        try
+        {
+            for (const auto& entry : recursive_directory_iterator(folderPath))
+            {
+                if (!entry.is_regular_file()) continue;
+
+                PackSource source{};
+                source.entryPath = entry.path().lexically_relative(folderPath).generic_string();
+                source.filePath = entry.path().string();
+                sources.push_back(source);
+            }
+        }
+        catch (const exception& e)
+        {
+            LOG_ERROR("FileUtils::PackDirectory: " + string(e.what()) + ".");
+            return false;
+        }
+
+        //stable entry order keeps packs reproducible across runs
+        sort(sources.begin(), sources.end(), [](const PackSource& a, const PackSource& b)
+            {
+                return a.entryPath < b.entryPath;
+            });
+
+        if (!PackFile::Write(packPath, sources)) return false;
+
+        LOG_DEBUG("Packed " + to_string(sources.size()) + " files from '" + path(folderPath).string() + "' to '" + path(packPath).string() + "'.");
+        return true;
+    }
+
     string FileUtils::GetValueBetweenParentheses(const string& input)
     {
         size_t start = input.find('(');
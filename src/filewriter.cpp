@@ -0,0 +1,519 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+//main log macro
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_FILEWRITER", level, msg)
+
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
+
+#include <filesystem>
+#include <algorithm>
+#include <new>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
+
+#include "filewriter.hpp"
+#include "logger.hpp"
+
+using std::min;
+using std::sort;
+using std::unique;
+using std::align_val_t;
+using std::filesystem::path;
+
+namespace KalaKit
+{
+	namespace
+	{
+		//direct IO needs the buffer address, file offset and write size aligned to this
+		constexpr size_t directAlignment = 4096;
+
+		string GetParentFolder(const string& filePath)
+		{
+			string parent = path(filePath).parent_path().string();
+			return parent.empty() ? "." : parent;
+		}
+
+		//makes the renames inside the folder durable
+		bool SyncFolder(const string& folderPath)
+		{
+#ifdef _WIN32
+			//renames are made durable by MOVEFILE_WRITE_THROUGH
+			return true;
+#else
+			int folder = open(folderPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			if (folder == -1)
+			{
+				LOG_ERROR("Failed to open folder '" << folderPath << "' for syncing!");
+				return false;
+			}
+
+			bool success = fsync(folder) == 0;
+			close(folder);
+
+			if (!success)
+			{
+				LOG_ERROR("Failed to sync folder '" << folderPath << "'!");
+			}
+			return success;
+#endif
+		}
+	}
+
+	FileWriter::~FileWriter()
+	{
+		if (!IsOpen()) return;
+
+		if (options.isAtomic) Abort();
+		else Commit(false);
+	}
+
+	bool FileWriter::Open(const string& filePath, const FileWriterOptions& newOptions)
+	{
+		if (IsOpen()) Abort();
+
+		options = newOptions;
+		targetPath = filePath;
+		tempPath = options.isAtomic ? filePath + ".tmp" : filePath;
+
+		bufferCapacity = options.bufferSize < directAlignment ? directAlignment : options.bufferSize;
+		bufferCapacity = (bufferCapacity + directAlignment - 1) / directAlignment * directAlignment;
+		buffer = static_cast<char*>(::operator new(bufferCapacity, align_val_t(directAlignment)));
+		bufferSize = 0;
+		fileOffset = 0;
+		isDirect = false;
+
+#ifdef _WIN32
+		DWORD flags = FILE_ATTRIBUTE_NORMAL;
+		if (options.useDirectIO) flags |= FILE_FLAG_NO_BUFFERING;
+
+		HANDLE file = CreateFileA(
+			tempPath.c_str(),
+			GENERIC_WRITE,
+			0,
+			nullptr,
+			CREATE_ALWAYS,
+			flags,
+			nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			LOG_ERROR("Failed to create file '" << tempPath << "'!");
+			Release();
+			return false;
+		}
+		handle = file;
+		isDirect = options.useDirectIO;
+
+		if (options.preallocateSize > 0)
+		{
+			FILE_ALLOCATION_INFO info{};
+			info.AllocationSize.QuadPart = static_cast<LONGLONG>(options.preallocateSize);
+			if (!SetFileInformationByHandle(handle, FileAllocationInfo, &info, sizeof(info)))
+			{
+				LOG_DEBUG("Failed to preallocate '" << tempPath << "', continuing without it.");
+			}
+		}
+#else
+		int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+
+#ifdef O_DIRECT
+		if (options.useDirectIO)
+		{
+			fd = open(tempPath.c_str(), flags | O_DIRECT, 0644);
+			isDirect = fd != -1;
+			if (!isDirect)
+			{
+				LOG_DEBUG("Direct IO is not supported for '" << tempPath << "', using buffered writes.");
+			}
+		}
+#endif
+		if (fd == -1) fd = open(tempPath.c_str(), flags, 0644);
+		if (fd == -1)
+		{
+			LOG_ERROR("Failed to create file '" << tempPath << "'!");
+			Release();
+			return false;
+		}
+
+#ifdef __linux__
+		//reserve the blocks without changing the file size, so no truncate is needed afterwards
+		if (options.preallocateSize > 0
+			&& fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(options.preallocateSize)) != 0)
+		{
+			LOG_DEBUG("Failed to preallocate '" << tempPath << "', continuing without it.");
+		}
+#endif
+#endif
+
+		return true;
+	}
+
+	bool FileWriter::Write(const void* data, size_t size)
+	{
+		if (!IsOpen()) return false;
+
+		const char* bytes = static_cast<const char*>(data);
+
+		if (size <= bufferCapacity - bufferSize)
+		{
+			memcpy(buffer + bufferSize, bytes, size);
+			bufferSize += size;
+			return true;
+		}
+
+		//large payloads skip the copy and go out together with the buffered bytes,
+		//direct IO cannot do this since the payload is not aligned
+		if (!isDirect
+			&& size >= bufferCapacity)
+		{
+			bool success = WriteToFile(buffer, bufferSize, bytes, size);
+			bufferSize = 0;
+			return success;
+		}
+
+		while (size > 0)
+		{
+			size_t chunk = min(size, bufferCapacity - bufferSize);
+			memcpy(buffer + bufferSize, bytes, chunk);
+			bufferSize += chunk;
+			bytes += chunk;
+			size -= chunk;
+
+			if (bufferSize == bufferCapacity
+				&& !Flush())
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool FileWriter::Flush()
+	{
+		if (!IsOpen()) return false;
+
+		size_t flushSize = isDirect
+			? bufferSize - bufferSize % directAlignment
+			: bufferSize;
+		if (flushSize == 0) return true;
+
+		bool success = WriteToFile(buffer, flushSize, nullptr, 0);
+
+		memmove(buffer, buffer + flushSize, bufferSize - flushSize);
+		bufferSize -= flushSize;
+
+		return success;
+	}
+
+	bool FileWriter::Commit(bool sync)
+	{
+		if (!IsOpen()) return false;
+
+		if (!FinishWrites()
+			|| (sync && !SyncData())
+			|| !CloseFile())
+		{
+			Discard();
+			return false;
+		}
+
+		bool success = Publish();
+		if (success && sync) success = SyncFolder(GetParentFolder(targetPath));
+
+		Release();
+		return success;
+	}
+
+	void FileWriter::Abort()
+	{
+		if (!IsOpen()) return;
+
+		Discard();
+	}
+
+	bool FileWriter::CommitAll(const vector<FileWriter*>& writers, bool sync)
+	{
+		bool success = true;
+		vector<FileWriter*> pending{};
+
+		for (FileWriter* writer : writers)
+		{
+			if (writer == nullptr
+				|| !writer->IsOpen())
+			{
+				success = false;
+				continue;
+			}
+
+			if (!writer->FinishWrites())
+			{
+				writer->Discard();
+				success = false;
+				continue;
+			}
+
+			pending.push_back(writer);
+		}
+
+		if (sync)
+		{
+#ifdef __linux__
+			//start writeback of every file before waiting on any of them,
+			//so the device sees one large batch instead of one file at a time
+			for (FileWriter* writer : pending)
+			{
+				sync_file_range(writer->fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+			}
+#endif
+			for (FileWriter*& writer : pending)
+			{
+				if (!writer->SyncData())
+				{
+					writer->Discard();
+					writer = nullptr;
+					success = false;
+				}
+			}
+		}
+
+		vector<string> folders{};
+		for (FileWriter* writer : pending)
+		{
+			if (writer == nullptr) continue;
+
+			if (!writer->CloseFile())
+			{
+				writer->Discard();
+				success = false;
+				continue;
+			}
+
+			if (writer->Publish()) folders.push_back(GetParentFolder(writer->targetPath));
+			else success = false;
+
+			writer->Release();
+		}
+
+		if (sync)
+		{
+			sort(folders.begin(), folders.end());
+			folders.erase(unique(folders.begin(), folders.end()), folders.end());
+
+			for (const auto& folder : folders)
+			{
+				if (!SyncFolder(folder)) success = false;
+			}
+		}
+
+		return success;
+	}
+
+	bool FileWriter::IsOpen() const
+	{
+#ifdef _WIN32
+		return handle != nullptr;
+#else
+		return fd != -1;
+#endif
+	}
+
+	bool FileWriter::WriteToFile(
+		const char* first,
+		size_t firstSize,
+		const char* second,
+		size_t secondSize)
+	{
+#ifdef _WIN32
+		const char* parts[2] = { first, second };
+		size_t sizes[2] = { firstSize, secondSize };
+
+		for (int i = 0; i < 2; i++)
+		{
+			const char* data = parts[i];
+			size_t remaining = sizes[i];
+			while (remaining > 0)
+			{
+				DWORD chunk = static_cast<DWORD>(min(remaining, static_cast<size_t>(1) << 30));
+				DWORD written = 0;
+				if (!WriteFile(handle, data, chunk, &written, nullptr))
+				{
+					LOG_ERROR("Failed to write to '" << tempPath << "'!");
+					return false;
+				}
+				data += written;
+				remaining -= written;
+				fileOffset += written;
+			}
+		}
+		return true;
+#else
+		iovec vectors[2]{};
+		int count = 0;
+		if (firstSize > 0) vectors[count++] = { const_cast<char*>(first), firstSize };
+		if (secondSize > 0) vectors[count++] = { const_cast<char*>(second), secondSize };
+
+		iovec* current = vectors;
+		while (count > 0)
+		{
+			ssize_t written = writev(fd, current, count);
+			if (written < 0)
+			{
+				if (errno == EINTR) continue;
+
+				LOG_ERROR("Failed to write to '" << tempPath << "'! Error: " << strerror(errno));
+				return false;
+			}
+			fileOffset += static_cast<uint64_t>(written);
+
+			//drop whatever was fully written and retry the rest
+			size_t remaining = static_cast<size_t>(written);
+			while (count > 0
+				&& remaining >= current->iov_len)
+			{
+				remaining -= current->iov_len;
+				current++;
+				count--;
+			}
+			if (count > 0)
+			{
+				current->iov_base = static_cast<char*>(current->iov_base) + remaining;
+				current->iov_len -= remaining;
+			}
+		}
+		return true;
+#endif
+	}
+
+	bool FileWriter::FinishWrites()
+	{
+		//the unaligned tail cannot be written with direct IO
+		if (isDirect)
+		{
+			if (!Flush()) return false;
+
+#ifdef _WIN32
+			CloseHandle(handle);
+			handle = CreateFileA(
+				tempPath.c_str(),
+				GENERIC_WRITE,
+				0,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL,
+				nullptr);
+			if (handle == INVALID_HANDLE_VALUE)
+			{
+				handle = nullptr;
+				LOG_ERROR("Failed to reopen '" << tempPath << "' for buffered writes!");
+				return false;
+			}
+
+			LARGE_INTEGER offset{};
+			offset.QuadPart = static_cast<LONGLONG>(fileOffset);
+			SetFilePointerEx(handle, offset, nullptr, FILE_BEGIN);
+#elif defined(O_DIRECT)
+			int flags = fcntl(fd, F_GETFL);
+			if (flags == -1
+				|| fcntl(fd, F_SETFL, flags & ~O_DIRECT) == -1)
+			{
+				LOG_ERROR("Failed to disable direct IO for '" << tempPath << "'!");
+				return false;
+			}
+#endif
+			isDirect = false;
+		}
+
+		return Flush();
+	}
+
+	bool FileWriter::SyncData()
+	{
+#ifdef _WIN32
+		bool success = FlushFileBuffers(handle);
+#elif defined(__linux__)
+		bool success = fdatasync(fd) == 0;
+#else
+		bool success = fsync(fd) == 0;
+#endif
+		if (!success)
+		{
+			LOG_ERROR("Failed to sync '" << tempPath << "' to disk!");
+		}
+		return success;
+	}
+
+	bool FileWriter::CloseFile()
+	{
+#ifdef _WIN32
+		if (handle == nullptr) return true;
+		bool success = CloseHandle(handle);
+		handle = nullptr;
+#else
+		if (fd == -1) return true;
+		bool success = close(fd) == 0;
+		fd = -1;
+#endif
+		if (!success)
+		{
+			LOG_ERROR("Failed to close '" << tempPath << "'!");
+		}
+		return success;
+	}
+
+	bool FileWriter::Publish()
+	{
+		if (tempPath == targetPath) return true;
+
+#ifdef _WIN32
+		bool success = MoveFileExA(
+			tempPath.c_str(),
+			targetPath.c_str(),
+			MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+		bool success = rename(tempPath.c_str(), targetPath.c_str()) == 0;
+#endif
+		if (!success)
+		{
+			LOG_ERROR("Failed to move '" << tempPath << "' to '" << targetPath << "'!");
+			std::remove(tempPath.c_str());
+		}
+		return success;
+	}
+
+	void FileWriter::Discard()
+	{
+		CloseFile();
+		if (tempPath != targetPath) std::remove(tempPath.c_str());
+
+		Release();
+	}
+
+	void FileWriter::Release()
+	{
+		CloseFile();
+
+		if (buffer != nullptr)
+		{
+			::operator delete(buffer, align_val_t(directAlignment));
+			buffer = nullptr;
+		}
+		bufferCapacity = 0;
+		bufferSize = 0;
+		fileOffset = 0;
+		isDirect = false;
+	}
+}
@@ -0,0 +1,204 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+//main log macro
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_FRAMETIMER", level, msg)
+
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
+
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+#include "frametimer.hpp"
+#include "logger.hpp"
+
+using std::chrono::steady_clock;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using std::this_thread::sleep_for;
+using std::this_thread::yield;
+using std::sort;
+using std::min;
+using std::max;
+using std::sqrt;
+
+namespace KalaKit
+{
+	uint64_t FrameTimer::Now()
+	{
+		return static_cast<uint64_t>(duration_cast<nanoseconds>(
+			steady_clock::now().time_since_epoch()).count());
+	}
+
+	void FrameTimer::SetTargetRate(double framesPerSecond)
+	{
+		if (framesPerSecond < 0.0)
+		{
+			LOG_ERROR("Target frame rate " << framesPerSecond << " cannot be negative!");
+			return;
+		}
+
+		targetPeriod = framesPerSecond == 0.0
+			? 0
+			: static_cast<uint64_t>(1e9 / framesPerSecond);
+		nextDeadline = 0;
+	}
+	double FrameTimer::GetTargetRate() const
+	{
+		return targetPeriod == 0 ? 0.0 : 1e9 / static_cast<double>(targetPeriod);
+	}
+
+	void FrameTimer::SetFixedTimestep(double seconds)
+	{
+		if (seconds <= 0.0)
+		{
+			LOG_ERROR("Fixed timestep " << seconds << " must be above 0!");
+			return;
+		}
+
+		fixedStep = static_cast<uint64_t>(seconds * 1e9);
+		if (fixedStep == 0) fixedStep = 1;
+		accumulator = 0;
+	}
+
+	double FrameTimer::BeginFrame()
+	{
+		if (targetPeriod != 0 && nextDeadline != 0)
+		{
+			WaitUntil(nextDeadline);
+		}
+
+		uint64_t now = Now();
+
+		if (targetPeriod != 0)
+		{
+			if (nextDeadline != 0)
+			{
+				pacingErrors[pacedCount % historySize] = now - nextDeadline;
+				pacedCount++;
+			}
+
+			//schedule from the previous deadline so errors do not add up,
+			//unless the frame ran so long that the schedule cannot be kept
+			nextDeadline = (nextDeadline == 0 || now - nextDeadline > targetPeriod)
+				? now + targetPeriod
+				: nextDeadline + targetPeriod;
+		}
+
+		frameTime = lastFrameStart == 0 ? 0 : now - lastFrameStart;
+		lastFrameStart = now;
+
+		if (frameTime != 0)
+		{
+			frameTimes[frameCount % historySize] = frameTime;
+			frameCount++;
+		}
+
+		accumulator = min(accumulator + frameTime, fixedStep * maxFixedSteps);
+
+		return GetDeltaTime();
+	}
+
+	void FrameTimer::WaitUntil(uint64_t deadline)
+	{
+		uint64_t now = Now();
+		if (now >= deadline) return;
+
+		//sleep through most of the wait, the OS may wake us late
+		if (deadline - now > sleepMargin)
+		{
+			uint64_t requested = deadline - now - sleepMargin;
+			sleep_for(nanoseconds(requested));
+
+			uint64_t slept = Now() - now;
+			uint64_t overshoot = slept > requested ? slept - requested : 0;
+
+			//grow the margin right away, shrink it slowly back to the spin threshold
+			if (overshoot + spinThreshold > sleepMargin) sleepMargin = overshoot + spinThreshold;
+			else sleepMargin -= (sleepMargin - spinThreshold) / 16;
+		}
+
+		//spin the rest for sub-microsecond accuracy
+		while (Now() < deadline)
+		{
+			yield();
+		}
+	}
+
+	bool FrameTimer::ConsumeFixedStep()
+	{
+		if (accumulator < fixedStep) return false;
+
+		accumulator -= fixedStep;
+		return true;
+	}
+	double FrameTimer::GetFixedAlpha() const
+	{
+		return static_cast<double>(accumulator) / static_cast<double>(fixedStep);
+	}
+
+	FrameStats FrameTimer::GetStats() const
+	{
+		FrameStats stats{};
+
+		size_t count = min(static_cast<size_t>(frameCount), historySize);
+		if (count == 0) return stats;
+
+		uint64_t sorted[historySize]{};
+		double sum = 0.0;
+		for (size_t i = 0; i < count; i++)
+		{
+			sorted[i] = frameTimes[i];
+			sum += static_cast<double>(frameTimes[i]);
+		}
+		sort(sorted, sorted + count);
+
+		double mean = sum / static_cast<double>(count);
+		double variance = 0.0;
+		for (size_t i = 0; i < count; i++)
+		{
+			double difference = static_cast<double>(sorted[i]) - mean;
+			variance += difference * difference;
+		}
+		variance /= static_cast<double>(count);
+
+		stats.sampleCount = count;
+		stats.mean = static_cast<uint64_t>(mean);
+		stats.p99 = sorted[min(count - 1, (count * 99) / 100)];
+		stats.min = sorted[0];
+		stats.max = sorted[count - 1];
+		stats.jitter = static_cast<uint64_t>(sqrt(variance));
+
+		size_t pacedSamples = min(pacedCount, historySize);
+		if (pacedSamples != 0)
+		{
+			uint64_t errorSum = 0;
+			for (size_t i = 0; i < pacedSamples; i++)
+			{
+				errorSum += pacingErrors[i];
+				stats.pacingErrorMax = max(stats.pacingErrorMax, pacingErrors[i]);
+			}
+			stats.pacingErrorMean = errorSum / pacedSamples;
+		}
+
+		return stats;
+	}
+
+	void FrameTimer::Reset()
+	{
+		accumulator = 0;
+		lastFrameStart = 0;
+		nextDeadline = 0;
+		frameTime = 0;
+		frameCount = 0;
+		pacedCount = 0;
+		sleepMargin = spinThreshold;
+	}
+}
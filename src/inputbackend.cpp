@@ -0,0 +1,341 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+//main log macro
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_INPUTBACKEND", level, msg)
+
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/input.h>
+#include <cerrno>
+#include <ctime>
+#endif
+
+#include "inputbackend.hpp"
+#include "windowutils.hpp"
+#include "logger.hpp"
+
+namespace KalaKit
+{
+	//
+	// WIN32
+	//
+
+#ifdef _WIN32
+	void Win32InputBackend::SetCursorVisible(bool isVisible)
+	{
+		if (isVisible) while (ShowCursor(TRUE) < 0); //increment until visible
+		else while (ShowCursor(FALSE) >= 0);         //decrement until hidden
+	}
+
+	void Win32InputBackend::SetCursorLocked(bool isLocked)
+	{
+		if (!isLocked)
+		{
+			ClipCursor(nullptr);
+			return;
+		}
+
+		CenterCursor();
+
+		//clip the cursor to the window to prevent it from leaving
+		HWND window = WindowUtils::GetNativeWindow();
+		RECT rect{};
+		GetClientRect(window, &rect);
+		ClientToScreen(window, (POS*)&rect.left);
+		ClientToScreen(window, (POS*)&rect.right);
+		ClipCursor(&rect);
+	}
+
+	void Win32InputBackend::CenterCursor()
+	{
+		HWND window = WindowUtils::GetNativeWindow();
+		RECT rect{};
+		GetClientRect(window, &rect);
+
+		POS center{};
+		center.x = (rect.right - rect.left) / 2;
+		center.y = (rect.bottom - rect.top) / 2;
+
+		ClientToScreen(window, &center);
+		SetCursorPos(center.x, center.y);
+	}
+#endif
+
+	//
+	// SYNTHETIC
+	//
+
+	void SyntheticInputBackend::InjectKey(Key key, bool isDown, uint64_t timestamp)
+	{
+		InputEvent event{};
+		event.timestamp = timestamp;
+		event.type = isDown ? InputEventType::KEY_PRESSED : InputEventType::KEY_RELEASED;
+		event.key = key;
+		pendingEvents.push_back(event);
+	}
+	void SyntheticInputBackend::InjectMouseMove(POS delta, uint64_t timestamp)
+	{
+		pendingEvents.push_back({ timestamp, InputEventType::MOUSE_MOVE, Key{}, delta.x, delta.y });
+	}
+	void SyntheticInputBackend::InjectMousePosition(POS position, uint64_t timestamp)
+	{
+		pendingEvents.push_back({ timestamp, InputEventType::MOUSE_POSITION, Key{}, position.x, position.y });
+	}
+	void SyntheticInputBackend::InjectRawMouseMove(POS delta, uint64_t timestamp)
+	{
+		pendingEvents.push_back({ timestamp, InputEventType::RAW_MOUSE_MOVE, Key{}, delta.x, delta.y });
+	}
+	void SyntheticInputBackend::InjectMouseWheel(int delta, uint64_t timestamp)
+	{
+		pendingEvents.push_back({ timestamp, InputEventType::MOUSE_WHEEL, Key{}, delta, 0 });
+	}
+
+	void SyntheticInputBackend::PollEvents()
+	{
+		for (const auto& event : pendingEvents)
+		{
+			switch (event.type)
+			{
+			case InputEventType::KEY_PRESSED:
+			case InputEventType::KEY_RELEASED:
+				InputUtils::PushKeyEvent(event.key, event.type == InputEventType::KEY_PRESSED, event.timestamp);
+				break;
+			case InputEventType::MOUSE_MOVE:
+				InputUtils::PushMouseMoveEvent({ event.x, event.y }, event.timestamp);
+				break;
+			case InputEventType::MOUSE_POSITION:
+				InputUtils::PushMousePositionEvent({ event.x, event.y }, event.timestamp);
+				break;
+			case InputEventType::RAW_MOUSE_MOVE:
+				InputUtils::PushRawMouseMoveEvent({ event.x, event.y }, event.timestamp);
+				break;
+			case InputEventType::MOUSE_WHEEL:
+				InputUtils::PushMouseWheelEvent(event.x, event.timestamp);
+				break;
+			}
+		}
+		pendingEvents.clear();
+	}
+
+	//
+	// EVDEV
+	//
+
+#ifdef __linux__
+	namespace
+	{
+		struct EvdevKey
+		{
+			uint16_t code;
+			Key key;
+		};
+
+		const EvdevKey evdevKeys[] =
+		{
+			{ KEY_A, Key::A }, { KEY_B, Key::B }, { KEY_C, Key::C }, { KEY_D, Key::D },
+			{ KEY_E, Key::E }, { KEY_F, Key::F }, { KEY_G, Key::G }, { KEY_H, Key::H },
+			{ KEY_I, Key::I }, { KEY_J, Key::J }, { KEY_K, Key::K }, { KEY_L, Key::L },
+			{ KEY_M, Key::M }, { KEY_N, Key::N }, { KEY_O, Key::O }, { KEY_P, Key::P },
+			{ KEY_Q, Key::Q }, { KEY_R, Key::R }, { KEY_S, Key::S }, { KEY_T, Key::T },
+			{ KEY_U, Key::U }, { KEY_V, Key::V }, { KEY_W, Key::W }, { KEY_X, Key::X },
+			{ KEY_Y, Key::Y }, { KEY_Z, Key::Z },
+
+			{ KEY_0, Key::Num0 }, { KEY_1, Key::Num1 }, { KEY_2, Key::Num2 }, { KEY_3, Key::Num3 },
+			{ KEY_4, Key::Num4 }, { KEY_5, Key::Num5 }, { KEY_6, Key::Num6 }, { KEY_7, Key::Num7 },
+			{ KEY_8, Key::Num8 }, { KEY_9, Key::Num9 },
+
+			{ KEY_SEMICOLON, Key::Semicolon }, { KEY_EQUAL, Key::Equal }, { KEY_COMMA, Key::Comma },
+			{ KEY_MINUS, Key::Minus }, { KEY_DOT, Key::Period }, { KEY_SLASH, Key::Slash },
+			{ KEY_GRAVE, Key::Backtick }, { KEY_LEFTBRACE, Key::BracketLeft },
+			{ KEY_BACKSLASH, Key::Backslash }, { KEY_RIGHTBRACE, Key::BracketRight },
+			{ KEY_APOSTROPHE, Key::Apostrophe }, { KEY_102ND, Key::Oem102 },
+
+			{ KEY_KP0, Key::Numpad0 }, { KEY_KP1, Key::Numpad1 }, { KEY_KP2, Key::Numpad2 },
+			{ KEY_KP3, Key::Numpad3 }, { KEY_KP4, Key::Numpad4 }, { KEY_KP5, Key::Numpad5 },
+			{ KEY_KP6, Key::Numpad6 }, { KEY_KP7, Key::Numpad7 }, { KEY_KP8, Key::Numpad8 },
+			{ KEY_KP9, Key::Numpad9 }, { KEY_KPPLUS, Key::NumpadAdd },
+			{ KEY_KPMINUS, Key::NumpadSubtract }, { KEY_KPASTERISK, Key::NumpadMultiply },
+			{ KEY_KPSLASH, Key::NumpadDivide }, { KEY_KPDOT, Key::NumpadDecimal },
+			{ KEY_KPENTER, Key::Enter }, { KEY_NUMLOCK, Key::NumLock },
+
+			{ KEY_F1, Key::F1 }, { KEY_F2, Key::F2 }, { KEY_F3, Key::F3 }, { KEY_F4, Key::F4 },
+			{ KEY_F5, Key::F5 }, { KEY_F6, Key::F6 }, { KEY_F7, Key::F7 }, { KEY_F8, Key::F8 },
+			{ KEY_F9, Key::F9 }, { KEY_F10, Key::F10 }, { KEY_F11, Key::F11 }, { KEY_F12, Key::F12 },
+			{ KEY_F13, Key::F13 }, { KEY_F14, Key::F14 }, { KEY_F15, Key::F15 }, { KEY_F16, Key::F16 },
+			{ KEY_F17, Key::F17 }, { KEY_F18, Key::F18 }, { KEY_F19, Key::F19 }, { KEY_F20, Key::F20 },
+			{ KEY_F21, Key::F21 }, { KEY_F22, Key::F22 }, { KEY_F23, Key::F23 }, { KEY_F24, Key::F24 },
+
+			{ KEY_ESC, Key::Escape }, { KEY_ENTER, Key::Enter }, { KEY_TAB, Key::Tab },
+			{ KEY_BACKSPACE, Key::Backspace }, { KEY_INSERT, Key::Insert }, { KEY_DELETE, Key::Delete },
+			{ KEY_HOME, Key::Home }, { KEY_END, Key::End }, { KEY_PAGEUP, Key::PageUp },
+			{ KEY_PAGEDOWN, Key::PageDown },
+
+			{ KEY_LEFTSHIFT, Key::LeftShift }, { KEY_RIGHTSHIFT, Key::RightShift },
+			{ KEY_LEFTCTRL, Key::LeftControl }, { KEY_RIGHTCTRL, Key::RightControl },
+			{ KEY_LEFTALT, Key::LeftAlt }, { KEY_RIGHTALT, Key::RightAlt },
+			{ KEY_CAPSLOCK, Key::CapsLock },
+
+			{ KEY_SYSRQ, Key::PrintScreen }, { KEY_SCROLLLOCK, Key::ScrollLock },
+			{ KEY_PAUSE, Key::Pause }, { KEY_COMPOSE, Key::Menu },
+
+			{ KEY_UP, Key::Up }, { KEY_DOWN, Key::Down }, { KEY_LEFT, Key::Left }, { KEY_RIGHT, Key::Right },
+
+			{ KEY_SPACE, Key::Space },
+
+			{ BTN_LEFT, Key::MouseLeft }, { BTN_RIGHT, Key::MouseRight }, { BTN_MIDDLE, Key::MouseMiddle },
+			{ BTN_SIDE, Key::MouseX1 }, { BTN_EXTRA, Key::MouseX2 }, { BTN_FORWARD, Key::MouseX3 },
+			{ BTN_BACK, Key::MouseX4 }, { BTN_TASK, Key::MouseX5 },
+
+			{ KEY_PLAYPAUSE, Key::MediaPlayPause }, { KEY_STOPCD, Key::MediaStop },
+			{ KEY_NEXTSONG, Key::MediaNextTrack }, { KEY_PREVIOUSSONG, Key::MediaPrevTrack },
+			{ KEY_VOLUMEUP, Key::VolumeUp }, { KEY_VOLUMEDOWN, Key::VolumeDown },
+			{ KEY_MUTE, Key::VolumeMute }, { KEY_MAIL, Key::LaunchMail },
+			{ KEY_PROG1, Key::LaunchApp1 }, { KEY_PROG2, Key::LaunchApp2 },
+			{ KEY_BACK, Key::BrowserBack }, { KEY_FORWARD, Key::BrowserForward },
+			{ KEY_REFRESH, Key::BrowserRefresh }, { KEY_STOP, Key::BrowserStop },
+			{ KEY_SEARCH, Key::BrowserSearch }, { KEY_BOOKMARKS, Key::BrowserFavorites },
+			{ KEY_HOMEPAGE, Key::BrowserHome }
+		};
+
+		//returns false for codes without a matching key
+		bool TranslateEvdevKey(uint16_t code, Key& outKey)
+		{
+			//dense lookup built on first use, 0 marks unmapped codes
+			static const auto table = []()
+				{
+					struct Table { uint16_t keys[KEY_CNT]{}; } result{};
+					for (const auto& entry : evdevKeys)
+					{
+						result.keys[entry.code] = static_cast<uint16_t>(entry.key);
+					}
+					return result;
+				}();
+
+			if (code >= KEY_CNT
+				|| table.keys[code] == 0)
+			{
+				return false;
+			}
+
+			outKey = static_cast<Key>(table.keys[code]);
+			return true;
+		}
+
+		uint64_t ToTimestamp(const input_event& event)
+		{
+			return static_cast<uint64_t>(event.input_event_sec) * 1000000000ull
+				+ static_cast<uint64_t>(event.input_event_usec) * 1000ull;
+		}
+	}
+
+	EvdevInputBackend::~EvdevInputBackend()
+	{
+		CloseDevices();
+	}
+
+	bool EvdevInputBackend::AddDevice(const string& devicePath)
+	{
+		int device = open(devicePath.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+		if (device == -1)
+		{
+			LOG_ERROR("Failed to open input device '" << devicePath << "'!");
+			return false;
+		}
+
+		//report event times on the monotonic clock, which steady_clock uses on linux
+		int clockID = CLOCK_MONOTONIC;
+		if (ioctl(device, EVIOCSCLOCKID, &clockID) != 0)
+		{
+			LOG_DEBUG("Input device '" << devicePath << "' does not support monotonic timestamps.");
+		}
+
+		devices.push_back(device);
+		return true;
+	}
+
+	void EvdevInputBackend::CloseDevices()
+	{
+		for (int device : devices) close(device);
+		devices.clear();
+	}
+
+	void EvdevInputBackend::PollEvents()
+	{
+		input_event events[64];
+
+		for (int device : devices)
+		{
+			//relative motion is gathered until the end of each report
+			int moveX = 0;
+			int moveY = 0;
+			uint64_t moveTimestamp = 0;
+
+			while (true)
+			{
+				ssize_t bytes = read(device, events, sizeof(events));
+				if (bytes <= 0)
+				{
+					if (bytes < 0 && errno == EINTR) continue;
+					break;
+				}
+
+				size_t count = static_cast<size_t>(bytes) / sizeof(input_event);
+				for (size_t i = 0; i < count; i++)
+				{
+					const input_event& event = events[i];
+					uint64_t timestamp = ToTimestamp(event);
+
+					Key key{};
+					switch (event.type)
+					{
+					case EV_KEY:
+						//value 2 is autorepeat, which does not change the key state
+						if (event.value != 2
+							&& TranslateEvdevKey(event.code, key))
+						{
+							InputUtils::PushKeyEvent(key, event.value == 1, timestamp);
+						}
+						break;
+					case EV_REL:
+						if (event.code == REL_WHEEL)
+						{
+							InputUtils::PushMouseWheelEvent(event.value, timestamp);
+							break;
+						}
+
+						if (event.code == REL_X) moveX += event.value;
+						else if (event.code == REL_Y) moveY += event.value;
+						moveTimestamp = timestamp;
+						break;
+					case EV_SYN:
+						if (event.code == SYN_REPORT
+							&& (moveX != 0 || moveY != 0))
+						{
+							InputUtils::PushRawMouseMoveEvent({ moveX, moveY }, timestamp);
+							moveX = 0;
+							moveY = 0;
+						}
+						break;
+					}
+				}
+			}
+
+			//the device had no more data in the middle of a report
+			if (moveX != 0 || moveY != 0)
+			{
+				InputUtils::PushRawMouseMoveEvent({ moveX, moveY }, moveTimestamp);
+			}
+		}
+	}
+#endif
+}
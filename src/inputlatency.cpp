@@ -0,0 +1,196 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+//main log macro
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_INPUTLATENCY", level, msg)
+
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
+
+#include <fstream>
+#include <sstream>
+#include <bit>
+
+#include "inputlatency.hpp"
+#include "logger.hpp"
+
+using std::ofstream;
+using std::ostringstream;
+using std::countl_zero;
+using std::memory_order_relaxed;
+
+namespace KalaKit
+{
+	namespace
+	{
+		constexpr size_t eventTypeCount = static_cast<size_t>(InputEventType::MOUSE_WHEEL) + 1;
+
+		//four buckets per power of two, enough for the full uint64_t range
+		constexpr size_t bucketCount = 256;
+
+		const char* eventTypeNames[eventTypeCount] =
+		{
+			"KEY_PRESSED",
+			"KEY_RELEASED",
+			"MOUSE_MOVE",
+			"MOUSE_POSITION",
+			"RAW_MOUSE_MOVE",
+			"MOUSE_WHEEL"
+		};
+
+		struct Histogram
+		{
+			atomic<uint64_t> buckets[bucketCount]{};
+			atomic<uint64_t> count{ 0 };
+			atomic<uint64_t> sum{ 0 };
+			atomic<uint64_t> max{ 0 };
+			atomic<uint64_t> unconsumed{ 0 };
+		};
+
+		Histogram histograms[eventTypeCount]{};
+
+		size_t ToBucket(uint64_t value)
+		{
+			if (value < 4) return static_cast<size_t>(value);
+
+			size_t highestBit = static_cast<size_t>(63 - countl_zero(value));
+			size_t subBucket = static_cast<size_t>(value >> (highestBit - 2)) & 3;
+			return highestBit * 4 + subBucket;
+		}
+
+		//middle of the value range covered by the bucket
+		uint64_t FromBucket(size_t bucket)
+		{
+			if (bucket < 4) return bucket;
+
+			size_t highestBit = bucket / 4;
+			uint64_t subBucket = bucket & 3;
+			uint64_t lower = (4 | subBucket) << (highestBit - 2);
+			uint64_t width = uint64_t(1) << (highestBit - 2);
+			return lower + width / 2;
+		}
+
+		uint64_t GetPercentile(const uint64_t* counts, uint64_t total, double percentile)
+		{
+			uint64_t target = static_cast<uint64_t>(static_cast<double>(total) * percentile);
+			if (target == 0) target = 1;
+
+			uint64_t seen = 0;
+			for (size_t i = 0; i < bucketCount; i++)
+			{
+				seen += counts[i];
+				if (seen >= target) return FromBucket(i);
+			}
+			return 0;
+		}
+	}
+
+	void InputLatency::Record(InputEventType type, uint64_t latency)
+	{
+		size_t index = static_cast<size_t>(type);
+		if (index >= eventTypeCount) return;
+
+		Histogram& histogram = histograms[index];
+		histogram.buckets[ToBucket(latency)].fetch_add(1, memory_order_relaxed);
+		histogram.count.fetch_add(1, memory_order_relaxed);
+		histogram.sum.fetch_add(latency, memory_order_relaxed);
+
+		uint64_t currentMax = histogram.max.load(memory_order_relaxed);
+		while (latency > currentMax
+			&& !histogram.max.compare_exchange_weak(currentMax, latency, memory_order_relaxed));
+	}
+
+	void InputLatency::RecordUnconsumed(InputEventType type, uint64_t count)
+	{
+		size_t index = static_cast<size_t>(type);
+		if (index >= eventTypeCount) return;
+
+		histograms[index].unconsumed.fetch_add(count, memory_order_relaxed);
+	}
+
+	LatencyStats InputLatency::GetStats(InputEventType type)
+	{
+		LatencyStats stats{};
+
+		size_t index = static_cast<size_t>(type);
+		if (index >= eventTypeCount) return stats;
+
+		//copy first so concurrent recording cannot skew the percentiles
+		const Histogram& histogram = histograms[index];
+		stats.unconsumed = histogram.unconsumed.load(memory_order_relaxed);
+
+		uint64_t counts[bucketCount]{};
+		uint64_t total = 0;
+		for (size_t i = 0; i < bucketCount; i++)
+		{
+			counts[i] = histogram.buckets[i].load(memory_order_relaxed);
+			total += counts[i];
+		}
+		if (total == 0) return stats;
+
+		stats.count = total;
+		stats.p50 = GetPercentile(counts, total, 0.50);
+		stats.p99 = GetPercentile(counts, total, 0.99);
+		stats.max = histogram.max.load(memory_order_relaxed);
+
+		uint64_t count = histogram.count.load(memory_order_relaxed);
+		stats.mean = count == 0 ? 0 : histogram.sum.load(memory_order_relaxed) / count;
+
+		return stats;
+	}
+
+	string InputLatency::ToJson()
+	{
+		ostringstream json{};
+		json << "{\n";
+
+		for (size_t i = 0; i < eventTypeCount; i++)
+		{
+			LatencyStats stats = GetStats(static_cast<InputEventType>(i));
+
+			json << "\t\"" << eventTypeNames[i] << "\": { "
+				<< "\"count\": " << stats.count << ", "
+				<< "\"p50_ns\": " << stats.p50 << ", "
+				<< "\"p99_ns\": " << stats.p99 << ", "
+				<< "\"max_ns\": " << stats.max << ", "
+				<< "\"mean_ns\": " << stats.mean << ", "
+				<< "\"unconsumed\": " << stats.unconsumed << " }"
+				<< (i + 1 < eventTypeCount ? ",\n" : "\n");
+		}
+
+		json << "}\n";
+		return json.str();
+	}
+
+	bool InputLatency::DumpJson(const string& filePath)
+	{
+		ofstream file(filePath, std::ios::trunc);
+		if (!file.is_open())
+		{
+			LOG_ERROR("Failed to create input latency file '" << filePath << "'!");
+			return false;
+		}
+
+		file << ToJson();
+		return static_cast<bool>(file);
+	}
+
+	void InputLatency::Reset()
+	{
+		for (auto& histogram : histograms)
+		{
+			for (auto& bucket : histogram.buckets)
+			{
+				bucket.store(0, memory_order_relaxed);
+			}
+			histogram.count.store(0, memory_order_relaxed);
+			histogram.sum.store(0, memory_order_relaxed);
+			histogram.max.store(0, memory_order_relaxed);
+			histogram.unconsumed.store(0, memory_order_relaxed);
+		}
+	}
+}
@@ -0,0 +1,351 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+//main log macro
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_INPUTRECORDER", level, msg)
+
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
+
+#include <fstream>
+#include <iterator>
+#include <cstring>
+
+#include "inputrecorder.hpp"
+#include "logger.hpp"
+
+using std::ofstream;
+using std::ifstream;
+using std::istreambuf_iterator;
+
+//
+// FILE FORMAT
+//
+// header: 'KINR', uint32 version, uint64 base timestamp, all little endian
+//
+// followed by records, each starting with a tag byte:
+//   0-5 - InputEventType, then zigzag varint timestamp delta and the payload
+//         KEY_*                - varint key code
+//         MOUSE_*, RAW_MOUSE_* - zigzag varint x, y
+//         MOUSE_WHEEL          - zigzag varint x
+//   7   - end of frame, then zigzag varint timestamp delta
+//
+// every timestamp is stored relative to the previous record
+//
+
+namespace KalaKit
+{
+	namespace
+	{
+		constexpr uint32_t recordingVersion = 1;
+		constexpr size_t headerSize = 16;
+		constexpr uint8_t frameEndTag = 7;
+
+		//buffered bytes are written to the file once they exceed this
+		constexpr size_t flushThreshold = 64 * 1024;
+
+		ofstream recordFile{};
+		vector<uint8_t> recordBuffer{};
+		uint64_t recordTimestamp = 0;
+		bool isRecording = false;
+
+		vector<uint8_t> replayData{};
+		size_t replayPosition = 0;
+		uint64_t replayTimestamp = 0;
+		bool isReplaying = false;
+
+		void WriteVarint(vector<uint8_t>& out, uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				out.push_back(static_cast<uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+			out.push_back(static_cast<uint8_t>(value));
+		}
+
+		void WriteSigned(vector<uint8_t>& out, int64_t value)
+		{
+			//zigzag keeps small negative values small
+			WriteVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+		}
+
+		bool ReadVarint(uint64_t& outValue)
+		{
+			outValue = 0;
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				if (replayPosition >= replayData.size()) return false;
+
+				uint8_t byte = replayData[replayPosition++];
+				outValue |= static_cast<uint64_t>(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0) return true;
+			}
+			return false;
+		}
+
+		bool ReadSigned(int64_t& outValue)
+		{
+			uint64_t value = 0;
+			if (!ReadVarint(value)) return false;
+
+			outValue = static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+			return true;
+		}
+
+		void WriteTimestamp(uint64_t timestamp)
+		{
+			WriteSigned(recordBuffer, static_cast<int64_t>(timestamp - recordTimestamp));
+			recordTimestamp = timestamp;
+		}
+
+		bool ReadTimestamp(uint64_t& outTimestamp)
+		{
+			int64_t delta = 0;
+			if (!ReadSigned(delta)) return false;
+
+			replayTimestamp += static_cast<uint64_t>(delta);
+			outTimestamp = replayTimestamp;
+			return true;
+		}
+
+		bool FlushRecordBuffer()
+		{
+			recordFile.write(
+				reinterpret_cast<const char*>(recordBuffer.data()),
+				static_cast<std::streamsize>(recordBuffer.size()));
+			recordBuffer.clear();
+
+			return static_cast<bool>(recordFile);
+		}
+	}
+
+	bool InputRecorder::StartRecording(const string& filePath)
+	{
+		if (isRecording) StopRecording();
+
+		recordFile.open(filePath, std::ios::binary | std::ios::trunc);
+		if (!recordFile.is_open())
+		{
+			LOG_ERROR("Failed to create input recording '" << filePath << "'!");
+			return false;
+		}
+
+		recordTimestamp = InputUtils::GetEventTimestamp();
+
+		unsigned char header[headerSize]{};
+		memcpy(header, "KINR", 4);
+		memcpy(header + 4, &recordingVersion, sizeof(recordingVersion));
+		memcpy(header + 8, &recordTimestamp, sizeof(recordTimestamp));
+
+		recordBuffer.assign(header, header + headerSize);
+		isRecording = true;
+
+		LOG_DEBUG("Started recording input to '" << filePath << "'.");
+		return true;
+	}
+
+	bool InputRecorder::StopRecording()
+	{
+		if (!isRecording) return false;
+
+		bool success = FlushRecordBuffer();
+		recordFile.close();
+		isRecording = false;
+
+		if (!success)
+		{
+			LOG_ERROR("Failed to write input recording!");
+		}
+		return success;
+	}
+
+	bool InputRecorder::IsRecording()
+	{
+		return isRecording;
+	}
+
+	void InputRecorder::RecordFrame(const vector<InputEvent>& events, uint64_t frameTimestamp)
+	{
+		if (!isRecording) return;
+
+		for (const auto& event : events)
+		{
+			recordBuffer.push_back(static_cast<uint8_t>(event.type));
+			WriteTimestamp(event.timestamp);
+
+			switch (event.type)
+			{
+			case InputEventType::KEY_PRESSED:
+			case InputEventType::KEY_RELEASED:
+				WriteVarint(recordBuffer, static_cast<uint32_t>(event.key));
+				break;
+			case InputEventType::MOUSE_MOVE:
+			case InputEventType::MOUSE_POSITION:
+			case InputEventType::RAW_MOUSE_MOVE:
+				WriteSigned(recordBuffer, event.x);
+				WriteSigned(recordBuffer, event.y);
+				break;
+			case InputEventType::MOUSE_WHEEL:
+				WriteSigned(recordBuffer, event.x);
+				break;
+			}
+		}
+
+		recordBuffer.push_back(frameEndTag);
+		WriteTimestamp(frameTimestamp);
+
+		if (recordBuffer.size() >= flushThreshold
+			&& !FlushRecordBuffer())
+		{
+			LOG_ERROR("Failed to write input recording, recording stopped!");
+			recordFile.close();
+			isRecording = false;
+		}
+	}
+
+	bool InputRecorder::StartReplay(const string& filePath)
+	{
+		StopReplay();
+
+		ifstream file(filePath, std::ios::binary);
+		if (!file.is_open())
+		{
+			LOG_ERROR("Failed to open input recording '" << filePath << "'!");
+			return false;
+		}
+
+		replayData.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+
+		uint32_t version = 0;
+		if (replayData.size() >= headerSize)
+		{
+			memcpy(&version, replayData.data() + 4, sizeof(version));
+		}
+
+		if (replayData.size() < headerSize
+			|| memcmp(replayData.data(), "KINR", 4) != 0
+			|| version != recordingVersion)
+		{
+			LOG_ERROR("File '" << filePath << "' is not a supported input recording!");
+			replayData.clear();
+			return false;
+		}
+
+		memcpy(&replayTimestamp, replayData.data() + 8, sizeof(replayTimestamp));
+		replayPosition = headerSize;
+		isReplaying = true;
+
+		LOG_DEBUG("Started replaying input from '" << filePath << "'.");
+		return true;
+	}
+
+	void InputRecorder::StopReplay()
+	{
+		replayData.clear();
+		replayData.shrink_to_fit();
+		replayPosition = 0;
+		isReplaying = false;
+	}
+
+	bool InputRecorder::IsReplaying()
+	{
+		return isReplaying;
+	}
+
+	bool InputRecorder::ReplayFrame()
+	{
+		if (!isReplaying) return false;
+
+		while (replayPosition < replayData.size())
+		{
+			uint8_t tag = replayData[replayPosition++];
+			uint64_t timestamp = 0;
+			if (!ReadTimestamp(timestamp)) break;
+
+			if (tag == frameEndTag) return true;
+
+			uint64_t key = 0;
+			int64_t x = 0;
+			int64_t y = 0;
+			bool isValid = true;
+			bool isPushed = true;
+
+			switch (static_cast<InputEventType>(tag))
+			{
+			case InputEventType::KEY_PRESSED:
+			case InputEventType::KEY_RELEASED:
+				isValid = ReadVarint(key);
+				if (isValid)
+				{
+					isPushed = InputUtils::PushKeyEvent(
+						static_cast<Key>(key),
+						tag == static_cast<uint8_t>(InputEventType::KEY_PRESSED),
+						timestamp);
+				}
+				break;
+			case InputEventType::MOUSE_MOVE:
+			case InputEventType::MOUSE_POSITION:
+			case InputEventType::RAW_MOUSE_MOVE:
+			{
+				isValid = ReadSigned(x) && ReadSigned(y);
+				if (!isValid) break;
+
+				POS value{};
+				value.x = static_cast<int>(x);
+				value.y = static_cast<int>(y);
+
+				InputEventType type = static_cast<InputEventType>(tag);
+				if (type == InputEventType::MOUSE_MOVE) isPushed = InputUtils::PushMouseMoveEvent(value, timestamp);
+				else if (type == InputEventType::MOUSE_POSITION) isPushed = InputUtils::PushMousePositionEvent(value, timestamp);
+				else isPushed = InputUtils::PushRawMouseMoveEvent(value, timestamp);
+				break;
+			}
+			case InputEventType::MOUSE_WHEEL:
+				isValid = ReadSigned(x);
+				if (isValid) isPushed = InputUtils::PushMouseWheelEvent(static_cast<int>(x), timestamp);
+				break;
+			default:
+				isValid = false;
+				break;
+			}
+
+			if (!isValid) break;
+
+			//a dropped event would make the replay diverge from the recording without any sign of it,
+			//frames are never split across ProcessEvents calls so the replay stops instead
+			if (!isPushed)
+			{
+				LOG_ERROR("Input event queue is full, replay stopped!");
+				StopReplay();
+				return false;
+			}
+		}
+
+		//reached the end or found a damaged record
+		if (replayPosition < replayData.size())
+		{
+			LOG_ERROR("Input recording is damaged, replay stopped!");
+		}
+		StopReplay();
+		return false;
+	}
+
+	uint64_t InputRecorder::ReplayAll(const function<void()>& onFrame)
+	{
+		uint64_t frameCount = 0;
+		while (ReplayFrame())
+		{
+			InputUtils::ProcessEvents();
+			if (onFrame) onFrame();
+			InputUtils::ResetFrameInput();
+
+			frameCount++;
+		}
+		return frameCount;
+	}
+}
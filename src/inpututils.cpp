@@ -4,40 +4,44 @@
 //Read LICENSE.md for more information.
 
 //main log macro
-#define WRITE_LOG(type, msg) std::cout << "[KALAKIT_INPUTUTILS | " << type << "] " << msg << "\n"
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_INPUTUTILS", level, msg)
+//format log macro for hot paths, the arguments are formatted later by the logger thread
+#define WRITE_LOG_FORMAT(level, ...) KALAKIT_LOG_FORMAT("KALAKIT_INPUTUTILS", level, __VA_ARGS__)
 
-//log types
-#if KALAUTILS_DEBUG
-	#define LOG_DEBUG(msg) WRITE_LOG("DEBUG", msg)
-#else
-	#define LOG_DEBUG(msg)
-#endif
-#define LOG_SUCCESS(msg) WRITE_LOG("SUCCESS", msg)
-#define LOG_ERROR(msg) WRITE_LOG("ERROR", msg)
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_DEBUG_FORMAT(...) WRITE_LOG_FORMAT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
 
-#include <iostream>
+#include <chrono>
 
 #include "inpututils.hpp"
 #include "windowutils.hpp"
+#include "inputrecorder.hpp"
+#include "inputbackend.hpp"
+#include "inputlatency.hpp"
+#include "keynames.hpp"
+#include "logger.hpp"
 
-using std::to_string;
 using std::next;
+using std::chrono::steady_clock;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
 
 namespace KalaKit
 {
 	bool InputUtils::IsKeyHeld(Key key)
 	{
-		bool isKeyDown = keyHeld[key];
+		bool isKeyDown = keyHeld.Test(key);
+		if (InputLatency::IsEnabled()) ConsumeKeyLatency(key);
 
-		DebugType type = WindowUtils::GetDebugType();
-		if (type == DebugType::DEBUG_ALL
-			|| type == DebugType::DEBUG_KEY_HELD)
+		if (WindowUtils::IsDebugTypeEnabled(DebugType::DEBUG_KEY_HELD))
 		{
 			//only print if key is down
 			if (isKeyDown)
 			{
-				string keyName = ToString(key);
-				LOG_DEBUG("Key '" << keyName << "' is down");
+				LOG_DEBUG_FORMAT("Key '{}' is down", KeyNames::ToName(key));
 			}
 		}
 
@@ -46,17 +50,15 @@ namespace KalaKit
 
 	bool InputUtils::IsKeyPressed(Key key)
 	{
-		bool wasKeyPressed = keyPressed[key];
+		bool wasKeyPressed = keyPressed.Test(key);
+		if (InputLatency::IsEnabled()) ConsumeKeyLatency(key);
 
-		DebugType type = WindowUtils::WindowUtils::GetDebugType();
-		if (type == DebugType::DEBUG_ALL
-			|| type == DebugType::DEBUG_KEY_PRESSED)
+		if (WindowUtils::IsDebugTypeEnabled(DebugType::DEBUG_KEY_PRESSED))
 		{
 			//only print if key was pressed
 			if (wasKeyPressed)
 			{
-				string keyName = ToString(key);
-				LOG_DEBUG("Pressed key '" << keyName << "'.");
+				LOG_DEBUG_FORMAT("Pressed key '{}'.", KeyNames::ToName(key));
 			}
 		}
 
@@ -68,17 +70,17 @@ namespace KalaKit
 		//cannot proceed if only one key is assigned
 		if (keys.size() < 2) return false;
 
+		//test the bitsets directly instead of going through IsKeyHeld per key,
+		//use ActionMap when many combos are checked every frame
 		auto it = keys.begin();
 		for (size_t i = 0; i < keys.size() - 1; i++)
 		{
-			if (!IsKeyHeld(*it++)) return false;
+			if (!keyHeld.Test(*it++)) return false;
 		}
 
-		bool wasComboPressed = IsKeyPressed(*it);
+		bool wasComboPressed = keyPressed.Test(*it);
 
-		DebugType type = WindowUtils::GetDebugType();
-		if (type == DebugType::DEBUG_ALL
-			|| type == DebugType::DEBUG_COMBO_PRESSED)
+		if (WindowUtils::IsDebugTypeEnabled(DebugType::DEBUG_COMBO_PRESSED))
 		{
 			//only print if combo was pressed
 			if (wasComboPressed)
@@ -105,12 +107,10 @@ namespace KalaKit
 	bool InputUtils::IsMouseKeyDoubleClicked()
 	{
 		bool wasDoubleClicked =
-			keyPressed[Key::MouseLeft]
-			|| keyPressed[Key::MouseRight];
+			keyPressed.Test(Key::MouseLeft)
+			|| keyPressed.Test(Key::MouseRight);
 
-		DebugType type = WindowUtils::GetDebugType();
-		if (type == DebugType::DEBUG_ALL
-			|| type == DebugType::DEBUG_DOUBLE_CLICKED)
+		if (WindowUtils::IsDebugTypeEnabled(DebugType::DEBUG_DOUBLE_CLICKED))
 		{
 			//only print if double clicked
 			if (wasDoubleClicked)
@@ -125,17 +125,15 @@ namespace KalaKit
 	bool InputUtils::IsMouseDragging()
 	{
 		bool isHoldingDragKey =
-			keyHeld[Key::MouseLeft]
-			|| keyHeld[Key::MouseRight];
+			keyHeld.Test(Key::MouseLeft)
+			|| keyHeld.Test(Key::MouseRight);
 
 		bool isDragging =
 			isHoldingDragKey
 			&& (mouseDelta.x != 0
 				|| mouseDelta.y != 0);
 
-		DebugType type = WindowUtils::GetDebugType();
-		if (type == DebugType::DEBUG_ALL
-			|| type == DebugType::DEBUG_IS_MOUSE_DRAGGING)
+		if (WindowUtils::IsDebugTypeEnabled(DebugType::DEBUG_IS_MOUSE_DRAGGING))
 		{
 			//only print if dragging
 			if (isDragging)
@@ -149,9 +147,9 @@ namespace KalaKit
 
 	POS InputUtils::GetMousePosition()
 	{
-		DebugType type = WindowUtils::GetDebugType();
-		if (type == DebugType::DEBUG_ALL
-			|| type == DebugType::DEBUG_MOUSE_POSITION)
+		if (InputLatency::IsEnabled()) ConsumeEventLatency(InputEventType::MOUSE_POSITION);
+
+		if (WindowUtils::IsDebugTypeEnabled(DebugType::DEBUG_MOUSE_POSITION))
 		{
 			static POS lastPos = { -9999, -9999 };
 
@@ -159,9 +157,7 @@ namespace KalaKit
 			if (mousePosition.x != lastPos.x
 				|| mousePosition.y != lastPos.y)
 			{
-				LOG_DEBUG("Mouse position: ("
-					<< mousePosition.x << ", "
-					<< mousePosition.y << ")");
+				LOG_DEBUG_FORMAT("Mouse position: ({}, {})", mousePosition.x, mousePosition.y);
 
 				lastPos.x = mousePosition.x;
 				lastPos.y = mousePosition.y;
@@ -178,17 +174,15 @@ namespace KalaKit
 
 	POS InputUtils::GetMouseDelta()
 	{
-		DebugType type = WindowUtils::GetDebugType();
-		if (type == DebugType::DEBUG_ALL
-			|| type == DebugType::DEBUG_MOUSE_DELTA)
+		if (InputLatency::IsEnabled()) ConsumeEventLatency(InputEventType::MOUSE_MOVE);
+
+		if (WindowUtils::IsDebugTypeEnabled(DebugType::DEBUG_MOUSE_DELTA))
 		{
 			//only print if mouse moved
 			if (mouseDelta.x != 0
 				|| mouseDelta.y != 0)
 			{
-				LOG_DEBUG("Mouse delta: ("
-					<< mouseDelta.x << ", "
-					<< mouseDelta.y << ")");
+				LOG_DEBUG_FORMAT("Mouse delta: ({}, {})", mouseDelta.x, mouseDelta.y);
 			}
 		}
 
@@ -202,17 +196,15 @@ namespace KalaKit
 
 	POS InputUtils::GetRawMouseDelta()
 	{
-		DebugType type = WindowUtils::GetDebugType();
-		if (type == DebugType::DEBUG_ALL
-			|| type == DebugType::DEBUG_RAW_MOUSE_DELTA)
+		if (InputLatency::IsEnabled()) ConsumeEventLatency(InputEventType::RAW_MOUSE_MOVE);
+
+		if (WindowUtils::IsDebugTypeEnabled(DebugType::DEBUG_RAW_MOUSE_DELTA))
 		{
 			//only print if mouse moved
 			if (rawMouseDelta.x != 0
 				|| rawMouseDelta.y != 0)
 			{
-				LOG_DEBUG("Raw mouse delta: ("
-					<< rawMouseDelta.x << ", "
-					<< rawMouseDelta.y << ")");
+				LOG_DEBUG_FORMAT("Raw mouse delta: ({}, {})", rawMouseDelta.x, rawMouseDelta.y);
 			}
 		}
 
@@ -226,11 +218,11 @@ namespace KalaKit
 
 	int InputUtils::GetMouseWheelDelta()
 	{
-		DebugType type = WindowUtils::GetDebugType();
-		if (type == DebugType::DEBUG_ALL
-			|| type == DebugType::DEBUG_MOUSE_WHEEL_DELTA)
+		if (InputLatency::IsEnabled()) ConsumeEventLatency(InputEventType::MOUSE_WHEEL);
+
+		if (WindowUtils::IsDebugTypeEnabled(DebugType::DEBUG_MOUSE_WHEEL_DELTA))
 		{
-			LOG_DEBUG("Mouse wheel delta: " << to_string(mouseWheelDelta) << "");
+			LOG_DEBUG_FORMAT("Mouse wheel delta: {}", mouseWheelDelta);
 		}
 
 		return mouseWheelDelta;
@@ -249,18 +241,14 @@ namespace KalaKit
 		//ignores same state
 		if (isMouseVisible == newMouseVisibleState) return;
 
-		DebugType type = WindowUtils::GetDebugType();
-		if (type == DebugType::DEBUG_ALL
-			|| type == DebugType::DEBUG_MOUSE_VISIBILITY)
+		if (WindowUtils::IsDebugTypeEnabled(DebugType::DEBUG_MOUSE_VISIBILITY))
 		{
 			string type = newMouseVisibleState ? "true" : "false";
 			LOG_DEBUG("Mouse wheel visibility: " << type << "");
 		}
 
 		isMouseVisible = newMouseVisibleState;
-
-		if (isMouseVisible) while (ShowCursor(TRUE) < 0); //increment until visible
-		else while (ShowCursor(FALSE) >= 0);              //decrement until hidden
+		GetBackend()->SetCursorVisible(isMouseVisible);
 	}
 
 	bool InputUtils::IsMouseLocked()
@@ -272,60 +260,304 @@ namespace KalaKit
 		//ignores same state
 		if (isMouseLocked == newMouseLockState) return;
 
-		DebugType type = WindowUtils::GetDebugType();
-		if (type == DebugType::DEBUG_ALL
-			|| type == DebugType::DEBUG_MOUSE_LOCK_STATE)
+		if (WindowUtils::IsDebugTypeEnabled(DebugType::DEBUG_MOUSE_LOCK_STATE))
 		{
 			string type = newMouseLockState ? "true" : "false";
 			LOG_DEBUG("Mouse wheel lock state: " << type << "");
 		}
 
 		isMouseLocked = newMouseLockState;
-		if (!isMouseLocked) ClipCursor(nullptr);
-		else
+		GetBackend()->SetCursorLocked(isMouseLocked);
+	}
+
+	void InputUtils::ResetFrameInput()
+	{
+		//clear "pressed" and "changed" keys after each frame
+		keyPressed.ClearAll();
+		keyChanged.ClearAll();
+
+		//ProcessEvents adds up motion every frame, so the deltas always start over,
+		//dragging only depends on the held buttons and the motion of the current frame
+		mouseDelta = { 0, 0 };
+		rawMouseDelta = { 0, 0 };
+		mouseWheelDelta = 0;
+	}
+
+	void RawMouseHistory::Push(const RawMouseSample& sample)
+	{
+		samples[totalCount & (capacity - 1)] = sample;
+		totalCount++;
+	}
+
+	void RawMouseHistory::Clear()
+	{
+		totalCount = 0;
+		frameStart = 0;
+	}
+
+	size_t RawMouseHistory::GetFrameSampleCount() const
+	{
+		uint64_t count = totalCount - frameStart;
+		return static_cast<size_t>(count < capacity ? count : capacity);
+	}
+
+	const RawMouseSample& RawMouseHistory::GetFrameSample(size_t index) const
+	{
+		uint64_t first = totalCount - GetFrameSampleCount();
+		return samples[(first + index) & (capacity - 1)];
+	}
+
+	POS RawMouseHistory::Integrate(uint64_t startTime, uint64_t endTime) const
+	{
+		POS sum = { 0, 0 };
+
+		uint64_t stored = totalCount < capacity ? totalCount : capacity;
+		for (uint64_t i = 0; i < stored; i++)
 		{
-			LockCursorToCenter();
-
-			//clip the cursor to the window to prevent it from leaving
-			RECT rect{};
-			GetClientRect(WindowUtils::window, &rect);
-			ClientToScreen(WindowUtils::window, (POS*)&rect.left);
-			ClientToScreen(WindowUtils::window, (POS*)&rect.right);
-			ClipCursor(&rect);
+			//walk from the newest sample back until the window is left
+			const RawMouseSample& sample = samples[(totalCount - 1 - i) & (capacity - 1)];
+			if (sample.timestamp <= startTime) break;
+			if (sample.timestamp > endTime) continue;
+
+			sum.x += sample.x;
+			sum.y += sample.y;
 		}
+
+		return sum;
 	}
 
-	void InputUtils::ResetFrameInput()
+	MouseVelocity RawMouseHistory::GetVelocity(uint64_t window, uint64_t endTime) const
+	{
+		if (window == 0 || totalCount == 0) return { 0.0f, 0.0f };
+
+		if (endTime == 0) endTime = GetNewestTimestamp();
+		uint64_t startTime = endTime > window ? endTime - window : 0;
+
+		POS distance = Integrate(startTime, endTime);
+		double seconds = static_cast<double>(window) / 1e9;
+
+		return
+		{
+			static_cast<float>(distance.x / seconds),
+			static_cast<float>(distance.y / seconds)
+		};
+	}
+
+	uint64_t RawMouseHistory::GetNewestTimestamp() const
+	{
+		if (totalCount == 0) return 0;
+		return samples[(totalCount - 1) & (capacity - 1)].timestamp;
+	}
+
+	void InputUtils::ConsumeKeyLatency(Key key)
 	{
-		//clear "pressed" keys after each frame
-		for (auto& [key, pressed] : keyPressed)
+		size_t index = static_cast<size_t>(key) & (KeyBitset::keyCount - 1);
+		uint64_t arrival = keyEventTimes[index];
+		if (arrival == 0) return;
+
+		uint64_t now = GetEventTimestamp();
+		InputLatency::Record(keyEventTypes[index], now > arrival ? now - arrival : 0);
+		keyEventTimes[index] = 0;
+		pendingLatencyCount--;
+	}
+
+	void InputUtils::ConsumeEventLatency(InputEventType type)
+	{
+		uint64_t& arrival = pendingEventTimes[static_cast<size_t>(type)];
+		if (arrival == 0) return;
+
+		uint64_t now = GetEventTimestamp();
+		InputLatency::Record(type, now > arrival ? now - arrival : 0);
+		arrival = 0;
+		pendingLatencyCount--;
+	}
+
+	void InputUtils::DiscardUnconsumedLatency()
+	{
+		for (size_t i = 0; i < KeyBitset::keyCount && pendingLatencyCount > 0; i++)
 		{
-			pressed = false;
+			if (keyEventTimes[i] == 0) continue;
+
+			InputLatency::RecordUnconsumed(keyEventTypes[i]);
+			keyEventTimes[i] = 0;
+			pendingLatencyCount--;
+		}
+		for (size_t i = 0; i <= static_cast<size_t>(InputEventType::MOUSE_WHEEL) && pendingLatencyCount > 0; i++)
+		{
+			if (pendingEventTimes[i] == 0) continue;
+
+			InputLatency::RecordUnconsumed(static_cast<InputEventType>(i));
+			pendingEventTimes[i] = 0;
+			pendingLatencyCount--;
 		}
+	}
 
-		if (!IsMouseDragging())
+	InputBackend* InputUtils::GetBackend()
+	{
+		if (backend != nullptr) return backend;
+
+#ifdef _WIN32
+		static Win32InputBackend defaultBackend{};
+#else
+		static SyntheticInputBackend defaultBackend{};
+#endif
+		return &defaultBackend;
+	}
+
+	void InputUtils::ProcessEvents()
+	{
+		GetBackend()->PollEvents();
+
+		frameEvents.clear();
+		rawMouseHistory.BeginFrame();
+
+		//events the previous frame never queried would otherwise report their whole wait
+		//once something finally reads them, so they are counted separately instead
+		if (pendingLatencyCount > 0) DiscardUnconsumedLatency();
+
+		//replayed events carry recorded timestamps, their latency is meaningless
+		bool isLatencyEnabled =
+			InputLatency::IsEnabled()
+			&& !InputRecorder::IsReplaying();
+
+		InputEvent event{};
+		while (eventQueue.TryPop(event))
+		{
+			if (isLatencyEnabled)
+			{
+				if (event.type == InputEventType::KEY_PRESSED
+					|| event.type == InputEventType::KEY_RELEASED)
+				{
+					size_t index = static_cast<size_t>(event.key) & (KeyBitset::keyCount - 1);
+					if (keyEventTimes[index] == 0)
+					{
+						keyEventTimes[index] = event.timestamp;
+						keyEventTypes[index] = event.type;
+						pendingLatencyCount++;
+					}
+				}
+				else if (pendingEventTimes[static_cast<size_t>(event.type)] == 0)
+				{
+					pendingEventTimes[static_cast<size_t>(event.type)] = event.timestamp;
+					pendingLatencyCount++;
+				}
+			}
+
+			switch (event.type)
+			{
+			case InputEventType::KEY_PRESSED:
+				SetKeyState(event.key, true);
+				break;
+			case InputEventType::KEY_RELEASED:
+				SetKeyState(event.key, false);
+				break;
+			case InputEventType::MOUSE_MOVE:
+				mouseDelta.x += event.x;
+				mouseDelta.y += event.y;
+				break;
+			case InputEventType::MOUSE_POSITION:
+				mousePosition.x = event.x;
+				mousePosition.y = event.y;
+				break;
+			case InputEventType::RAW_MOUSE_MOVE:
+				rawMouseDelta.x += event.x;
+				rawMouseDelta.y += event.y;
+				rawMouseHistory.Push({ event.timestamp, event.x, event.y });
+				break;
+			case InputEventType::MOUSE_WHEEL:
+				mouseWheelDelta += event.x;
+				break;
+			}
+
+			frameEvents.push_back(event);
+		}
+
+		if (InputRecorder::IsRecording())
 		{
-			mouseDelta = { 0, 0 };
-			rawMouseDelta = { 0, 0 };
-			mouseWheelDelta = 0;
+			InputRecorder::RecordFrame(frameEvents, GetEventTimestamp());
 		}
+
+		PublishSnapshot();
 	}
 
-	void InputUtils::LockCursorToCenter()
+	void InputUtils::PublishSnapshot()
+	{
+		InputSnapshot frame{};
+		frame.frameIndex = publishedFrameCount++;
+		frame.timestamp = GetEventTimestamp();
+
+		frame.heldKeys = keyHeld;
+		frame.pressedKeys = keyPressed;
+		frame.changedKeys = keyChanged;
+
+		frame.mousePosition = mousePosition;
+		frame.mouseDelta = mouseDelta;
+		frame.rawMouseDelta = rawMouseDelta;
+		frame.mouseWheelDelta = mouseWheelDelta;
+
+		frame.isMouseVisible = isMouseVisible;
+		frame.isMouseLocked = isMouseLocked;
+
+		snapshot.Store(frame);
+	}
+
+	uint64_t InputUtils::GetEventTimestamp()
+	{
+		return static_cast<uint64_t>(duration_cast<nanoseconds>(
+			steady_clock::now().time_since_epoch()).count());
+	}
+
+	bool InputUtils::PushKeyEvent(Key key, bool isDown, uint64_t timestamp)
+	{
+		InputEventType type = isDown ? InputEventType::KEY_PRESSED : InputEventType::KEY_RELEASED;
+		return PushEvent(type, key, 0, 0, timestamp);
+	}
+	bool InputUtils::PushMouseMoveEvent(POS delta, uint64_t timestamp)
 	{
-		RECT rect{};
-		GetClientRect(WindowUtils::window, &rect);
+		return PushEvent(InputEventType::MOUSE_MOVE, Key{}, delta.x, delta.y, timestamp);
+	}
+	bool InputUtils::PushMousePositionEvent(POS position, uint64_t timestamp)
+	{
+		return PushEvent(InputEventType::MOUSE_POSITION, Key{}, position.x, position.y, timestamp);
+	}
+	bool InputUtils::PushRawMouseMoveEvent(POS delta, uint64_t timestamp)
+	{
+		return PushEvent(InputEventType::RAW_MOUSE_MOVE, Key{}, delta.x, delta.y, timestamp);
+	}
+	bool InputUtils::PushMouseWheelEvent(int delta, uint64_t timestamp)
+	{
+		return PushEvent(InputEventType::MOUSE_WHEEL, Key{}, delta, 0, timestamp);
+	}
 
-		POS center{};
-		center.x = (rect.right - rect.left) / 2;
-		center.y = (rect.bottom - rect.top) / 2;
+	bool InputUtils::PushEvent(
+		InputEventType type,
+		Key key,
+		int x,
+		int y,
+		uint64_t timestamp)
+	{
+		InputEvent event{};
+		event.timestamp = timestamp != 0 ? timestamp : GetEventTimestamp();
+		event.type = type;
+		event.key = key;
+		event.x = x;
+		event.y = y;
+
+		if (!eventQueue.TryPush(event))
+		{
+			droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		return true;
+	}
 
-		ClientToScreen(WindowUtils::window, &center);
-		SetCursorPos(center.x, center.y);
+	void InputUtils::LockCursorToCenter()
+	{
+		GetBackend()->CenterCursor();
 	}
 
 	string InputUtils::ToString(Key key)
 	{
-		return "";
+		return string(KeyNames::ToName(key));
 	}
 }
\ No newline at end of file
@@ -0,0 +1,524 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+//main log macro
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_LINEINDEX", level, msg)
+
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
+
+#include <fstream>
+#include <thread>
+#include <bit>
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64)
+	#define LINEINDEX_SSE2 1
+	#include <emmintrin.h>
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+	#define LINEINDEX_AVX2 1
+	#include <immintrin.h>
+#endif
+//inlines the whole scan loop into the AVX2 entry points, including the AVX2 mask
+#if defined(__GNUC__) || defined(__clang__)
+	#define LINEINDEX_FLATTEN __attribute__((flatten))
+#else
+	#define LINEINDEX_FLATTEN
+#endif
+
+#include "lineindex.hpp"
+#include "osutils.hpp"
+#include "logger.hpp"
+
+using std::ifstream;
+using std::ofstream;
+using std::thread;
+using std::popcount;
+using std::countr_zero;
+using std::to_string;
+
+namespace KalaKit
+{
+	namespace
+	{
+		struct LineIndexHeader
+		{
+			char magic[4];          //always 'KLIX'
+			uint32_t version;
+			uint32_t stride;
+			uint32_t reserved;
+			uint64_t indexedSize;
+			uint64_t newlineCount;
+			uint64_t checkpointCount;
+			uint64_t fingerprint;   //hash of the first and last 4KB of the indexed bytes
+		};
+
+		constexpr uint32_t indexVersion = 1;
+		constexpr uint64_t fingerprintRegion = 4096;
+
+		//below this many bytes per thread the scan is not worth splitting
+		constexpr uint64_t minChunkSize = uint64_t(1) << 20;
+
+		//bitmask of the '\n' bytes in the 64 bytes starting at data
+		inline uint64_t NewlineMask64(const char* data)
+		{
+#ifdef LINEINDEX_SSE2
+			const __m128i newline = _mm_set1_epi8('\n');
+			uint64_t m0 = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), newline)));
+			uint64_t m1 = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)), newline)));
+			uint64_t m2 = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)), newline)));
+			uint64_t m3 = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)), newline)));
+			return m0 | (m1 << 16) | (m2 << 32) | (m3 << 48);
+#else
+			uint64_t mask = 0;
+			for (int i = 0; i < 64; i++)
+			{
+				mask |= static_cast<uint64_t>(data[i] == '\n') << i;
+			}
+			return mask;
+#endif
+		}
+
+#ifdef LINEINDEX_AVX2
+		//same as NewlineMask64 with two 32 byte compares
+		KALAKIT_TARGET("avx2") inline uint64_t NewlineMask64Avx2(const char* data)
+		{
+			const __m256i newline = _mm256_set1_epi8('\n');
+			uint64_t low = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), newline)));
+			uint64_t high = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32)), newline)));
+			return low | (high << 32);
+		}
+#endif
+
+		//counts the newlines in [begin, end) and records the start of every line
+		//whose number is a multiple of stride, newlinesBefore is the count before begin
+		template <uint64_t (*Mask)(const char*)>
+		inline uint64_t ScanNewlinesWith(
+			const char* data,
+			uint64_t begin,
+			uint64_t end,
+			uint64_t newlinesBefore,
+			uint32_t stride,
+			vector<uint64_t>* outCheckpoints)
+		{
+			uint64_t count = newlinesBefore;
+			uint64_t nextCheckpoint = outCheckpoints
+				? (count / stride + 1) * stride
+				: UINT64_MAX;
+
+			uint64_t position = begin;
+			while (position + 64 <= end)
+			{
+				uint64_t mask = Mask(data + position);
+				uint64_t bits = static_cast<uint64_t>(popcount(mask));
+
+				//only walk individual bits when a checkpoint falls inside this block
+				if (count + bits >= nextCheckpoint)
+				{
+					while (mask)
+					{
+						uint64_t bit = static_cast<uint64_t>(countr_zero(mask));
+						mask &= mask - 1;
+						if (++count == nextCheckpoint)
+						{
+							outCheckpoints->push_back(position + bit + 1);
+							nextCheckpoint += stride;
+						}
+					}
+				}
+				else count += bits;
+
+				position += 64;
+			}
+
+			for (; position < end; position++)
+			{
+				if (data[position] == '\n'
+					&& ++count == nextCheckpoint)
+				{
+					outCheckpoints->push_back(position + 1);
+					nextCheckpoint += stride;
+				}
+			}
+
+			return count - newlinesBefore;
+		}
+
+		//offset right after the n-th newline at or after begin, or end if there are fewer
+		template <uint64_t (*Mask)(const char*)>
+		inline uint64_t SkipNewlinesWith(
+			const char* data,
+			uint64_t begin,
+			uint64_t end,
+			uint64_t n)
+		{
+			if (n == 0) return begin;
+
+			uint64_t position = begin;
+			while (position + 64 <= end)
+			{
+				uint64_t mask = Mask(data + position);
+				uint64_t bits = static_cast<uint64_t>(popcount(mask));
+				if (bits >= n)
+				{
+					for (uint64_t i = 1; i < n; i++) mask &= mask - 1;
+					return position + static_cast<uint64_t>(countr_zero(mask)) + 1;
+				}
+				n -= bits;
+				position += 64;
+			}
+
+			for (; position < end; position++)
+			{
+				if (data[position] == '\n'
+					&& --n == 0)
+				{
+					return position + 1;
+				}
+			}
+
+			return end;
+		}
+
+		using ScanFunction = uint64_t(*)(const char*, uint64_t, uint64_t, uint64_t, uint32_t, vector<uint64_t>*);
+		using SkipFunction = uint64_t(*)(const char*, uint64_t, uint64_t, uint64_t);
+
+#ifdef LINEINDEX_AVX2
+		KALAKIT_TARGET("avx2") LINEINDEX_FLATTEN uint64_t ScanNewlinesAvx2(
+			const char* data,
+			uint64_t begin,
+			uint64_t end,
+			uint64_t newlinesBefore,
+			uint32_t stride,
+			vector<uint64_t>* outCheckpoints)
+		{
+			return ScanNewlinesWith<NewlineMask64Avx2>(data, begin, end, newlinesBefore, stride, outCheckpoints);
+		}
+		KALAKIT_TARGET("avx2") LINEINDEX_FLATTEN uint64_t SkipNewlinesAvx2(
+			const char* data,
+			uint64_t begin,
+			uint64_t end,
+			uint64_t n)
+		{
+			return SkipNewlinesWith<NewlineMask64Avx2>(data, begin, end, n);
+		}
+#else
+		constexpr ScanFunction ScanNewlinesAvx2 = nullptr;
+		constexpr SkipFunction SkipNewlinesAvx2 = nullptr;
+#endif
+
+		//picked once when the library is loaded
+		const ScanFunction ScanNewlines = OSUtils::SelectKernel<ScanFunction>(
+			{ ScanNewlinesWith<NewlineMask64>, nullptr, ScanNewlinesAvx2 });
+		const SkipFunction SkipNewlines = OSUtils::SelectKernel<SkipFunction>(
+			{ SkipNewlinesWith<NewlineMask64>, nullptr, SkipNewlinesAvx2 });
+
+		uint64_t HashBytes(const char* data, uint64_t size, uint64_t hash)
+		{
+			for (uint64_t i = 0; i < size; i++)
+			{
+				hash ^= static_cast<unsigned char>(data[i]);
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+	}
+
+	bool LineIndex::Build(
+		const string& newFilePath,
+		unsigned int threadCount,
+		uint32_t newStride)
+	{
+		//newFilePath may refer to filePath itself when rebuilding
+		string path = newFilePath;
+		Close();
+
+		filePath = path;
+		stride = newStride == 0 ? 1 : newStride;
+
+		if (!file.Open(filePath))
+		{
+			LOG_ERROR("Failed to map '" << filePath << "' for line indexing!");
+			return false;
+		}
+
+		const char* data = file.GetData();
+		uint64_t size = file.GetSize();
+
+		if (threadCount == 0) threadCount = thread::hardware_concurrency();
+		if (threadCount == 0) threadCount = 1;
+		if (size / minChunkSize < threadCount) threadCount = static_cast<unsigned int>(size / minChunkSize);
+		if (threadCount == 0) threadCount = 1;
+
+		checkpoints.assign(1, 0);
+
+		if (threadCount == 1)
+		{
+			newlineCount = ScanNewlines(data, 0, size, 0, stride, &checkpoints);
+		}
+		else
+		{
+			//first pass counts newlines per chunk, second pass records
+			//checkpoints once every chunk knows its starting line number
+			vector<uint64_t> bounds(threadCount + 1, 0);
+			for (unsigned int i = 0; i <= threadCount; i++)
+			{
+				bounds[i] = size * i / threadCount;
+			}
+
+			vector<uint64_t> counts(threadCount, 0);
+			vector<vector<uint64_t>> localCheckpoints(threadCount);
+			vector<thread> threads;
+
+			for (unsigned int i = 0; i < threadCount; i++)
+			{
+				threads.emplace_back([&, i]()
+					{
+						counts[i] = ScanNewlines(data, bounds[i], bounds[i + 1], 0, stride, nullptr);
+					});
+			}
+			for (auto& t : threads) t.join();
+			threads.clear();
+
+			vector<uint64_t> newlinesBefore(threadCount, 0);
+			for (unsigned int i = 1; i < threadCount; i++)
+			{
+				newlinesBefore[i] = newlinesBefore[i - 1] + counts[i - 1];
+			}
+
+			for (unsigned int i = 0; i < threadCount; i++)
+			{
+				threads.emplace_back([&, i]()
+					{
+						ScanNewlines(data, bounds[i], bounds[i + 1], newlinesBefore[i], stride, &localCheckpoints[i]);
+					});
+			}
+			for (auto& t : threads) t.join();
+
+			newlineCount = newlinesBefore.back() + counts.back();
+			for (const auto& local : localCheckpoints)
+			{
+				checkpoints.insert(checkpoints.end(), local.begin(), local.end());
+			}
+		}
+
+		indexedSize = size;
+		fingerprint = HashRegion(indexedSize);
+
+		LOG_DEBUG("Indexed " << GetLineCount() << " lines of '" << filePath << "' with " << threadCount << " threads.");
+		return true;
+	}
+
+	bool LineIndex::Load(const string& newFilePath, unsigned int threadCount)
+	{
+		Close();
+		filePath = newFilePath;
+
+		ifstream indexFile(GetIndexPath(filePath), std::ios::binary);
+		LineIndexHeader header{};
+		bool isValid =
+			indexFile.is_open()
+			&& indexFile.read(reinterpret_cast<char*>(&header), sizeof(header))
+			&& memcmp(header.magic, "KLIX", 4) == 0
+			&& header.version == indexVersion
+			&& header.stride != 0
+			&& header.newlineCount <= header.indexedSize
+			&& header.checkpointCount == header.newlineCount / header.stride + 1;
+
+		//the newline count is bounded by the file size before anything is allocated for it
+		isValid =
+			isValid
+			&& file.Open(filePath)
+			&& file.GetSize() >= header.indexedSize;
+
+		if (isValid)
+		{
+			checkpoints.resize(header.checkpointCount);
+			isValid = static_cast<bool>(indexFile.read(
+				reinterpret_cast<char*>(checkpoints.data()),
+				static_cast<std::streamsize>(checkpoints.size() * sizeof(uint64_t))));
+		}
+
+		//line lookups trust the checkpoints, so they must start at zero and increase within the indexed region
+		if (isValid)
+		{
+			isValid = checkpoints[0] == 0;
+			for (size_t i = 1; isValid && i < checkpoints.size(); i++)
+			{
+				isValid =
+					checkpoints[i] > checkpoints[i - 1]
+					&& checkpoints[i] <= header.indexedSize;
+			}
+		}
+
+		if (isValid)
+		{
+			stride = header.stride;
+			newlineCount = header.newlineCount;
+			indexedSize = header.indexedSize;
+			fingerprint = header.fingerprint;
+
+			isValid = HashRegion(indexedSize) == fingerprint;
+		}
+
+		if (!isValid)
+		{
+			LOG_DEBUG("No usable line index for '" << filePath << "', building a new one.");
+
+			uint32_t buildStride = header.stride != 0 ? header.stride : defaultStride;
+			if (!Build(filePath, threadCount, buildStride)) return false;
+			Save();
+			return true;
+		}
+
+		//the file only grew since the index was saved
+		if (file.GetSize() > indexedSize)
+		{
+			ScanAppended(indexedSize);
+			Save();
+		}
+
+		return true;
+	}
+
+	bool LineIndex::Save() const
+	{
+		if (!file.IsOpen()) return false;
+
+		LineIndexHeader header{};
+		memcpy(header.magic, "KLIX", 4);
+		header.version = indexVersion;
+		header.stride = stride;
+		header.indexedSize = indexedSize;
+		header.newlineCount = newlineCount;
+		header.checkpointCount = checkpoints.size();
+		header.fingerprint = fingerprint;
+
+		string indexPath = GetIndexPath(filePath);
+		ofstream indexFile(indexPath, std::ios::binary | std::ios::trunc);
+		if (!indexFile.is_open())
+		{
+			LOG_ERROR("Failed to create line index '" << indexPath << "'!");
+			return false;
+		}
+
+		indexFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		indexFile.write(
+			reinterpret_cast<const char*>(checkpoints.data()),
+			static_cast<std::streamsize>(checkpoints.size() * sizeof(uint64_t)));
+		indexFile.close();
+
+		if (!indexFile)
+		{
+			LOG_ERROR("Failed to write line index '" << indexPath << "'!");
+			return false;
+		}
+
+		return true;
+	}
+
+	bool LineIndex::Update()
+	{
+		if (filePath.empty()) return false;
+
+		//the old mapping already shows the new contents and may reach past a truncated end,
+		//so only the fingerprint taken at scan time is compared against the new mapping
+		uint64_t previousSize = indexedSize;
+		uint64_t previousFingerprint = fingerprint;
+
+		if (!file.Open(filePath))
+		{
+			LOG_ERROR("Failed to remap '" << filePath << "' for line indexing!");
+			return false;
+		}
+
+		//anything other than an append means the old offsets cannot be trusted
+		if (file.GetSize() < previousSize
+			|| HashRegion(previousSize) != previousFingerprint)
+		{
+			return Build(filePath, 1, stride);
+		}
+
+		return ScanAppended(previousSize);
+	}
+
+	bool LineIndex::ScanAppended(uint64_t previousSize)
+	{
+		uint64_t size = file.GetSize();
+		if (size == previousSize) return true;
+
+		newlineCount += ScanNewlines(file.GetData(), previousSize, size, newlineCount, stride, &checkpoints);
+		indexedSize = size;
+		fingerprint = HashRegion(indexedSize);
+
+		return true;
+	}
+
+	void LineIndex::Close()
+	{
+		file.Close();
+		filePath.clear();
+		checkpoints.clear();
+		newlineCount = 0;
+		indexedSize = 0;
+		fingerprint = 0;
+	}
+
+	uint64_t LineIndex::GetLineCount() const
+	{
+		if (indexedSize == 0) return 0;
+
+		//a last line without a trailing newline still counts
+		bool endsWithNewline = file.GetData()[indexedSize - 1] == '\n';
+		return newlineCount + (endsWithNewline ? 0 : 1);
+	}
+
+	bool LineIndex::GetLineOffset(uint64_t line, uint64_t& outOffset) const
+	{
+		if (line >= GetLineCount()) return false;
+
+		uint64_t checkpoint = checkpoints[line / stride];
+		outOffset = SkipNewlines(file.GetData(), checkpoint, indexedSize, line % stride);
+		return true;
+	}
+
+	string_view LineIndex::GetLine(uint64_t line) const
+	{
+		uint64_t offset = 0;
+		if (!GetLineOffset(line, offset)) return {};
+
+		const char* data = file.GetData();
+		const char* start = data + offset;
+		const char* newline = static_cast<const char*>(memchr(start, '\n', indexedSize - offset));
+		size_t length = newline
+			? static_cast<size_t>(newline - start)
+			: static_cast<size_t>(indexedSize - offset);
+
+		//strip the carriage return of windows line endings
+		if (length > 0 && start[length - 1] == '\r') length--;
+
+		return string_view(start, length);
+	}
+
+	string LineIndex::GetIndexPath(const string& filePath)
+	{
+		return filePath + ".lidx";
+	}
+
+	uint64_t LineIndex::HashRegion(uint64_t end) const
+	{
+		if (!file.IsOpen() || end > file.GetSize()) return 0;
+
+		const char* data = file.GetData();
+		uint64_t headSize = end < fingerprintRegion ? end : fingerprintRegion;
+		uint64_t tailStart = end - headSize;
+
+		uint64_t hash = HashBytes(data, headSize, 14695981039346656037ull);
+		hash = HashBytes(data + tailStart, headSize, hash);
+		return hash ^ end;
+	}
+}
@@ -0,0 +1,1581 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+//main log macro
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_LOGGER", level, msg)
+
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <iterator>
+#include <streambuf>
+#include <exception>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/uio.h>
+#endif
+
+#include "logger.hpp"
+
+using std::thread;
+using std::mutex;
+using std::lock_guard;
+using std::unique_lock;
+using std::condition_variable;
+using std::atomic;
+using std::atomic_flag;
+using std::once_flag;
+using std::call_once;
+using std::vector;
+using std::unordered_map;
+using std::ifstream;
+using std::ofstream;
+using std::istreambuf_iterator;
+using std::streambuf;
+using std::streamsize;
+using std::terminate_handler;
+using std::set_terminate;
+using std::min;
+using std::to_string;
+using std::memory_order_relaxed;
+using std::memory_order_acquire;
+using std::memory_order_release;
+using std::memory_order_seq_cst;
+using std::atomic_thread_fence;
+using std::chrono::milliseconds;
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+using std::chrono::duration_cast;
+using std::chrono::steady_clock;
+using std::this_thread::yield;
+using std::this_thread::sleep_for;
+
+namespace KalaKit
+{
+	namespace
+	{
+#ifdef _WIN32
+		using SinkHandle = HANDLE;
+		const SinkHandle invalidSink = INVALID_HANDLE_VALUE;
+
+		//same layout as iovec so batches are built the same way on every platform
+		struct LogSegment
+		{
+			void* iov_base;
+			size_t iov_len;
+		};
+		constexpr int maxSegments = 1024;
+#else
+		using SinkHandle = int;
+		constexpr SinkHandle invalidSink = -1;
+
+		using LogSegment = iovec;
+		constexpr int maxSegments = IOV_MAX < 1024 ? IOV_MAX : 1024;
+#endif
+
+		//every ring entry and every entry of a binary log starts with this, on an 8 byte boundary
+		struct LogRecordHeader
+		{
+			//header and payload, without the padding up to the next record
+			uint32_t size;
+			uint32_t formatId;
+		};
+
+		//a line that was already formatted by LogLine or Write
+		constexpr uint32_t textFormatId = 0;
+		//fills the end of the ring when the next record does not fit before it
+		constexpr uint32_t paddingFormatId = 0xFFFFFFFF;
+		//binary logs only, describes a format before its first record
+		constexpr uint32_t descriptorFormatId = 0xFFFFFFFE;
+
+		constexpr size_t maxRecordSize = Logger::ringCapacity / 4;
+		//formatted lines the writer collects before one batch is written
+		constexpr size_t scratchCapacity = 65536;
+
+		constexpr char binaryLogMagic[8] = { 'K', 'A', 'L', 'A', 'L', 'O', 'G', '1' };
+
+		constexpr size_t AlignRecord(size_t size)
+		{
+			return (size + 7) & ~static_cast<size_t>(7);
+		}
+
+		//single producer single consumer ring of records, same index scheme as SpscQueue.
+		//records never wrap around the end, so each one is contiguous
+		struct LogRing
+		{
+			//writer thread side
+			alignas(64) atomic<uint64_t> head{ 0 };
+
+			//owning thread side
+			alignas(64) atomic<uint64_t> tail{ 0 };
+			uint64_t cachedHead = 0;
+			//set once the owning thread has exited, the ring is freed after it is drained
+			atomic<bool> isClosed{ false };
+
+			alignas(64) char bytes[Logger::ringCapacity];
+		};
+
+		struct LogFormatDescriptor
+		{
+			string module;
+			string type;
+			string format;
+			vector<LogArgumentType> argumentTypes;
+		};
+
+		struct PendingHead
+		{
+			LogRing* ring;
+			uint64_t head;
+		};
+
+		struct LoggerState
+		{
+			mutex ringsMutex;
+			vector<LogRing*> rings;
+
+			once_flag startFlag;
+			thread writer;
+			atomic<bool> isRunning{ false };
+			atomic<bool> isStopped{ false };
+
+			mutex wakeMutex;
+			condition_variable wakeCondition;
+			atomic<bool> isWriterSleeping{ false };
+
+			//format ids start from 1, index is id - 1
+			mutex formatsMutex;
+			vector<LogFormatDescriptor> formats;
+
+			//held by whoever is writing rings to the sinks, everything below is only used under it
+			atomic_flag drainLock = ATOMIC_FLAG_INIT;
+			//finished DrainAll passes, Flush waits on this
+			atomic<uint64_t> drainPassCount{ 0 };
+			vector<LogRing*> drainRings;
+			vector<LogSegment> segments;
+			vector<PendingHead> pendingHeads;
+			//formatted lines and descriptors of the current batch, never grows past its capacity
+			string scratch;
+			string line;
+			vector<LogFormatDescriptor> writerFormats;
+			vector<uint8_t> isDescriptorWritten;
+
+			//only used by the crash handler, which may not allocate or lock
+			char crashText[scratchCapacity];
+			LogSegment crashSegments[maxSegments];
+
+			mutex sinkMutex;
+			atomic<bool> isConsoleEnabled{ true };
+			SinkHandle fileSink = invalidSink;
+			atomic<bool> isBinary{ false };
+			SinkHandle binarySink = invalidSink;
+
+			atomic<LogOverflowPolicy> policy{ LogOverflowPolicy::LOG_OVERFLOW_BLOCK };
+			atomic<uint64_t> droppedCount{ 0 };
+			uint64_t reportedDropCount = 0;
+		};
+
+		//never destroyed, so lines logged from static destructors still have somewhere to go
+		LoggerState& GetState()
+		{
+			static LoggerState* state = new LoggerState();
+			return *state;
+		}
+
+		void LockDrain(LoggerState& state)
+		{
+			while (state.drainLock.test_and_set(memory_order_acquire))
+			{
+				yield();
+			}
+		}
+
+		//
+		// FORMATTING
+		//
+
+		bool ReadBytes(const char*& data, const char* end, void* out, size_t size)
+		{
+			if (static_cast<size_t>(end - data) < size) return false;
+
+			memcpy(out, data, size);
+			data += size;
+			return true;
+		}
+
+		//fixed size output for the crash handler, anything past the capacity is cut off
+		struct FixedBuffer
+		{
+			char* data;
+			size_t capacity;
+			size_t size = 0;
+			bool isTruncated = false;
+
+			void append(const char* text, size_t count)
+			{
+				if (count > capacity - size)
+				{
+					count = capacity - size;
+					isTruncated = true;
+				}
+				memcpy(data + size, text, count);
+				size += count;
+			}
+			void push_back(char character)
+			{
+				append(&character, 1);
+			}
+		};
+
+		template <typename Output>
+		void AppendText(Output& out, string_view text)
+		{
+			out.append(text.data(), text.size());
+		}
+
+		template <typename Output, typename Value>
+		void AppendFormatted(Output& out, const char* format, Value value)
+		{
+			char text[32]{};
+			int length = snprintf(text, sizeof(text), format, value);
+			if (length > 0) out.append(text, min(static_cast<size_t>(length), sizeof(text) - 1));
+		}
+
+		//turns the arguments of a format record back into text, the payload may come
+		//from a file so every read is checked. Nothing but the output may allocate,
+		//so the crash handler formats into a FixedBuffer with it
+		template <typename Output>
+		void FormatRecord(
+			const LogFormatDescriptor& descriptor,
+			const char* payload,
+			size_t payloadSize,
+			Output& out,
+			bool includeTimestamp,
+			uint64_t timestampOrigin)
+		{
+			const char* data = payload;
+			const char* end = payload + payloadSize;
+
+			uint64_t timestamp = 0;
+			ReadBytes(data, end, &timestamp, sizeof(timestamp));
+
+			if (includeTimestamp)
+			{
+				//signed, a record written before the origin prints a negative time instead of wrapping
+				int64_t relative = static_cast<int64_t>(timestamp - timestampOrigin);
+				AppendFormatted(out, "[%.6f] ", static_cast<double>(relative) / 1e9);
+			}
+
+			AppendText(out, "[");
+			AppendText(out, descriptor.module);
+			AppendText(out, " | ");
+			AppendText(out, descriptor.type);
+			AppendText(out, "] ");
+
+			size_t argument = 0;
+			const string& format = descriptor.format;
+			for (size_t i = 0; i < format.size(); i++)
+			{
+				if (format[i] != '{'
+					|| i + 1 == format.size()
+					|| format[i + 1] != '}'
+					|| argument == descriptor.argumentTypes.size())
+				{
+					out.push_back(format[i]);
+					continue;
+				}
+				i++;
+
+				LogArgumentType type = descriptor.argumentTypes[argument++];
+				if (type == LogArgumentType::ARG_STRING)
+				{
+					uint32_t size = 0;
+					if (!ReadBytes(data, end, &size, sizeof(size))
+						|| static_cast<size_t>(end - data) < size)
+					{
+						break;
+					}
+
+					out.append(data, size);
+					data += size;
+					continue;
+				}
+
+				uint64_t bits = 0;
+				if (!ReadBytes(data, end, &bits, sizeof(bits))) break;
+
+				switch (type)
+				{
+				case LogArgumentType::ARG_INT:
+					AppendFormatted(out, "%lld", static_cast<long long>(bits));
+					break;
+				case LogArgumentType::ARG_UINT:
+					AppendFormatted(out, "%llu", static_cast<unsigned long long>(bits));
+					break;
+				case LogArgumentType::ARG_FLOAT:
+				{
+					//same digits as the default stream output
+					double value = 0.0;
+					memcpy(&value, &bits, sizeof(value));
+					AppendFormatted(out, "%g", value);
+					break;
+				}
+				case LogArgumentType::ARG_BOOL:
+					AppendText(out, bits != 0 ? "true" : "false");
+					break;
+				case LogArgumentType::ARG_POINTER:
+					AppendFormatted(out, "0x%llx", static_cast<unsigned long long>(bits));
+					break;
+				case LogArgumentType::ARG_STRING:
+					break;
+				}
+			}
+
+			out.push_back('\n');
+		}
+
+		//binary log entry that lets the decoder format the records of one format id
+		template <typename Output>
+		void AppendDescriptor(Output& out, uint32_t formatId, const LogFormatDescriptor& descriptor)
+		{
+			uint32_t argumentCount = static_cast<uint32_t>(descriptor.argumentTypes.size());
+
+			LogRecordHeader header =
+			{
+				static_cast<uint32_t>(
+					sizeof(LogRecordHeader)
+					+ sizeof(formatId)
+					+ sizeof(argumentCount)
+					+ descriptor.argumentTypes.size()
+					+ descriptor.module.size() + 1
+					+ descriptor.type.size() + 1
+					+ descriptor.format.size() + 1),
+				descriptorFormatId
+			};
+			out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+			out.append(reinterpret_cast<const char*>(&formatId), sizeof(formatId));
+			out.append(reinterpret_cast<const char*>(&argumentCount), sizeof(argumentCount));
+			out.append(
+				reinterpret_cast<const char*>(descriptor.argumentTypes.data()),
+				descriptor.argumentTypes.size());
+
+			const string* fields[3] = { &descriptor.module, &descriptor.type, &descriptor.format };
+			for (const string* field : fields)
+			{
+				out.append(field->data(), field->size());
+				out.push_back('\0');
+			}
+
+			for (size_t i = header.size; i < AlignRecord(header.size); i++)
+			{
+				out.push_back('\0');
+			}
+		}
+
+		bool ParseDescriptor(const char* payload, size_t payloadSize, uint32_t& outId, LogFormatDescriptor& outDescriptor)
+		{
+			const char* data = payload;
+			const char* end = payload + payloadSize;
+
+			uint32_t argumentCount = 0;
+			if (!ReadBytes(data, end, &outId, sizeof(outId))
+				|| !ReadBytes(data, end, &argumentCount, sizeof(argumentCount))
+				|| static_cast<size_t>(end - data) < argumentCount)
+			{
+				return false;
+			}
+
+			outDescriptor.argumentTypes.resize(argumentCount);
+			memcpy(outDescriptor.argumentTypes.data(), data, argumentCount);
+			data += argumentCount;
+
+			string* fields[3] = { &outDescriptor.module, &outDescriptor.type, &outDescriptor.format };
+			for (string* field : fields)
+			{
+				const char* terminator = static_cast<const char*>(memchr(data, '\0', static_cast<size_t>(end - data)));
+				if (terminator == nullptr) return false;
+
+				field->assign(data, terminator);
+				data = terminator + 1;
+			}
+
+			return true;
+		}
+
+		//
+		// SINKS
+		//
+
+#ifdef _WIN32
+		SinkHandle GetConsoleSink()
+		{
+			return GetStdHandle(STD_OUTPUT_HANDLE);
+		}
+
+		SinkHandle OpenFileSink(const string& filePath, bool isAppending)
+		{
+			return CreateFileA(
+				filePath.c_str(),
+				isAppending ? FILE_APPEND_DATA : GENERIC_WRITE,
+				FILE_SHARE_READ,
+				nullptr,
+				isAppending ? OPEN_ALWAYS : CREATE_ALWAYS,
+				FILE_ATTRIBUTE_NORMAL,
+				nullptr);
+		}
+
+		void CloseFileSink(SinkHandle sink)
+		{
+			CloseHandle(sink);
+		}
+
+		void WriteSegments(SinkHandle sink, const LogSegment* segments, int count)
+		{
+			//no gather write for console and file handles on Windows
+			for (int i = 0; i < count; i++)
+			{
+				DWORD written = 0;
+				WriteFile(
+					sink,
+					segments[i].iov_base,
+					static_cast<DWORD>(segments[i].iov_len),
+					&written,
+					nullptr);
+			}
+		}
+#else
+		SinkHandle GetConsoleSink()
+		{
+			return STDOUT_FILENO;
+		}
+
+		SinkHandle OpenFileSink(const string& filePath, bool isAppending)
+		{
+			return open(
+				filePath.c_str(),
+				O_WRONLY | O_CREAT | O_CLOEXEC | (isAppending ? O_APPEND : O_TRUNC),
+				0644);
+		}
+
+		void CloseFileSink(SinkHandle sink)
+		{
+			close(sink);
+		}
+
+		//only calls write system calls, so it is also used from the crash handler
+		void WriteSegments(SinkHandle sink, const LogSegment* segments, int count)
+		{
+			LogSegment remaining[maxSegments];
+			memcpy(remaining, segments, sizeof(LogSegment) * static_cast<size_t>(count));
+
+			LogSegment* current = remaining;
+			while (count > 0)
+			{
+				ssize_t written = writev(sink, current, count);
+				if (written < 0)
+				{
+					if (errno == EINTR) continue;
+					return;
+				}
+
+				//skip the fully written segments and trim a partly written one
+				size_t left = static_cast<size_t>(written);
+				while (count > 0
+					&& left >= current->iov_len)
+				{
+					left -= current->iov_len;
+					current++;
+					count--;
+				}
+				if (count > 0)
+				{
+					current->iov_base = static_cast<char*>(current->iov_base) + left;
+					current->iov_len -= left;
+				}
+			}
+		}
+#endif
+
+		void WriteToSinks(LoggerState& state, const LogSegment* segments, int count, bool isBinary)
+		{
+			if (count == 0) return;
+
+			if (isBinary)
+			{
+				if (state.binarySink != invalidSink) WriteSegments(state.binarySink, segments, count);
+				return;
+			}
+
+			if (state.isConsoleEnabled.load(memory_order_relaxed))
+			{
+				WriteSegments(GetConsoleSink(), segments, count);
+			}
+			if (state.fileSink != invalidSink)
+			{
+				WriteSegments(state.fileSink, segments, count);
+			}
+		}
+
+		void WriteDirect(LoggerState& state, string_view line)
+		{
+			LogSegment segment{};
+			segment.iov_base = const_cast<char*>(line.data());
+			segment.iov_len = line.size();
+
+			lock_guard<mutex> lock(state.sinkMutex);
+			WriteToSinks(state, &segment, 1, false);
+		}
+
+		//
+		// WRITER
+		//
+
+		const LogFormatDescriptor* GetWriterFormat(LoggerState& state, uint32_t formatId)
+		{
+			if (formatId == textFormatId) return nullptr;
+
+			//formats registered since the last lookup
+			if (formatId > state.writerFormats.size())
+			{
+				lock_guard<mutex> lock(state.formatsMutex);
+				for (size_t i = state.writerFormats.size(); i < state.formats.size(); i++)
+				{
+					state.writerFormats.push_back(state.formats[i]);
+				}
+				state.isDescriptorWritten.resize(state.writerFormats.size(), 0);
+			}
+
+			return formatId <= state.writerFormats.size()
+				? &state.writerFormats[formatId - 1]
+				: nullptr;
+		}
+
+		//writes the collected segments and hands the drained space back to the owning threads
+		void FlushBatch(LoggerState& state)
+		{
+			bool isBinary = state.isBinary.load(memory_order_relaxed);
+			int count = static_cast<int>(state.segments.size());
+
+			if (count != 0)
+			{
+				lock_guard<mutex> lock(state.sinkMutex);
+				WriteToSinks(state, state.segments.data(), count, isBinary);
+			}
+
+			for (const PendingHead& pending : state.pendingHeads)
+			{
+				pending.ring->head.store(pending.head, memory_order_release);
+			}
+
+			state.segments.clear();
+			state.pendingHeads.clear();
+			state.scratch.clear();
+		}
+
+		//adds text to the scratch buffer of the batch, flushing first if it would not fit
+		void AddScratchSegment(LoggerState& state, LogRing* ring, uint64_t head, string_view text)
+		{
+			text = text.substr(0, scratchCapacity);
+			if (state.scratch.size() + text.size() > scratchCapacity
+				|| state.segments.size() == static_cast<size_t>(maxSegments))
+			{
+				state.pendingHeads.push_back({ ring, head });
+				FlushBatch(state);
+			}
+
+			//stays within the reserved capacity, so earlier segments keep pointing at valid text
+			size_t offset = state.scratch.size();
+			state.scratch.append(text);
+			state.segments.push_back({ state.scratch.data() + offset, text.size() });
+		}
+
+		void AddRingSegment(LoggerState& state, LogRing* ring, uint64_t head, const char* data, size_t size)
+		{
+			if (state.segments.size() == static_cast<size_t>(maxSegments))
+			{
+				state.pendingHeads.push_back({ ring, head });
+				FlushBatch(state);
+			}
+
+			state.segments.push_back({ const_cast<char*>(data), size });
+		}
+
+		//adds every record queued in the ring to the batch, returns true if there were any
+		bool DrainRing(LoggerState& state, LogRing* ring)
+		{
+			uint64_t head = ring->head.load(memory_order_relaxed);
+			uint64_t tail = ring->tail.load(memory_order_acquire);
+			if (head == tail) return false;
+
+			bool isBinary = state.isBinary.load(memory_order_relaxed);
+
+			while (head != tail)
+			{
+				const char* record = ring->bytes + head % Logger::ringCapacity;
+
+				LogRecordHeader header{};
+				memcpy(&header, record, sizeof(header));
+
+				if (header.formatId == paddingFormatId)
+				{
+					head += header.size;
+					continue;
+				}
+
+				const char* payload = record + sizeof(header);
+				size_t payloadSize = header.size - sizeof(header);
+				const LogFormatDescriptor* descriptor = GetWriterFormat(state, header.formatId);
+
+				if (isBinary)
+				{
+					//the decoder needs the descriptor before the first record of a format
+					if (descriptor != nullptr
+						&& !state.isDescriptorWritten[header.formatId - 1])
+					{
+						state.line.clear();
+						AppendDescriptor(state.line, header.formatId, *descriptor);
+						AddScratchSegment(state, ring, head, state.line);
+						state.isDescriptorWritten[header.formatId - 1] = 1;
+					}
+
+					AddRingSegment(state, ring, head, record, AlignRecord(header.size));
+				}
+				else if (descriptor == nullptr)
+				{
+					AddRingSegment(state, ring, head, payload, payloadSize);
+				}
+				else
+				{
+					state.line.clear();
+					FormatRecord(*descriptor, payload, payloadSize, state.line, false, 0);
+					AddScratchSegment(state, ring, head, state.line);
+				}
+
+				head += AlignRecord(header.size);
+			}
+
+			state.pendingHeads.push_back({ ring, head });
+			return true;
+		}
+
+		void ReportDroppedLines(LoggerState& state)
+		{
+			uint64_t dropped = state.droppedCount.load(memory_order_relaxed);
+			if (dropped == state.reportedDropCount) return;
+
+			string line =
+				"[KALAKIT_LOGGER | WARNING] "
+				+ to_string(dropped - state.reportedDropCount)
+				+ " log lines were dropped because the log buffer was full\n";
+			state.reportedDropCount = dropped;
+
+			WriteDirect(state, line);
+		}
+
+		//one pass over every ring, frees the rings of exited threads once they are empty
+		bool DrainAll(LoggerState& state)
+		{
+			LockDrain(state);
+
+			{
+				lock_guard<mutex> lock(state.ringsMutex);
+				state.drainRings = state.rings;
+			}
+
+			bool hasWritten = false;
+			for (LogRing* ring : state.drainRings)
+			{
+				if (DrainRing(state, ring)) hasWritten = true;
+			}
+			FlushBatch(state);
+
+			{
+				lock_guard<mutex> lock(state.ringsMutex);
+				for (size_t i = 0; i < state.rings.size();)
+				{
+					LogRing* ring = state.rings[i];
+					if (ring->isClosed.load(memory_order_acquire)
+						&& ring->head.load(memory_order_relaxed) == ring->tail.load(memory_order_acquire))
+					{
+						delete ring;
+						state.rings[i] = state.rings.back();
+						state.rings.pop_back();
+						continue;
+					}
+					i++;
+				}
+			}
+
+			ReportDroppedLines(state);
+
+			state.drainPassCount.fetch_add(1, memory_order_release);
+			state.drainLock.clear(memory_order_release);
+			return hasWritten;
+		}
+
+		void RunWriter()
+		{
+			LoggerState& state = GetState();
+
+			while (state.isRunning.load(memory_order_acquire))
+			{
+				if (DrainAll(state)) continue;
+
+				unique_lock<mutex> lock(state.wakeMutex);
+				state.isWriterSleeping.store(true, memory_order_seq_cst);
+
+				//a line may have been queued after the drain above, check once more before sleeping.
+				//the timeout only matters if a wake up is missed
+				if (!DrainAll(state)
+					&& state.isRunning.load(memory_order_acquire))
+				{
+					state.wakeCondition.wait_for(lock, milliseconds(100));
+				}
+
+				state.isWriterSleeping.store(false, memory_order_relaxed);
+			}
+
+			DrainAll(state);
+		}
+
+		void WakeWriter(LoggerState& state)
+		{
+			atomic_thread_fence(memory_order_seq_cst);
+			if (!state.isWriterSleeping.load(memory_order_relaxed)) return;
+
+			lock_guard<mutex> lock(state.wakeMutex);
+			state.wakeCondition.notify_one();
+		}
+
+		void StartWriter()
+		{
+			LoggerState& state = GetState();
+
+			//segments point into scratch, so it is reserved once and never reallocates
+			state.segments.reserve(static_cast<size_t>(maxSegments));
+			state.pendingHeads.reserve(64);
+			state.scratch.reserve(scratchCapacity);
+			state.line.reserve(1024);
+
+			state.isRunning.store(true, memory_order_release);
+			state.writer = thread(RunWriter);
+		}
+
+		//
+		// PRODUCERS
+		//
+
+		//appends everything streamed into a log line to the formatting buffer of the thread
+		class LineBuffer : public streambuf
+		{
+		public:
+			string text;
+		protected:
+			int_type overflow(int_type character) override
+			{
+				if (character != traits_type::eof()) text.push_back(static_cast<char>(character));
+				return character;
+			}
+			streamsize xsputn(const char* data, streamsize count) override
+			{
+				text.append(data, static_cast<size_t>(count));
+				return count;
+			}
+		};
+
+		struct ThreadLog
+		{
+			LogRing* ring = nullptr;
+			LineBuffer buffer{};
+			ostream stream{ &buffer };
+
+			//tail after the record between BeginRecord and CommitRecord
+			uint64_t pendingTail = 0;
+			//set when there is no ring to queue into, the record is then built here and written directly
+			bool isDirectRecord = false;
+			string directRecord;
+		};
+
+		thread_local ThreadLog* threadLog = nullptr;
+		thread_local bool isThreadExiting = false;
+
+		//closes the ring of the thread when it exits, the writer frees it after the last line
+		struct ThreadLogOwner
+		{
+			~ThreadLogOwner()
+			{
+				isThreadExiting = true;
+				if (threadLog == nullptr) return;
+
+				if (threadLog->ring != nullptr)
+				{
+					threadLog->ring->isClosed.store(true, memory_order_release);
+					WakeWriter(GetState());
+				}
+
+				delete threadLog;
+				threadLog = nullptr;
+			}
+		};
+		thread_local ThreadLogOwner threadLogOwner;
+
+		ThreadLog& GetThreadLog()
+		{
+			if (threadLog == nullptr)
+			{
+				threadLog = new ThreadLog();
+
+				//touching the owner registers its destructor for this thread
+				if (!isThreadExiting) (void)&threadLogOwner;
+			}
+			return *threadLog;
+		}
+
+		LogRing* GetThreadRing(LoggerState& state, ThreadLog& log)
+		{
+			if (log.ring == nullptr)
+			{
+				log.ring = new LogRing();
+
+				lock_guard<mutex> lock(state.ringsMutex);
+				state.rings.push_back(log.ring);
+			}
+			return log.ring;
+		}
+
+		//
+		// CRASH HANDLING
+		//
+
+		terminate_handler previousTerminateHandler = nullptr;
+
+		//batch of the crash handler, built in the preallocated crash buffers of the state
+		struct CrashBatch
+		{
+			LoggerState& state;
+			bool isBinary;
+			size_t textSize = 0;
+			int count = 0;
+
+			void Flush()
+			{
+				//the crashed thread may hold the sink mutex
+				WriteToSinks(state, state.crashSegments, count, isBinary);
+				textSize = 0;
+				count = 0;
+			}
+
+			void AddSegment(const char* data, size_t size)
+			{
+				if (count == maxSegments) Flush();
+				state.crashSegments[count++] = { const_cast<char*>(data), size };
+			}
+
+			//runs write on the free part of the text buffer, text that does not fit
+			//is written again after a flush and then cut off only if isCutAllowed
+			template <typename Writer>
+			bool AddText(const Writer& write, bool isCutAllowed)
+			{
+				if (count == maxSegments) Flush();
+
+				FixedBuffer out{ state.crashText + textSize, scratchCapacity - textSize };
+				write(out);
+				if (out.isTruncated
+					&& textSize != 0)
+				{
+					Flush();
+					out = FixedBuffer{ state.crashText, scratchCapacity };
+					write(out);
+				}
+				if (out.isTruncated
+					&& !isCutAllowed)
+				{
+					return false;
+				}
+
+				state.crashSegments[count++] = { out.data, out.size };
+				textSize += out.size;
+				return true;
+			}
+		};
+
+		//same output as DrainRing, but formats only come from the writer snapshot since the
+		//registry needs its mutex, records of formats registered after it are skipped
+		void DrainRingOnCrash(CrashBatch& batch, LogRing* ring)
+		{
+			LoggerState& state = batch.state;
+			uint64_t head = ring->head.load(memory_order_relaxed);
+			uint64_t tail = ring->tail.load(memory_order_acquire);
+
+			while (head != tail)
+			{
+				const char* record = ring->bytes + head % Logger::ringCapacity;
+
+				LogRecordHeader header{};
+				memcpy(&header, record, sizeof(header));
+
+				if (header.formatId == paddingFormatId)
+				{
+					head += header.size;
+					continue;
+				}
+				head += AlignRecord(header.size);
+
+				const char* payload = record + sizeof(header);
+				size_t payloadSize = header.size - sizeof(header);
+
+				if (header.formatId == textFormatId)
+				{
+					if (batch.isBinary) batch.AddSegment(record, AlignRecord(header.size));
+					else batch.AddSegment(payload, payloadSize);
+					continue;
+				}
+				if (header.formatId > state.writerFormats.size()) continue;
+
+				uint32_t formatId = header.formatId;
+				const LogFormatDescriptor& descriptor = state.writerFormats[formatId - 1];
+
+				if (batch.isBinary)
+				{
+					if (!state.isDescriptorWritten[formatId - 1])
+					{
+						bool isAdded = batch.AddText(
+							[&](FixedBuffer& out) { AppendDescriptor(out, formatId, descriptor); },
+							false);
+						if (!isAdded) continue;
+
+						state.isDescriptorWritten[formatId - 1] = 1;
+					}
+					batch.AddSegment(record, AlignRecord(header.size));
+				}
+				else
+				{
+					batch.AddText(
+						[&](FixedBuffer& out) { FormatRecord(descriptor, payload, payloadSize, out, false, 0); },
+						true);
+				}
+			}
+		}
+
+		//best effort, other threads may still be running and the heap may be broken,
+		//so nothing here allocates or locks a mutex
+		void FlushOnCrash()
+		{
+			LoggerState& state = GetState();
+
+			//give the writer thread a moment to finish its current batch. If it still holds
+			//the drain lock its rings and formats are in use and nothing can be written safely
+			bool isLocked = false;
+			for (int i = 0; i < 100000 && !isLocked; i++)
+			{
+				isLocked = !state.drainLock.test_and_set(memory_order_acquire);
+			}
+			if (!isLocked) return;
+
+			CrashBatch batch{ state, state.isBinary.load(memory_order_relaxed) };
+
+			//the rings vector is read without its mutex, the crashed thread may hold it
+			for (LogRing* ring : state.rings)
+			{
+				DrainRingOnCrash(batch, ring);
+			}
+			batch.Flush();
+		}
+
+		void OnCrashSignal(int signalNumber)
+		{
+			FlushOnCrash();
+
+			//let the default action end the program and produce the core dump
+			signal(signalNumber, SIG_DFL);
+			raise(signalNumber);
+		}
+
+		void OnTerminate()
+		{
+			FlushOnCrash();
+
+			if (previousTerminateHandler != nullptr) previousTerminateHandler();
+			abort();
+		}
+
+#ifdef _WIN32
+		LONG WINAPI OnUnhandledException(EXCEPTION_POINTERS* exception)
+		{
+			(void)exception;
+
+			FlushOnCrash();
+			return EXCEPTION_CONTINUE_SEARCH;
+		}
+#endif
+
+		//stops the writer after main returns and writes what is left
+		struct LoggerExitFlusher
+		{
+			~LoggerExitFlusher()
+			{
+				Logger::Shutdown();
+			}
+		};
+		LoggerExitFlusher exitFlusher{};
+
+		//channels are looked up once per call site, so a plain list is enough
+		struct ChannelRegistry
+		{
+			mutex channelsMutex;
+			vector<LogChannel*> channels;
+			atomic<LogLevel> defaultLevel{ LogLevel::LOG_LEVEL_DEBUG };
+		};
+
+		//never destroyed, call sites keep references to their channels
+		ChannelRegistry& GetChannelRegistry()
+		{
+			static ChannelRegistry* registry = new ChannelRegistry();
+			return *registry;
+		}
+	}
+
+	LogChannel& LogChannel::Get(string_view name)
+	{
+		ChannelRegistry& registry = GetChannelRegistry();
+
+		lock_guard<mutex> lock(registry.channelsMutex);
+		for (LogChannel* channel : registry.channels)
+		{
+			if (channel->name == name) return *channel;
+		}
+
+		LogChannel* channel = new LogChannel(name);
+		registry.channels.push_back(channel);
+		return *channel;
+	}
+
+	LogChannel::LogChannel(string_view newName)
+		: name(newName),
+		level(GetChannelRegistry().defaultLevel.load(memory_order_relaxed))
+	{
+	}
+
+	LogLevel LogChannel::GetDefaultLevel()
+	{
+		return GetChannelRegistry().defaultLevel.load(memory_order_relaxed);
+	}
+	void LogChannel::SetDefaultLevel(LogLevel newLevel)
+	{
+		ChannelRegistry& registry = GetChannelRegistry();
+
+		lock_guard<mutex> lock(registry.channelsMutex);
+		registry.defaultLevel.store(newLevel, memory_order_relaxed);
+		for (LogChannel* channel : registry.channels)
+		{
+			channel->SetLevel(newLevel);
+		}
+	}
+
+	void LogChannel::SetRateLimit(uint32_t linesPerSecond, uint32_t burstSize)
+	{
+		if (linesPerSecond == 0)
+		{
+			emissionInterval.store(0, memory_order_relaxed);
+			return;
+		}
+
+		uint64_t interval = 1000000000ull / linesPerSecond;
+		if (interval == 0) interval = 1;
+
+		burstTolerance.store(interval * (burstSize == 0 ? 1 : burstSize), memory_order_relaxed);
+		fullAt.store(0, memory_order_relaxed);
+		emissionInterval.store(interval, memory_order_relaxed);
+	}
+
+	bool LogChannel::TakeRateLimit()
+	{
+		uint64_t interval = emissionInterval.load(memory_order_relaxed);
+		uint64_t tolerance = burstTolerance.load(memory_order_relaxed);
+		uint64_t now = static_cast<uint64_t>(duration_cast<nanoseconds>(
+			steady_clock::now().time_since_epoch()).count());
+
+		//every line moves the time the bucket is full again one interval later,
+		//a line that would move it further than the burst allows is skipped
+		uint64_t full = fullAt.load(memory_order_relaxed);
+		uint64_t newFull = 0;
+		do
+		{
+			newFull = (full > now ? full : now) + interval;
+			if (newFull - now > tolerance)
+			{
+				suppressedCount.fetch_add(1, memory_order_relaxed);
+				unreportedCount.fetch_add(1, memory_order_relaxed);
+				return false;
+			}
+		} while (!fullAt.compare_exchange_weak(full, newFull, memory_order_relaxed));
+
+		uint64_t skipped = unreportedCount.exchange(0, memory_order_relaxed);
+		if (skipped != 0)
+		{
+			string line =
+				"[" + name + " | WARNING] "
+				+ to_string(skipped)
+				+ " log lines were skipped by the rate limit\n";
+			Logger::Write(line);
+		}
+
+		return true;
+	}
+
+	void Logger::Write(string_view line)
+	{
+		size_t size = min(line.size(), maxRecordSize - sizeof(LogRecordHeader));
+
+		char* out = BeginRecord(textFormatId, size);
+		if (out == nullptr) return;
+
+		memcpy(out, line.data(), size);
+		CommitRecord();
+	}
+
+	uint32_t Logger::RegisterFormat(
+		const char* module,
+		const char* type,
+		const char* format,
+		const LogArgumentType* argumentTypes,
+		uint32_t argumentCount)
+	{
+		LoggerState& state = GetState();
+
+		LogFormatDescriptor descriptor{};
+		descriptor.module = module;
+		descriptor.type = type;
+		descriptor.format = format;
+		descriptor.argumentTypes.assign(argumentTypes, argumentTypes + argumentCount);
+
+		lock_guard<mutex> lock(state.formatsMutex);
+		state.formats.push_back(descriptor);
+		return static_cast<uint32_t>(state.formats.size());
+	}
+
+	char* Logger::BeginRecord(uint32_t formatId, size_t payloadSize)
+	{
+		LoggerState& state = GetState();
+		size_t recordSize = sizeof(LogRecordHeader) + payloadSize;
+
+		if (recordSize > maxRecordSize)
+		{
+			state.droppedCount.fetch_add(1, memory_order_relaxed);
+			return nullptr;
+		}
+
+		//after shutdown and while this thread is being torn down there is no ring to queue into
+		if (state.isStopped.load(memory_order_acquire)
+			|| isThreadExiting)
+		{
+			ThreadLog& log = GetThreadLog();
+			LogRecordHeader header = { static_cast<uint32_t>(recordSize), formatId };
+
+			log.directRecord.resize(recordSize);
+			memcpy(log.directRecord.data(), &header, sizeof(header));
+			log.isDirectRecord = true;
+			return log.directRecord.data() + sizeof(header);
+		}
+
+		call_once(state.startFlag, StartWriter);
+
+		ThreadLog& log = GetThreadLog();
+		LogRing* ring = GetThreadRing(state, log);
+
+		uint64_t tail = ring->tail.load(memory_order_relaxed);
+		size_t offset = static_cast<size_t>(tail % ringCapacity);
+		size_t untilEnd = ringCapacity - offset;
+
+		//records never wrap, the rest of the ring is skipped if this one does not fit before the end
+		size_t alignedSize = AlignRecord(recordSize);
+		size_t neededSize = alignedSize + (untilEnd < alignedSize ? untilEnd : 0);
+
+		while (ringCapacity - (tail - ring->cachedHead) < neededSize)
+		{
+			ring->cachedHead = ring->head.load(memory_order_acquire);
+			if (ringCapacity - (tail - ring->cachedHead) >= neededSize) break;
+
+			if (state.policy.load(memory_order_relaxed) == LogOverflowPolicy::LOG_OVERFLOW_DROP)
+			{
+				state.droppedCount.fetch_add(1, memory_order_relaxed);
+				WakeWriter(state);
+				return nullptr;
+			}
+
+			//Shutdown stopped the writer while this thread was waiting for room
+			if (state.isStopped.load(memory_order_acquire))
+			{
+				state.droppedCount.fetch_add(1, memory_order_relaxed);
+				return nullptr;
+			}
+
+			WakeWriter(state);
+			yield();
+		}
+
+		if (untilEnd < alignedSize)
+		{
+			LogRecordHeader padding = { static_cast<uint32_t>(untilEnd), paddingFormatId };
+			memcpy(ring->bytes + offset, &padding, sizeof(padding));
+
+			tail += untilEnd;
+			offset = 0;
+		}
+
+		LogRecordHeader header = { static_cast<uint32_t>(recordSize), formatId };
+		memcpy(ring->bytes + offset, &header, sizeof(header));
+
+		log.pendingTail = tail + alignedSize;
+		return ring->bytes + offset + sizeof(header);
+	}
+
+	void Logger::CommitRecord()
+	{
+		LoggerState& state = GetState();
+		ThreadLog& log = GetThreadLog();
+
+		if (!log.isDirectRecord)
+		{
+			log.ring->tail.store(log.pendingTail, memory_order_release);
+			WakeWriter(state);
+			return;
+		}
+
+		log.isDirectRecord = false;
+
+		LogRecordHeader header{};
+		memcpy(&header, log.directRecord.data(), sizeof(header));
+
+		const char* payload = log.directRecord.data() + sizeof(header);
+		size_t payloadSize = header.size - sizeof(header);
+
+		if (header.formatId == textFormatId)
+		{
+			WriteDirect(state, string_view(payload, payloadSize));
+			return;
+		}
+
+		LogFormatDescriptor descriptor{};
+		{
+			lock_guard<mutex> lock(state.formatsMutex);
+			descriptor = state.formats[header.formatId - 1];
+		}
+
+		string line{};
+		FormatRecord(descriptor, payload, payloadSize, line, false, 0);
+		WriteDirect(state, line);
+	}
+
+	LogOverflowPolicy Logger::GetOverflowPolicy()
+	{
+		return GetState().policy.load(memory_order_relaxed);
+	}
+	void Logger::SetOverflowPolicy(LogOverflowPolicy newPolicy)
+	{
+		GetState().policy.store(newPolicy, memory_order_relaxed);
+	}
+	uint64_t Logger::GetDroppedCount()
+	{
+		return GetState().droppedCount.load(memory_order_relaxed);
+	}
+
+	void Logger::SetConsoleOutput(bool isEnabled)
+	{
+		GetState().isConsoleEnabled.store(isEnabled, memory_order_relaxed);
+	}
+	bool Logger::SetFileOutput(const string& filePath)
+	{
+		LoggerState& state = GetState();
+
+		//lines queued so far belong to the previous file
+		Flush();
+
+		SinkHandle newSink = invalidSink;
+		if (!filePath.empty())
+		{
+			newSink = OpenFileSink(filePath, true);
+			if (newSink == invalidSink)
+			{
+				LOG_ERROR("Failed to open log file '" << filePath << "'!");
+				return false;
+			}
+		}
+
+		lock_guard<mutex> lock(state.sinkMutex);
+		if (state.fileSink != invalidSink) CloseFileSink(state.fileSink);
+		state.fileSink = newSink;
+
+		return true;
+	}
+
+	bool Logger::SetBinaryOutput(const string& filePath)
+	{
+		LoggerState& state = GetState();
+
+		//lines queued so far still go to the previous output
+		Flush();
+
+		SinkHandle newSink = invalidSink;
+		if (!filePath.empty())
+		{
+			newSink = OpenFileSink(filePath, false);
+			if (newSink == invalidSink)
+			{
+				LOG_ERROR("Failed to open binary log file '" << filePath << "'!");
+				return false;
+			}
+
+			LogSegment magic{};
+			magic.iov_base = const_cast<char*>(binaryLogMagic);
+			magic.iov_len = sizeof(binaryLogMagic);
+			WriteSegments(newSink, &magic, 1);
+		}
+
+		//no batch may be half written when the output changes
+		LockDrain(state);
+		{
+			lock_guard<mutex> lock(state.sinkMutex);
+			if (state.binarySink != invalidSink) CloseFileSink(state.binarySink);
+			state.binarySink = newSink;
+
+			//a new file needs every descriptor again
+			state.isDescriptorWritten.assign(state.isDescriptorWritten.size(), 0);
+			state.isBinary.store(newSink != invalidSink, memory_order_relaxed);
+		}
+		state.drainLock.clear(memory_order_release);
+
+		return true;
+	}
+	bool Logger::IsBinaryOutput()
+	{
+		return GetState().isBinary.load(memory_order_relaxed);
+	}
+
+	bool Logger::DecodeBinaryLog(
+		const string& binaryLogPath,
+		const string& textLogPath,
+		bool includeTimestamps)
+	{
+		ifstream input(binaryLogPath, std::ios::binary);
+		if (!input)
+		{
+			LOG_ERROR("Failed to open binary log '" << binaryLogPath << "'!");
+			return false;
+		}
+		string data((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
+
+		if (data.size() < sizeof(binaryLogMagic)
+			|| memcmp(data.data(), binaryLogMagic, sizeof(binaryLogMagic)) != 0)
+		{
+			LOG_ERROR("File '" << binaryLogPath << "' is not a binary log!");
+			return false;
+		}
+
+		ofstream output(textLogPath, std::ios::binary | std::ios::trunc);
+		if (!output)
+		{
+			LOG_ERROR("Failed to open text log '" << textLogPath << "'!");
+			return false;
+		}
+
+		//keyed by id, the ids come from the file and may be sparse or damaged
+		unordered_map<uint32_t, LogFormatDescriptor> descriptors{};
+		string line{};
+
+		//rings are drained one thread at a time so records are not in timestamp order,
+		//times are printed from the earliest format record in the file
+		uint64_t timestampOrigin = UINT64_MAX;
+		for (size_t scan = sizeof(binaryLogMagic); data.size() - scan >= sizeof(LogRecordHeader);)
+		{
+			LogRecordHeader header{};
+			memcpy(&header, data.data() + scan, sizeof(header));
+			if (header.size < sizeof(header)
+				|| header.size > data.size() - scan)
+			{
+				break;
+			}
+
+			if (header.formatId != textFormatId
+				&& header.formatId != descriptorFormatId
+				&& header.formatId != paddingFormatId
+				&& header.size - sizeof(header) >= sizeof(uint64_t))
+			{
+				uint64_t timestamp = 0;
+				memcpy(&timestamp, data.data() + scan + sizeof(header), sizeof(timestamp));
+				timestampOrigin = min(timestampOrigin, timestamp);
+			}
+			scan += min(AlignRecord(header.size), data.size() - scan);
+		}
+		if (timestampOrigin == UINT64_MAX) timestampOrigin = 0;
+
+		size_t offset = sizeof(binaryLogMagic);
+		while (data.size() - offset >= sizeof(LogRecordHeader))
+		{
+			LogRecordHeader header{};
+			memcpy(&header, data.data() + offset, sizeof(header));
+
+			if (header.size < sizeof(header)
+				|| header.size > data.size() - offset)
+			{
+				LOG_ERROR("Binary log '" << binaryLogPath << "' is cut off or damaged at byte " << offset << "!");
+				return false;
+			}
+
+			const char* payload = data.data() + offset + sizeof(header);
+			size_t payloadSize = header.size - sizeof(header);
+			offset += min(AlignRecord(header.size), data.size() - offset);
+
+			if (header.formatId == descriptorFormatId)
+			{
+				uint32_t formatId = 0;
+				LogFormatDescriptor descriptor{};
+				if (!ParseDescriptor(payload, payloadSize, formatId, descriptor)
+					|| formatId == textFormatId
+					|| formatId >= descriptorFormatId)
+				{
+					continue;
+				}
+
+				descriptors[formatId] = std::move(descriptor);
+				continue;
+			}
+
+			if (header.formatId == textFormatId)
+			{
+				output.write(payload, static_cast<streamsize>(payloadSize));
+				continue;
+			}
+
+			auto found = descriptors.find(header.formatId);
+			if (found == descriptors.end()) continue;
+
+			line.clear();
+			FormatRecord(
+				found->second,
+				payload,
+				payloadSize,
+				line,
+				includeTimestamps,
+				timestampOrigin);
+			output.write(line.data(), static_cast<streamsize>(line.size()));
+		}
+
+		return true;
+	}
+
+	void Logger::Flush()
+	{
+		LoggerState& state = GetState();
+		if (!state.isRunning.load(memory_order_acquire)) return;
+
+		//the pass running right now may have missed the lines queued so far,
+		//the one after it started after them. rings are never touched here,
+		//the writer may free the ring of an exited thread at any time
+		uint64_t target = state.drainPassCount.load(memory_order_acquire) + 2;
+		while (state.drainPassCount.load(memory_order_acquire) < target)
+		{
+			if (!state.isRunning.load(memory_order_acquire)) return;
+
+			WakeWriter(state);
+			sleep_for(microseconds(50));
+		}
+	}
+
+	void Logger::Shutdown()
+	{
+		LoggerState& state = GetState();
+		if (state.isStopped.exchange(true)) return;
+
+		if (state.isRunning.exchange(false))
+		{
+			{
+				lock_guard<mutex> lock(state.wakeMutex);
+				state.wakeCondition.notify_one();
+			}
+			state.writer.join();
+		}
+
+		//lines queued while the writer was stopping
+		DrainAll(state);
+
+		lock_guard<mutex> lock(state.sinkMutex);
+		if (state.fileSink != invalidSink)
+		{
+			CloseFileSink(state.fileSink);
+			state.fileSink = invalidSink;
+		}
+		if (state.binarySink != invalidSink)
+		{
+			CloseFileSink(state.binarySink);
+			state.binarySink = invalidSink;
+			state.isBinary.store(false, memory_order_relaxed);
+		}
+	}
+
+	void Logger::InstallCrashHandler()
+	{
+		signal(SIGSEGV, OnCrashSignal);
+		signal(SIGABRT, OnCrashSignal);
+		signal(SIGFPE, OnCrashSignal);
+		signal(SIGILL, OnCrashSignal);
+#ifdef _WIN32
+		SetUnhandledExceptionFilter(OnUnhandledException);
+#else
+		signal(SIGBUS, OnCrashSignal);
+#endif
+
+		terminate_handler previous = set_terminate(OnTerminate);
+		if (previous != OnTerminate) previousTerminateHandler = previous;
+	}
+
+	LogLine::LogLine(const char* module, const char* type)
+	{
+		ThreadLog& log = GetThreadLog();
+		start = log.buffer.text.size();
+
+		//manipulators of the previous line do not carry over
+		log.stream.flags(std::ios_base::dec | std::ios_base::skipws);
+		log.stream.precision(6);
+		log.stream.fill(' ');
+
+		log.stream << "[" << module << " | " << type << "] ";
+	}
+
+	LogLine::~LogLine()
+	{
+		ThreadLog& log = GetThreadLog();
+		string& text = log.buffer.text;
+
+		text.push_back('\n');
+		Logger::Write(string_view(text).substr(start));
+		text.resize(start);
+	}
+
+	ostream& LogLine::Stream()
+	{
+		return GetThreadLog().stream;
+	}
+}
@@ -3,12 +3,723 @@
 //This is free software, and you are welcome to redistribute it under certain conditions.
 //Read LICENSE.md for more information.
 
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <bit>
+#include <cstring>
+#include <cstdlib>
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define OSUTILS_X86 1
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
 #include "osutils.hpp"
 
+using std::ifstream;
+using std::vector;
+using std::pair;
+using std::sort;
+using std::unique;
+using std::thread;
+using std::mutex;
+using std::lock_guard;
+using std::memory_order_relaxed;
+using std::chrono::steady_clock;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using std::popcount;
+using std::to_string;
+
 namespace KalaKit
 {
-	void OSUtils::DummyFunction()
+	namespace
+	{
+#ifdef OSUTILS_X86
+		struct CpuidResult
+		{
+			uint32_t eax;
+			uint32_t ebx;
+			uint32_t ecx;
+			uint32_t edx;
+		};
+
+		CpuidResult Cpuid(uint32_t leaf, uint32_t subleaf)
+		{
+			CpuidResult result{};
+#ifdef _MSC_VER
+			int registers[4]{};
+			__cpuidex(registers, static_cast<int>(leaf), static_cast<int>(subleaf));
+			result.eax = static_cast<uint32_t>(registers[0]);
+			result.ebx = static_cast<uint32_t>(registers[1]);
+			result.ecx = static_cast<uint32_t>(registers[2]);
+			result.edx = static_cast<uint32_t>(registers[3]);
+#else
+			__cpuid_count(leaf, subleaf, result.eax, result.ebx, result.ecx, result.edx);
+#endif
+			return result;
+		}
+
+		//register state the OS saves on context switches, only valid if OSXSAVE is set
+		uint64_t ReadXcr0()
+		{
+#ifdef _MSC_VER
+			return _xgetbv(0);
+#else
+			uint32_t eax = 0;
+			uint32_t edx = 0;
+			__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+			return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+		}
+
+		bool IsBitSet(uint32_t value, int bit)
+		{
+			return (value >> bit) & 1u;
+		}
+
+		void DetectFeatures(CpuInfo& info)
+		{
+			CpuidResult leaf0 = Cpuid(0, 0);
+			uint32_t maxLeaf = leaf0.eax;
+
+			char vendor[13]{};
+			memcpy(vendor, &leaf0.ebx, 4);
+			memcpy(vendor + 4, &leaf0.edx, 4);
+			memcpy(vendor + 8, &leaf0.ecx, 4);
+			info.vendor = vendor;
+
+			uint32_t maxExtendedLeaf = Cpuid(0x80000000, 0).eax;
+			if (maxExtendedLeaf >= 0x80000007)
+			{
+				info.hasInvariantTsc = IsBitSet(Cpuid(0x80000007, 0).edx, 8);
+			}
+
+			if (maxExtendedLeaf >= 0x80000004)
+			{
+				char brand[49]{};
+				for (uint32_t i = 0; i < 3; i++)
+				{
+					CpuidResult part = Cpuid(0x80000002 + i, 0);
+					memcpy(brand + i * 16, &part, 16);
+				}
+				info.brand = brand;
+
+				size_t first = info.brand.find_first_not_of(' ');
+				size_t last = info.brand.find_last_not_of(' ');
+				info.brand = first == string::npos
+					? string{}
+					: info.brand.substr(first, last - first + 1);
+			}
+
+			CpuidResult leaf1 = Cpuid(1, 0);
+			info.hasSse2 = IsBitSet(leaf1.edx, 26);
+			info.hasSse42 = IsBitSet(leaf1.ecx, 20);
+			info.hasPopcnt = IsBitSet(leaf1.ecx, 23);
+			info.cacheLineSize = ((leaf1.ebx >> 8) & 0xFF) * 8;
+
+			//AVX registers are only usable if the OS saves them
+			uint64_t xcr0 = IsBitSet(leaf1.ecx, 27) ? ReadXcr0() : 0;
+			bool isAvxEnabled = (xcr0 & 0x6) == 0x6;
+			bool isAvx512Enabled = (xcr0 & 0xE6) == 0xE6;
+
+			info.hasAvx = isAvxEnabled && IsBitSet(leaf1.ecx, 28);
+			info.hasFma = isAvxEnabled && IsBitSet(leaf1.ecx, 12);
+
+			if (maxLeaf >= 7)
+			{
+				CpuidResult leaf7 = Cpuid(7, 0);
+				info.hasBmi1 = IsBitSet(leaf7.ebx, 3);
+				info.hasBmi2 = IsBitSet(leaf7.ebx, 8);
+				info.hasAvx2 = isAvxEnabled && IsBitSet(leaf7.ebx, 5);
+				info.hasAvx512f = isAvx512Enabled && IsBitSet(leaf7.ebx, 16);
+				info.hasAvx512dq = isAvx512Enabled && IsBitSet(leaf7.ebx, 17);
+				info.hasAvx512bw = isAvx512Enabled && IsBitSet(leaf7.ebx, 30);
+				info.hasAvx512vl = isAvx512Enabled && IsBitSet(leaf7.ebx, 31);
+			}
+		}
+
+		//deterministic cache parameters, used when the OS does not report the caches
+		void DetectCachesWithCpuid(CpuInfo& info)
+		{
+			uint32_t leaf = 4;
+			if (info.vendor == "AuthenticAMD")
+			{
+				if (Cpuid(0x80000000, 0).eax < 0x8000001D) return;
+				leaf = 0x8000001D;
+			}
+			else if (Cpuid(0, 0).eax < 4) return;
+
+			for (uint32_t index = 0; index < 16; index++)
+			{
+				CpuidResult cache = Cpuid(leaf, index);
+
+				//1 data, 2 instruction, 3 unified, 0 no more caches
+				uint32_t type = cache.eax & 0x1F;
+				if (type == 0) break;
+				if (type == 2) continue;
+
+				uint32_t level = (cache.eax >> 5) & 0x7;
+				uint32_t size =
+					((cache.ebx >> 22) + 1)
+					* (((cache.ebx >> 12) & 0x3FF) + 1)
+					* ((cache.ebx & 0xFFF) + 1)
+					* (cache.ecx + 1);
+
+				if (level == 1 && info.l1DataCacheSize == 0) info.l1DataCacheSize = size;
+				else if (level == 2 && info.l2CacheSize == 0) info.l2CacheSize = size;
+				else if (level == 3 && info.l3CacheSize == 0) info.l3CacheSize = size;
+			}
+		}
+#endif
+
+#ifdef _WIN32
+		void DetectTopology(CpuInfo& info)
+		{
+			DWORD length = 0;
+			GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+			if (length == 0) return;
+
+			vector<char> buffer(length);
+			auto* first = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data());
+			if (!GetLogicalProcessorInformationEx(RelationAll, first, &length)) return;
+
+			for (DWORD offset = 0; offset < length;)
+			{
+				auto* entry = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+
+				if (entry->Relationship == RelationProcessorCore)
+				{
+					info.physicalCoreCount++;
+					for (WORD i = 0; i < entry->Processor.GroupCount; i++)
+					{
+						info.logicalCoreCount += static_cast<uint32_t>(popcount(
+							static_cast<uint64_t>(entry->Processor.GroupMask[i].Mask)));
+					}
+				}
+				else if (entry->Relationship == RelationNumaNode)
+				{
+					info.numaNodeCount++;
+				}
+				else if (entry->Relationship == RelationCache
+					&& entry->Cache.Type != CacheInstruction)
+				{
+					uint32_t size = static_cast<uint32_t>(entry->Cache.CacheSize);
+					BYTE level = entry->Cache.Level;
+
+					if (level == 1 && info.l1DataCacheSize == 0) info.l1DataCacheSize = size;
+					else if (level == 2 && info.l2CacheSize == 0) info.l2CacheSize = size;
+					else if (level == 3 && info.l3CacheSize == 0) info.l3CacheSize = size;
+
+					if (info.cacheLineSize == 0) info.cacheLineSize = entry->Cache.LineSize;
+				}
+
+				offset += entry->Size;
+			}
+		}
+#elif defined(__linux__)
+		//first line of a /sys file, empty if it does not exist
+		string ReadSysFile(const string& path)
+		{
+			ifstream file(path);
+			string line{};
+			getline(file, line);
+			return line;
+		}
+
+		//"0-3,8,10-11" as a list of cpu or node numbers
+		vector<uint32_t> ParseIndexList(const string& list)
+		{
+			vector<uint32_t> indices{};
+
+			size_t position = 0;
+			while (position < list.size())
+			{
+				size_t end = list.find(',', position);
+				if (end == string::npos) end = list.size();
+
+				string range = list.substr(position, end - position);
+				size_t dash = range.find('-');
+
+				char* rest = nullptr;
+				uint32_t first = static_cast<uint32_t>(strtoul(range.c_str(), &rest, 10));
+				uint32_t last = dash == string::npos
+					? first
+					: static_cast<uint32_t>(strtoul(range.c_str() + dash + 1, &rest, 10));
+
+				for (uint32_t i = first; i <= last && last - first < 65536; i++)
+				{
+					indices.push_back(i);
+				}
+
+				position = end + 1;
+			}
+
+			return indices;
+		}
+
+		//"32K" or "8192K" in bytes
+		uint32_t ParseCacheSize(const string& text)
+		{
+			char* suffix = nullptr;
+			uint64_t size = strtoull(text.c_str(), &suffix, 10);
+
+			if (*suffix == 'K') size *= 1024;
+			else if (*suffix == 'M') size *= 1024 * 1024;
+
+			return static_cast<uint32_t>(size);
+		}
+
+		void DetectTopology(CpuInfo& info)
+		{
+			const string cachePath = "/sys/devices/system/cpu/cpu0/cache/index";
+			for (int index = 0; index < 16; index++)
+			{
+				string directory = cachePath + to_string(index) + "/";
+
+				string level = ReadSysFile(directory + "level");
+				if (level.empty()) break;
+
+				string type = ReadSysFile(directory + "type");
+				if (type == "Instruction") continue;
+
+				uint32_t size = ParseCacheSize(ReadSysFile(directory + "size"));
+				if (level == "1" && info.l1DataCacheSize == 0) info.l1DataCacheSize = size;
+				else if (level == "2" && info.l2CacheSize == 0) info.l2CacheSize = size;
+				else if (level == "3" && info.l3CacheSize == 0) info.l3CacheSize = size;
+
+				uint32_t lineSize = ParseCacheSize(ReadSysFile(directory + "coherency_line_size"));
+				if (lineSize != 0) info.cacheLineSize = lineSize;
+			}
+
+			vector<uint32_t> cpus = ParseIndexList(ReadSysFile("/sys/devices/system/cpu/online"));
+			info.logicalCoreCount = static_cast<uint32_t>(cpus.size());
+
+			//a physical core is a unique core id within a package
+			vector<pair<string, string>> cores{};
+			for (uint32_t cpu : cpus)
+			{
+				string topology = "/sys/devices/system/cpu/cpu" + to_string(cpu) + "/topology/";
+
+				string package = ReadSysFile(topology + "physical_package_id");
+				string core = ReadSysFile(topology + "core_id");
+				if (core.empty()) continue;
+
+				cores.emplace_back(package, core);
+			}
+			sort(cores.begin(), cores.end());
+			info.physicalCoreCount = static_cast<uint32_t>(unique(cores.begin(), cores.end()) - cores.begin());
+
+			info.numaNodeCount = static_cast<uint32_t>(
+				ParseIndexList(ReadSysFile("/sys/devices/system/node/online")).size());
+		}
+#else
+		void DetectTopology(CpuInfo& info)
+		{
+			(void)info;
+		}
+#endif
+
+		CpuIsaLevel GetSupportedIsaLevel(const CpuInfo& info)
+		{
+			if (info.hasAvx512f
+				&& info.hasAvx512bw
+				&& info.hasAvx512dq
+				&& info.hasAvx512vl
+				&& info.hasAvx2)
+			{
+				return CpuIsaLevel::ISA_AVX512;
+			}
+			if (info.hasAvx2
+				&& info.hasFma
+				&& info.hasBmi1
+				&& info.hasBmi2)
+			{
+				return CpuIsaLevel::ISA_AVX2;
+			}
+			if (info.hasSse42
+				&& info.hasPopcnt)
+			{
+				return CpuIsaLevel::ISA_SSE42;
+			}
+			return CpuIsaLevel::ISA_BASELINE;
+		}
+
+		//lets the lower kernels be tested on a machine that supports the higher ones
+		CpuIsaLevel ApplyIsaLimit(CpuIsaLevel level)
+		{
+			const char* limit = getenv("KALAUTILS_MAX_ISA");
+			if (limit == nullptr) return level;
+
+			CpuIsaLevel maxLevel = level;
+			if (strcmp(limit, "baseline") == 0) maxLevel = CpuIsaLevel::ISA_BASELINE;
+			else if (strcmp(limit, "sse42") == 0) maxLevel = CpuIsaLevel::ISA_SSE42;
+			else if (strcmp(limit, "avx2") == 0) maxLevel = CpuIsaLevel::ISA_AVX2;
+
+			return maxLevel < level ? maxLevel : level;
+		}
+
+		CpuInfo DetectCpuInfo()
+		{
+			CpuInfo info{};
+
+#ifdef OSUTILS_X86
+			DetectFeatures(info);
+#endif
+			DetectTopology(info);
+#ifdef OSUTILS_X86
+			DetectCachesWithCpuid(info);
+#endif
+
+			if (info.logicalCoreCount == 0) info.logicalCoreCount = thread::hardware_concurrency();
+
+			info.isaLevel = ApplyIsaLimit(GetSupportedIsaLevel(info));
+			return info;
+		}
+
+		//how long the TSC is measured against the monotonic clock
+		constexpr uint64_t calibrationTime = 10000000;
+
+		struct TickCalibration
+		{
+			TickSource source;
+			double ticksPerSecond;
+			double nanosecondsPerTick;
+			//one moment in both clocks, GetMonotonicNanoseconds counts from here
+			uint64_t anchorTicks;
+			uint64_t anchorNanoseconds;
+		};
+
+		uint64_t ReadSteadyNanoseconds()
+		{
+			return static_cast<uint64_t>(duration_cast<nanoseconds>(
+				steady_clock::now().time_since_epoch()).count());
+		}
+
+#ifdef KALAKIT_HAS_TSC
+		//the TSC read halfway through the monotonic clock read that took the least time
+		void ReadClockPair(uint64_t& outTicks, uint64_t& outNanoseconds)
+		{
+			uint64_t bestWindow = UINT64_MAX;
+			for (int i = 0; i < 5; i++)
+			{
+				uint64_t before = __rdtsc();
+				uint64_t now = ReadSteadyNanoseconds();
+				uint64_t after = __rdtsc();
+
+				if (after - before < bestWindow)
+				{
+					bestWindow = after - before;
+					outTicks = before + (after - before) / 2;
+					outNanoseconds = now;
+				}
+			}
+		}
+#endif
+
+		TickCalibration Calibrate()
+		{
+			TickCalibration calibration{};
+			calibration.source = TickSource::TICKS_STEADY;
+			calibration.ticksPerSecond = 1e9;
+			calibration.nanosecondsPerTick = 1.0;
+			calibration.anchorNanoseconds = ReadSteadyNanoseconds();
+			calibration.anchorTicks = calibration.anchorNanoseconds;
+
+#ifdef KALAKIT_HAS_TSC
+			//a TSC that changes speed with the clock frequency cannot measure time
+			const CpuInfo& cpu = OSUtils::GetCpuInfo();
+			if (!cpu.hasInvariantTsc) return calibration;
+
+			uint64_t startTicks = 0;
+			uint64_t startNanoseconds = 0;
+			ReadClockPair(startTicks, startNanoseconds);
+
+			//spin instead of sleeping so the core does not change power state in between
+			while (ReadSteadyNanoseconds() - startNanoseconds < calibrationTime)
+			{
+			}
+
+			uint64_t endTicks = 0;
+			uint64_t endNanoseconds = 0;
+			ReadClockPair(endTicks, endNanoseconds);
+
+			if (endTicks <= startTicks
+				|| endNanoseconds <= startNanoseconds)
+			{
+				return calibration;
+			}
+
+			calibration.source = TickSource::TICKS_TSC;
+			calibration.ticksPerSecond =
+				static_cast<double>(endTicks - startTicks)
+				* 1e9 / static_cast<double>(endNanoseconds - startNanoseconds);
+			calibration.nanosecondsPerTick = 1e9 / calibration.ticksPerSecond;
+			calibration.anchorTicks = endTicks;
+			calibration.anchorNanoseconds = endNanoseconds;
+#endif
+
+			return calibration;
+		}
+
+		const TickCalibration& GetCalibration()
+		{
+			static const TickCalibration calibration = Calibrate();
+			return calibration;
+		}
+
+		//counters are looked up once per call site, so a plain list is enough
+		struct CounterRegistry
+		{
+			mutex countersMutex;
+			vector<TimerCounter*> counters;
+		};
+
+		//never destroyed, call sites keep references to their counters
+		CounterRegistry& GetCounterRegistry()
+		{
+			static CounterRegistry* registry = new CounterRegistry();
+			return *registry;
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this == &other) return *this;
+
+		Close();
+
+		data = other.data;
+		size = other.size;
+		isOpen = other.isOpen;
+#ifdef _WIN32
+		mappingHandle = other.mappingHandle;
+		other.mappingHandle = nullptr;
+#endif
+		other.data = nullptr;
+		other.size = 0;
+		other.isOpen = false;
+
+		return *this;
+	}
+
+	bool MappedFile::Open(const string& filePath)
+	{
+		Close();
+
+#ifdef _WIN32
+		HANDLE fileHandle = CreateFileA(
+			filePath.c_str(),
+			GENERIC_READ,
+			FILE_SHARE_READ | FILE_SHARE_WRITE,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL,
+			nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx(fileHandle, &fileSize))
+		{
+			CloseHandle(fileHandle);
+			return false;
+		}
+
+		//empty files cannot be mapped but are still valid
+		if (fileSize.QuadPart > 0)
+		{
+			mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!mappingHandle)
+			{
+				CloseHandle(fileHandle);
+				return false;
+			}
+
+			data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+			if (!data)
+			{
+				CloseHandle(mappingHandle);
+				CloseHandle(fileHandle);
+				mappingHandle = nullptr;
+				return false;
+			}
+		}
+
+		//the mapping keeps its own reference to the file
+		CloseHandle(fileHandle);
+		size = static_cast<size_t>(fileSize.QuadPart);
+#else
+		int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) return false;
+
+		struct stat info{};
+		if (fstat(fd, &info) != 0)
+		{
+			close(fd);
+			return false;
+		}
+
+		//empty files cannot be mapped but are still valid
+		if (info.st_size > 0)
+		{
+			void* mapped = mmap(
+				nullptr,
+				static_cast<size_t>(info.st_size),
+				PROT_READ,
+				MAP_PRIVATE,
+				fd,
+				0);
+			if (mapped == MAP_FAILED)
+			{
+				close(fd);
+				return false;
+			}
+			data = static_cast<const char*>(mapped);
+		}
+
+		//the mapping keeps its own reference to the file
+		close(fd);
+		size = static_cast<size_t>(info.st_size);
+#endif
+
+		isOpen = true;
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+#ifdef _WIN32
+		if (data) UnmapViewOfFile(data);
+		if (mappingHandle) CloseHandle(mappingHandle);
+		mappingHandle = nullptr;
+#else
+		if (data) munmap(const_cast<char*>(data), size);
+#endif
+		data = nullptr;
+		size = 0;
+		isOpen = false;
+	}
+
+	const CpuInfo& OSUtils::GetCpuInfo()
+	{
+		static const CpuInfo info = DetectCpuInfo();
+		return info;
+	}
+
+	TickSource OSUtils::GetTickSource()
+	{
+		return GetCalibration().source;
+	}
+	double OSUtils::GetTicksPerSecond()
+	{
+		return GetCalibration().ticksPerSecond;
+	}
+	uint64_t OSUtils::TicksToNanoseconds(uint64_t ticks)
+	{
+		return static_cast<uint64_t>(static_cast<double>(ticks) * GetCalibration().nanosecondsPerTick);
+	}
+
+	uint64_t OSUtils::GetMonotonicNanoseconds()
+	{
+		const TickCalibration& calibration = GetCalibration();
+		uint64_t ticks = ReadTicks();
+
+		//reads taken on another core just before the anchor can be a few ticks behind it
+		if (ticks < calibration.anchorTicks) return calibration.anchorNanoseconds;
+
+		return calibration.anchorNanoseconds + TicksToNanoseconds(ticks - calibration.anchorTicks);
+	}
+
+	TimerCounter& TimerCounter::Get(string_view name)
+	{
+		CounterRegistry& registry = GetCounterRegistry();
+
+		lock_guard<mutex> lock(registry.countersMutex);
+		for (TimerCounter* counter : registry.counters)
+		{
+			if (counter->name == name) return *counter;
+		}
+
+		TimerCounter* counter = new TimerCounter(name);
+		registry.counters.push_back(counter);
+		return *counter;
+	}
+
+	vector<TimerStats> TimerCounter::GetAllStats()
+	{
+		CounterRegistry& registry = GetCounterRegistry();
+
+		vector<TimerStats> stats{};
+
+		lock_guard<mutex> lock(registry.countersMutex);
+		stats.reserve(registry.counters.size());
+		for (const TimerCounter* counter : registry.counters)
+		{
+			stats.push_back(counter->GetStats());
+		}
+		return stats;
+	}
+
+	void TimerCounter::ResetAll()
+	{
+		CounterRegistry& registry = GetCounterRegistry();
+
+		lock_guard<mutex> lock(registry.countersMutex);
+		for (TimerCounter* counter : registry.counters)
+		{
+			counter->Reset();
+		}
+	}
+
+	TimerCounter::TimerCounter(string_view newName)
+		: name(newName)
+	{
+	}
+
+	TimerStats TimerCounter::GetStats() const
+	{
+		TimerStats stats{};
+		stats.name = name;
+		stats.count = count.load(memory_order_relaxed);
+		stats.total = OSUtils::TicksToNanoseconds(totalTicks.load(memory_order_relaxed));
+
+		if (stats.count != 0)
+		{
+			stats.min = OSUtils::TicksToNanoseconds(minTicks.load(memory_order_relaxed));
+			stats.max = OSUtils::TicksToNanoseconds(maxTicks.load(memory_order_relaxed));
+		}
+
+		return stats;
+	}
+
+	void TimerCounter::Reset()
 	{
-		// Do nothing
+		count.store(0, memory_order_relaxed);
+		totalTicks.store(0, memory_order_relaxed);
+		minTicks.store(UINT64_MAX, memory_order_relaxed);
+		maxTicks.store(0, memory_order_relaxed);
 	}
-}
\ No newline at end of file
+}
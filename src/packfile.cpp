@@ -0,0 +1,314 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+//main log macro
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_PACKFILE", level, msg)
+
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
+
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+#include "packfile.hpp"
+#include "logger.hpp"
+
+using std::ifstream;
+using std::ofstream;
+using std::sort;
+using std::to_string;
+
+namespace KalaKit
+{
+	static_assert(sizeof(PackHeader) == 64, "PackHeader layout changed");
+	static_assert(sizeof(PackEntry) == 32, "PackEntry layout changed");
+
+	bool PackFile::Write(const string& packPath, const vector<PackSource>& sources)
+	{
+		ofstream pack(packPath, std::ios::binary | std::ios::trunc);
+		if (!pack.is_open())
+		{
+			LOG_ERROR("Failed to create pack '" << packPath << "'!");
+			return false;
+		}
+
+		vector<PackEntry> toc;
+		toc.reserve(sources.size());
+		string nameTable{};
+
+		static const char padding[alignment]{};
+		vector<char> buffer(1 << 20);
+
+		//header is written last once all offsets are known
+		uint64_t position = alignment;
+		pack.write(padding, alignment);
+
+		for (const auto& source : sources)
+		{
+			ifstream input(source.filePath, std::ios::binary);
+			if (!input.is_open())
+			{
+				LOG_ERROR("Failed to open '" << source.filePath << "' for packing!");
+				return false;
+			}
+
+			PackEntry entry{};
+			entry.hash = HashPath(source.entryPath);
+			entry.offset = position;
+			entry.nameOffset = static_cast<uint32_t>(nameTable.size());
+			entry.nameLength = static_cast<uint32_t>(source.entryPath.size());
+			nameTable += source.entryPath;
+
+			while (input)
+			{
+				input.read(buffer.data(), buffer.size());
+				std::streamsize count = input.gcount();
+				if (count <= 0) break;
+
+				pack.write(buffer.data(), count);
+				entry.size += static_cast<uint64_t>(count);
+			}
+			position += entry.size;
+
+			//every entry starts on its own page
+			uint64_t pad = (alignment - (position % alignment)) % alignment;
+			pack.write(padding, static_cast<std::streamsize>(pad));
+			position += pad;
+
+			toc.push_back(entry);
+		}
+
+		sort(toc.begin(), toc.end(), [](const PackEntry& a, const PackEntry& b)
+			{
+				return a.hash < b.hash;
+			});
+
+		//reject duplicate paths, they would make lookups ambiguous
+		for (size_t i = 1; i < toc.size(); i++)
+		{
+			if (toc[i].hash == toc[i - 1].hash
+				&& toc[i].nameLength == toc[i - 1].nameLength
+				&& memcmp(
+					nameTable.data() + toc[i].nameOffset,
+					nameTable.data() + toc[i - 1].nameOffset,
+					toc[i].nameLength) == 0)
+			{
+				LOG_ERROR("Duplicate pack entry '" << nameTable.substr(toc[i].nameOffset, toc[i].nameLength) << "'!");
+				return false;
+			}
+		}
+
+		uint32_t slotCount = 1;
+		while (slotCount < toc.size() * 2) slotCount <<= 1;
+
+		vector<uint32_t> slotTable(slotCount, 0);
+		for (uint32_t i = 0; i < toc.size(); i++)
+		{
+			uint32_t slot = static_cast<uint32_t>(toc[i].hash) & (slotCount - 1);
+			while (slotTable[slot] != 0) slot = (slot + 1) & (slotCount - 1);
+			slotTable[slot] = i + 1;
+		}
+
+		PackHeader header{};
+		memcpy(header.magic, "KPAK", 4);
+		header.version = version;
+		header.entryCount = static_cast<uint32_t>(toc.size());
+		header.slotCount = slotCount;
+		header.tocOffset = position;
+		header.slotOffset = header.tocOffset + toc.size() * sizeof(PackEntry);
+		header.namesOffset = header.slotOffset + slotTable.size() * sizeof(uint32_t);
+		header.namesSize = nameTable.size();
+
+		pack.write(reinterpret_cast<const char*>(toc.data()), toc.size() * sizeof(PackEntry));
+		pack.write(reinterpret_cast<const char*>(slotTable.data()), slotTable.size() * sizeof(uint32_t));
+		pack.write(nameTable.data(), nameTable.size());
+
+		pack.seekp(0);
+		pack.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		pack.close();
+
+		if (!pack)
+		{
+			LOG_ERROR("Failed to write pack '" << packPath << "'!");
+			return false;
+		}
+
+		LOG_DEBUG("Wrote " << toc.size() << " entries to pack '" << packPath << "'.");
+		return true;
+	}
+
+	uint64_t PackFile::HashPath(string_view entryPath)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (char c : entryPath)
+		{
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	bool PackFile::Open(const string& packPath)
+	{
+		Close();
+
+		if (!file.Open(packPath))
+		{
+			LOG_ERROR("Failed to map pack '" << packPath << "'!");
+			return false;
+		}
+
+		const char* data = file.GetData();
+		uint64_t size = file.GetSize();
+		if (size < sizeof(PackHeader))
+		{
+			LOG_ERROR("Pack '" << packPath << "' is too small to be valid!");
+			file.Close();
+			return false;
+		}
+
+		//offsets come from the file, each one is checked against the size before anything
+		//is added to it and ranges are compared by subtraction, so no check can wrap around
+		const PackHeader* candidate = reinterpret_cast<const PackHeader*>(data);
+		uint64_t tocSize = uint64_t(candidate->entryCount) * sizeof(PackEntry);
+		uint64_t slotTableSize = uint64_t(candidate->slotCount) * sizeof(uint32_t);
+		bool isValid =
+			memcmp(candidate->magic, "KPAK", 4) == 0
+			&& candidate->version == version
+			&& candidate->slotCount != 0
+			&& (candidate->slotCount & (candidate->slotCount - 1)) == 0
+			&& candidate->slotCount >= uint64_t(candidate->entryCount) * 2
+			&& candidate->tocOffset >= sizeof(PackHeader)
+			&& candidate->tocOffset % alignof(PackEntry) == 0
+			&& candidate->tocOffset <= size
+			&& tocSize <= size - candidate->tocOffset
+			&& candidate->slotOffset == candidate->tocOffset + tocSize
+			&& slotTableSize <= size - candidate->slotOffset
+			&& candidate->namesOffset == candidate->slotOffset + slotTableSize
+			&& candidate->namesSize <= size - candidate->namesOffset;
+		if (!isValid)
+		{
+			LOG_ERROR("Pack '" << packPath << "' has an invalid header!");
+			file.Close();
+			return false;
+		}
+
+		const PackEntry* candidateEntries = reinterpret_cast<const PackEntry*>(data + candidate->tocOffset);
+		for (uint32_t i = 0; i < candidate->entryCount; i++)
+		{
+			const PackEntry& entry = candidateEntries[i];
+			if (entry.size > candidate->tocOffset
+				|| entry.offset > candidate->tocOffset - entry.size
+				|| uint64_t(entry.nameOffset) + entry.nameLength > candidate->namesSize)
+			{
+				LOG_ERROR("Pack '" << packPath << "' has an invalid table of contents!");
+				file.Close();
+				return false;
+			}
+		}
+
+		//a slot is empty or names an entry, so probing never leaves the table of contents
+		const uint32_t* candidateSlots = reinterpret_cast<const uint32_t*>(data + candidate->slotOffset);
+		for (uint32_t i = 0; i < candidate->slotCount; i++)
+		{
+			if (candidateSlots[i] > candidate->entryCount)
+			{
+				LOG_ERROR("Pack '" << packPath << "' has an invalid slot table!");
+				file.Close();
+				return false;
+			}
+		}
+
+		header = candidate;
+		entries = candidateEntries;
+		slots = reinterpret_cast<const uint32_t*>(data + header->slotOffset);
+		names = data + header->namesOffset;
+
+		return true;
+	}
+
+	void PackFile::Close()
+	{
+		file.Close();
+		header = nullptr;
+		entries = nullptr;
+		slots = nullptr;
+		names = nullptr;
+	}
+
+	const PackEntry* PackFile::FindEntry(string_view entryPath) const
+	{
+		if (!header) return nullptr;
+
+		uint64_t hash = HashPath(entryPath);
+		uint32_t mask = header->slotCount - 1;
+		uint32_t slot = static_cast<uint32_t>(hash) & mask;
+
+		//Open only accepts tables that are at most half full so probing hits an empty slot,
+		//the step limit only matters if the mapped file changes underneath
+		for (uint32_t step = 0; step < header->slotCount; step++)
+		{
+			uint32_t index = slots[slot];
+			if (index == 0
+				|| index > header->entryCount)
+			{
+				break;
+			}
+
+			const PackEntry& entry = entries[index - 1];
+			if (entry.hash == hash
+				&& string_view(names + entry.nameOffset, entry.nameLength) == entryPath)
+			{
+				return &entry;
+			}
+			slot = (slot + 1) & mask;
+		}
+
+		return nullptr;
+	}
+
+	bool PackFile::TryGet(string_view entryPath, string_view& outData) const
+	{
+		const PackEntry* entry = FindEntry(entryPath);
+		if (!entry) return false;
+
+		outData = string_view(file.GetData() + entry->offset, entry->size);
+		return true;
+	}
+
+	string_view PackFile::Get(string_view entryPath) const
+	{
+		string_view result{};
+		TryGet(entryPath, result);
+		return result;
+	}
+
+	bool PackFile::Contains(string_view entryPath) const
+	{
+		return FindEntry(entryPath) != nullptr;
+	}
+
+	size_t PackFile::GetEntryCount() const
+	{
+		return header ? header->entryCount : 0;
+	}
+
+	string_view PackFile::GetEntryPath(size_t index) const
+	{
+		if (index >= GetEntryCount()) return {};
+
+		return string_view(names + entries[index].nameOffset, entries[index].nameLength);
+	}
+
+	string_view PackFile::GetEntryData(size_t index) const
+	{
+		if (index >= GetEntryCount()) return {};
+
+		return string_view(file.GetData() + entries[index].offset, entries[index].size);
+	}
+}
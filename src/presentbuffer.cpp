@@ -0,0 +1,628 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+//main log macro
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_PRESENTBUFFER", level, msg)
+
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
+
+#include <algorithm>
+
+#if !defined(_WIN32) && X11_ENABLED
+#include <X11/Xutil.h>
+#if X11_SHM_ENABLED
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/extensions/XShm.h>
+#endif
+#endif
+
+#include "presentbuffer.hpp"
+#include "logger.hpp"
+
+using std::min;
+using std::max;
+
+namespace KalaKit
+{
+	PresentBuffer::~PresentBuffer()
+	{
+		Destroy();
+	}
+
+	bool PresentBuffer::Create(int newWidth, int newHeight, WindowHandle newHandle)
+	{
+		if (newWidth <= 0
+			|| newHeight <= 0)
+		{
+			LOG_ERROR("Present buffer size " << newWidth << "x" << newHeight << " must be above 0!");
+			return false;
+		}
+
+		if (!WindowUtils::IsWindowValid(newHandle))
+		{
+			LOG_ERROR("Cannot create a present buffer for a window that is not registered!");
+			return false;
+		}
+
+		Destroy();
+
+		//stay with this window even if the main window changes later
+		handle = newHandle.IsMainWindow() ? WindowUtils::GetMainWindow() : newHandle;
+		nativeWindow = WindowUtils::GetNativeWindow(handle);
+		width = newWidth;
+		height = newHeight;
+
+		if (!CreateBuffers())
+		{
+			DestroyBuffers();
+			handle = WindowHandle::Invalid();
+			return false;
+		}
+
+		backIndex = 0;
+		backBuffer = pixels[0];
+		return true;
+	}
+
+	bool PresentBuffer::Resize(int newWidth, int newHeight)
+	{
+		if (!IsCreated())
+		{
+			LOG_ERROR("Cannot resize a present buffer that has not been created!");
+			return false;
+		}
+
+		return Create(newWidth, newHeight, handle);
+	}
+
+	void PresentBuffer::Destroy()
+	{
+		if (IsCreated()) DestroyBuffers();
+
+		handle = WindowHandle::Invalid();
+		nativeWindow = {};
+	}
+
+	uint32_t PresentBuffer::GetBufferAge() const
+	{
+		if (!IsCreated()
+			|| presentedAt[backIndex] == 0)
+		{
+			return 0;
+		}
+
+		return static_cast<uint32_t>(presentCount - presentedAt[backIndex] + 1);
+	}
+
+	void PresentBuffer::AddDamage(const DamageRect& rect)
+	{
+		int left = max(rect.x, 0);
+		int top = max(rect.y, 0);
+		int right = min(rect.x + rect.width, width);
+		int bottom = min(rect.y + rect.height, height);
+		if (left >= right
+			|| top >= bottom)
+		{
+			return;
+		}
+
+		//many small rectangles cost more requests than sending one larger area
+		if (damage.size() == maxDamageRects)
+		{
+			for (const DamageRect& existing : damage)
+			{
+				left = min(left, existing.x);
+				top = min(top, existing.y);
+				right = max(right, existing.x + existing.width);
+				bottom = max(bottom, existing.y + existing.height);
+			}
+			damage.clear();
+		}
+
+		damage.push_back({ left, top, right - left, bottom - top });
+	}
+
+	void PresentBuffer::Present()
+	{
+		if (!IsCreated())
+		{
+			LOG_ERROR("Cannot present a present buffer that has not been created!");
+			return;
+		}
+
+		if (!WindowUtils::IsWindowValid(handle))
+		{
+			LOG_ERROR("Cannot present because the window of the present buffer is no longer registered!");
+			damage.clear();
+			return;
+		}
+
+		if (damage.empty()) damage.push_back({ 0, 0, width, height });
+
+		PresentDamage();
+
+		presentCount++;
+		presentedAt[backIndex] = presentCount;
+		damage.clear();
+
+		backIndex = (backIndex + 1) % bufferCount;
+		WaitForBuffer(backIndex);
+		backBuffer = pixels[backIndex];
+	}
+
+#ifdef _WIN32
+	bool PresentBuffer::CreateBuffers()
+	{
+		HDC windowContext = GetDC(nativeWindow);
+		HDC memoryContext = CreateCompatibleDC(windowContext);
+		ReleaseDC(nativeWindow, windowContext);
+
+		if (memoryContext == nullptr)
+		{
+			LOG_ERROR("Failed to create a memory device context for the present buffer!");
+			return false;
+		}
+
+		//negative height makes the rows top down like on X11
+		BITMAPINFO info{};
+		info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+		info.bmiHeader.biWidth = width;
+		info.bmiHeader.biHeight = -height;
+		info.bmiHeader.biPlanes = 1;
+		info.bmiHeader.biBitCount = 32;
+		info.bmiHeader.biCompression = BI_RGB;
+
+		void* bits = nullptr;
+		HBITMAP bitmap = CreateDIBSection(memoryContext, &info, DIB_RGB_COLORS, &bits, nullptr, 0);
+		if (bitmap == nullptr)
+		{
+			LOG_ERROR("Failed to create a " << width << "x" << height << " DIB section for the present buffer!");
+			DeleteDC(memoryContext);
+			return false;
+		}
+
+		//BitBlt copies straight from the DIB section, one buffer is enough
+		//because GdiFlush waits for the copy before the pixels are drawn again
+		graphicsContext = memoryContext;
+		images[0] = bitmap;
+		pixels[0] = static_cast<uint32_t*>(bits);
+		bufferCount = 1;
+		stride = width;
+		isShared = true;
+
+		return true;
+	}
+
+	void PresentBuffer::DestroyBuffers()
+	{
+		GdiFlush();
+
+		if (images[0] != nullptr) DeleteObject(static_cast<HBITMAP>(images[0]));
+		if (graphicsContext != nullptr) DeleteDC(static_cast<HDC>(graphicsContext));
+
+		images[0] = nullptr;
+		graphicsContext = nullptr;
+		pixels[0] = nullptr;
+		backBuffer = nullptr;
+		bufferCount = 0;
+		presentedAt[0] = 0;
+		presentCount = 0;
+		isInFlight[0] = false;
+		isShared = false;
+		damage.clear();
+	}
+
+	void PresentBuffer::PresentDamage()
+	{
+		HDC memoryContext = static_cast<HDC>(graphicsContext);
+		HDC windowContext = GetDC(nativeWindow);
+		HGDIOBJ previousBitmap = SelectObject(memoryContext, static_cast<HBITMAP>(images[backIndex]));
+
+		for (const DamageRect& rect : damage)
+		{
+			BitBlt(
+				windowContext,
+				rect.x,
+				rect.y,
+				rect.width,
+				rect.height,
+				memoryContext,
+				rect.x,
+				rect.y,
+				SRCCOPY);
+		}
+
+		SelectObject(memoryContext, previousBitmap);
+		ReleaseDC(nativeWindow, windowContext);
+
+		isInFlight[backIndex] = true;
+	}
+
+	void PresentBuffer::WaitForBuffer(uint32_t index)
+	{
+		if (!isInFlight[index]) return;
+
+		//GDI may still be batching the blits that read these pixels
+		GdiFlush();
+		isInFlight[index] = false;
+	}
+#elif X11_ENABLED
+	namespace
+	{
+#if X11_SHM_ENABLED
+		bool hasAttachFailed = false;
+
+		int OnAttachError(Display* display, XErrorEvent* error)
+		{
+			(void)display;
+			(void)error;
+
+			hasAttachFailed = true;
+			return 0;
+		}
+
+		//a shared memory segment the X server reads the pixels from,
+		//returns nullptr if the server cannot attach it, for example over a network
+		XImage* CreateSharedImage(
+			Display* display,
+			Visual* visual,
+			int depth,
+			int width,
+			int height,
+			XShmSegmentInfo* info)
+		{
+			XImage* image = XShmCreateImage(
+				display,
+				visual,
+				static_cast<unsigned int>(depth),
+				ZPixmap,
+				nullptr,
+				info,
+				static_cast<unsigned int>(width),
+				static_cast<unsigned int>(height));
+			if (image == nullptr) return nullptr;
+
+			if (image->bits_per_pixel != 32)
+			{
+				XDestroyImage(image);
+				return nullptr;
+			}
+
+			info->shmid = shmget(
+				IPC_PRIVATE,
+				static_cast<size_t>(image->bytes_per_line) * static_cast<size_t>(height),
+				IPC_CREAT | 0600);
+			if (info->shmid < 0)
+			{
+				XDestroyImage(image);
+				return nullptr;
+			}
+
+			info->shmaddr = static_cast<char*>(shmat(info->shmid, nullptr, 0));
+			if (info->shmaddr == reinterpret_cast<char*>(-1))
+			{
+				shmctl(info->shmid, IPC_RMID, nullptr);
+				XDestroyImage(image);
+				return nullptr;
+			}
+			image->data = info->shmaddr;
+			info->readOnly = False;
+
+			//a failed attach only arrives as an X error, wait for it here
+			hasAttachFailed = false;
+			XErrorHandler previousHandler = XSetErrorHandler(OnAttachError);
+			XShmAttach(display, info);
+			XSync(display, False);
+			XSetErrorHandler(previousHandler);
+
+			//the segment is freed once both processes have detached
+			shmctl(info->shmid, IPC_RMID, nullptr);
+
+			if (hasAttachFailed)
+			{
+				shmdt(info->shmaddr);
+				image->data = nullptr;
+				XDestroyImage(image);
+				return nullptr;
+			}
+
+			return image;
+		}
+
+		struct CompletionFilter
+		{
+			int type;
+			Window drawable;
+		};
+
+		Bool IsCompletionEvent(Display* display, XEvent* event, XPointer argument)
+		{
+			(void)display;
+
+			const CompletionFilter* filter = reinterpret_cast<const CompletionFilter*>(argument);
+			return event->type == filter->type
+				&& reinterpret_cast<XShmCompletionEvent*>(event)->drawable == filter->drawable;
+		}
+#endif
+	}
+
+	bool PresentBuffer::CreateBuffers()
+	{
+		Display* display = nativeWindow.display;
+
+		XWindowAttributes attributes{};
+		if (!XGetWindowAttributes(display, nativeWindow.window, &attributes))
+		{
+			LOG_ERROR("Failed to read the window attributes for the present buffer!");
+			return false;
+		}
+
+		if (attributes.depth != 24
+			&& attributes.depth != 32)
+		{
+			LOG_ERROR("Present buffers need a 24 or 32 bit window, this window is " << attributes.depth << " bit!");
+			return false;
+		}
+
+		graphicsContext = XCreateGC(display, nativeWindow.window, 0, nullptr);
+
+#if X11_SHM_ENABLED
+		//two shared buffers so the next frame is drawn while the server reads the last one
+		if (XShmQueryExtension(display))
+		{
+			isShared = true;
+			for (uint32_t i = 0; i < maxBufferCount; i++)
+			{
+				XShmSegmentInfo* info = new XShmSegmentInfo{};
+				XImage* image = CreateSharedImage(
+					display,
+					attributes.visual,
+					attributes.depth,
+					width,
+					height,
+					info);
+
+				if (image == nullptr)
+				{
+					delete info;
+					isShared = false;
+					break;
+				}
+
+				images[i] = image;
+				sharedInfos[i] = info;
+				pixels[i] = reinterpret_cast<uint32_t*>(image->data);
+				stride = image->bytes_per_line / 4;
+				bufferCount++;
+			}
+
+			if (!isShared)
+			{
+				LOG_DEBUG("MIT-SHM is not usable on this display, falling back to XPutImage");
+				DestroyBuffers();
+				graphicsContext = XCreateGC(display, nativeWindow.window, 0, nullptr);
+			}
+		}
+#endif
+
+		if (!isShared)
+		{
+			//XPutImage copies the pixels into the request before returning, one buffer is enough
+			fallbackPixels[0].assign(static_cast<size_t>(width) * static_cast<size_t>(height), 0);
+
+			XImage* image = XCreateImage(
+				display,
+				attributes.visual,
+				static_cast<unsigned int>(attributes.depth),
+				ZPixmap,
+				0,
+				reinterpret_cast<char*>(fallbackPixels[0].data()),
+				static_cast<unsigned int>(width),
+				static_cast<unsigned int>(height),
+				32,
+				width * 4);
+
+			if (image == nullptr
+				|| image->bits_per_pixel != 32)
+			{
+				LOG_ERROR("Failed to create a 32 bit " << width << "x" << height << " image for the present buffer!");
+				if (image != nullptr)
+				{
+					image->data = nullptr;
+					XDestroyImage(image);
+				}
+				return false;
+			}
+
+			images[0] = image;
+			pixels[0] = fallbackPixels[0].data();
+			stride = width;
+			bufferCount = 1;
+		}
+
+		return true;
+	}
+
+	void PresentBuffer::DestroyBuffers()
+	{
+		Display* display = nativeWindow.display;
+
+		for (uint32_t i = 0; i < maxBufferCount; i++)
+		{
+			XImage* image = static_cast<XImage*>(images[i]);
+			if (image == nullptr) continue;
+
+#if X11_SHM_ENABLED
+			XShmSegmentInfo* info = static_cast<XShmSegmentInfo*>(sharedInfos[i]);
+			if (info != nullptr)
+			{
+				WaitForBuffer(i);
+
+				XShmDetach(display, info);
+				shmdt(info->shmaddr);
+				delete info;
+				sharedInfos[i] = nullptr;
+			}
+#endif
+
+			//the pixels are not owned by Xlib
+			image->data = nullptr;
+			XDestroyImage(image);
+			images[i] = nullptr;
+
+			fallbackPixels[i].clear();
+			fallbackPixels[i].shrink_to_fit();
+			pixels[i] = nullptr;
+			presentedAt[i] = 0;
+			isInFlight[i] = false;
+		}
+
+		if (graphicsContext != nullptr)
+		{
+			XFreeGC(display, static_cast<GC>(graphicsContext));
+			graphicsContext = nullptr;
+		}
+
+		backBuffer = nullptr;
+		bufferCount = 0;
+		backIndex = 0;
+		presentCount = 0;
+		isShared = false;
+		damage.clear();
+	}
+
+	void PresentBuffer::PresentDamage()
+	{
+		Display* display = nativeWindow.display;
+		GC context = static_cast<GC>(graphicsContext);
+		XImage* image = static_cast<XImage*>(images[backIndex]);
+
+		for (size_t i = 0; i < damage.size(); i++)
+		{
+			const DamageRect& rect = damage[i];
+
+#if X11_SHM_ENABLED
+			if (isShared)
+			{
+				//only the last request asks for a completion event
+				bool isLast = i + 1 == damage.size();
+				XShmPutImage(
+					display,
+					nativeWindow.window,
+					context,
+					image,
+					rect.x,
+					rect.y,
+					rect.x,
+					rect.y,
+					static_cast<unsigned int>(rect.width),
+					static_cast<unsigned int>(rect.height),
+					isLast ? True : False);
+				continue;
+			}
+#endif
+
+			XPutImage(
+				display,
+				nativeWindow.window,
+				context,
+				image,
+				rect.x,
+				rect.y,
+				rect.x,
+				rect.y,
+				static_cast<unsigned int>(rect.width),
+				static_cast<unsigned int>(rect.height));
+		}
+
+		isInFlight[backIndex] = isShared;
+
+		//hands the requests to the server without waiting for replies
+		XFlush(display);
+	}
+
+	void PresentBuffer::WaitForBuffer(uint32_t index)
+	{
+		if (!isInFlight[index]) return;
+
+#if X11_SHM_ENABLED
+		Display* display = nativeWindow.display;
+
+		CompletionFilter filter =
+		{
+			XShmGetEventBase(display) + ShmCompletion,
+			nativeWindow.window
+		};
+
+		//usually the completion event has already arrived, so no round trip is needed
+		XEvent event{};
+		while (XCheckIfEvent(display, &event, IsCompletionEvent, reinterpret_cast<XPointer>(&filter)))
+		{
+			ShmSeg segment = reinterpret_cast<XShmCompletionEvent*>(&event)->shmseg;
+			for (uint32_t i = 0; i < bufferCount; i++)
+			{
+				const XShmSegmentInfo* info = static_cast<const XShmSegmentInfo*>(sharedInfos[i]);
+				if (info != nullptr
+					&& info->shmseg == segment)
+				{
+					isInFlight[i] = false;
+				}
+			}
+		}
+
+		if (!isInFlight[index]) return;
+
+		//the event loop of the app may have taken the event, XSync returns
+		//once the server has handled every earlier put, so all buffers are free
+		XSync(display, False);
+		while (XCheckIfEvent(display, &event, IsCompletionEvent, reinterpret_cast<XPointer>(&filter)))
+		{
+		}
+#endif
+
+		for (uint32_t i = 0; i < maxBufferCount; i++)
+		{
+			isInFlight[i] = false;
+		}
+	}
+#else
+	//no native window layer yet, the buffer is only kept in memory
+	bool PresentBuffer::CreateBuffers()
+	{
+		fallbackPixels[0].assign(static_cast<size_t>(width) * static_cast<size_t>(height), 0);
+		pixels[0] = fallbackPixels[0].data();
+		stride = width;
+		bufferCount = 1;
+
+		return true;
+	}
+
+	void PresentBuffer::DestroyBuffers()
+	{
+		fallbackPixels[0].clear();
+		fallbackPixels[0].shrink_to_fit();
+		pixels[0] = nullptr;
+		backBuffer = nullptr;
+		bufferCount = 0;
+		backIndex = 0;
+		presentedAt[0] = 0;
+		presentCount = 0;
+		damage.clear();
+	}
+
+	void PresentBuffer::PresentDamage()
+	{
+	}
+
+	void PresentBuffer::WaitForBuffer(uint32_t index)
+	{
+		isInFlight[index] = false;
+	}
+#endif //_WIN32
+}
@@ -4,16 +4,12 @@
 //Read LICENSE.md for more information.
 
 //main log macro
-#define WRITE_LOG(type, msg) std::cout << "[KALAKIT_STRINGUTILS | " << type << "] " << msg << "\n"
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_STRINGUTILS", level, msg)
 
-//log types
-#if KALAUTILS_DEBUG
-	#define LOG_DEBUG(msg) WRITE_LOG("DEBUG", msg)
-#else
-	#define LOG_DEBUG(msg)
-#endif
-#define LOG_SUCCESS(msg) WRITE_LOG("SUCCESS", msg)
-#define LOG_ERROR(msg) WRITE_LOG("ERROR", msg)
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
 
 #include <iostream>
 #include <filesystem>
@@ -21,6 +17,7 @@
 #include <fstream>
 
 #include "stringutils.hpp"
+#include "logger.hpp"
 
 using std::any_of;
 using std::getline;
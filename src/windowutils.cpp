@@ -4,32 +4,270 @@
 //Read LICENSE.md for more information.
 
 //main log macro
-#define WRITE_LOG(type, msg) std::cout << "[KALAKIT_WINDOWUTILS | " << type << "] " << msg << "\n"
+#define WRITE_LOG(level, msg) KALAKIT_LOG("KALAKIT_WINDOWUTILS", level, msg)
+//format log macro for hot paths, the arguments are formatted later by the logger thread
+#define WRITE_LOG_FORMAT(level, ...) KALAKIT_LOG_FORMAT("KALAKIT_WINDOWUTILS", level, __VA_ARGS__)
 
-//log types
-#if KALAUTILS_DEBUG
-	#define LOG_DEBUG(msg) WRITE_LOG("DEBUG", msg)
-#else
-	#define LOG_DEBUG(msg)
-#endif
-#define LOG_SUCCESS(msg) WRITE_LOG("SUCCESS", msg)
-#define LOG_ERROR(msg) WRITE_LOG("ERROR", msg)
+//log types, levels below KALAUTILS_LOG_MIN_LEVEL are compiled out
+#define LOG_DEBUG(msg) WRITE_LOG(LOG_LEVEL_DEBUG, msg)
+#define LOG_DEBUG_FORMAT(...) WRITE_LOG_FORMAT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_SUCCESS(msg) WRITE_LOG(LOG_LEVEL_SUCCESS, msg)
+#define LOG_ERROR(msg) WRITE_LOG(LOG_LEVEL_ERROR, msg)
 
-#include <iostream>
+#include <vector>
+#include <unordered_map>
+
+#if !defined(_WIN32) && X11_ENABLED
+#include <X11/Xutil.h>
+#include <X11/Xatom.h>
+#endif
 
 #include "windowutils.hpp"
+#include "logger.hpp"
 
-using std::to_string;
+using std::vector;
+using std::unordered_map;
 
 namespace KalaKit
 {
-	DebugType WindowUtils::GetDebugType()
+	namespace
+	{
+		//position and size changes waiting for the next FlushWindowChanges call
+		struct PendingWindowChanges
+		{
+			bool hasPosition = false;
+			bool hasSize = false;
+			POS position{};
+			//content size, full sizes are converted with the frame border
+			POS size{};
+		};
+
+		//one entry per slot in every array, slots of unregistered windows are reused
+		struct WindowTable
+		{
+			vector<WINDOW> nativeWindows;
+			vector<uint32_t> generations;
+			vector<uint8_t> isAlive;
+
+			vector<uint8_t> isStateCached;
+			vector<uint8_t> isVisible;
+			vector<uint8_t> isBorderless;
+			vector<PendingWindowChanges> pendingChanges;
+
+			//outer top left corner of the window
+			vector<POS> positions;
+			vector<POS> contentSizes;
+			//frame thickness on each side of the content area
+			vector<BOUNDS> frameBorders;
+
+			vector<POS> minSizes;
+			vector<POS> maxSizes;
+
+#ifdef _WIN32
+			//style, size, position and show state from before switching to borderless
+			vector<LONG> originalStyles;
+			vector<WINDOWPLACEMENT> originalPlacements;
+#endif
+
+			vector<uint32_t> freeSlots;
+			unordered_map<uint64_t, uint32_t> nativeToSlot;
+			size_t windowCount = 0;
+		};
+
+		WindowTable table{};
+		WindowHandle mainWindow = WindowHandle::Invalid();
+
+		uint64_t GetNativeKey(const WINDOW& nativeWindow)
+		{
+#ifdef _WIN32
+			return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(nativeWindow));
+#elif X11_ENABLED
+			return static_cast<uint64_t>(nativeWindow.window);
+#else
+			return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(nativeWindow.window));
+#endif
+		}
+
+		bool IsSlotValid(WindowHandle handle)
+		{
+			return handle.index < table.generations.size()
+				&& table.isAlive[handle.index]
+				&& table.generations[handle.index] == handle.generation;
+		}
+
+		//default handles resolve to the main window
+		bool GetSlot(WindowHandle handle, uint32_t& outSlot)
+		{
+			if (handle.IsMainWindow()) handle = mainWindow;
+
+			if (!IsSlotValid(handle))
+			{
+				LOG_ERROR("Window handle " << handle.index << ":" << handle.generation << " is not valid!");
+				return false;
+			}
+
+			outSlot = handle.index;
+			return true;
+		}
+
+		void ApplyPendingChanges(uint32_t slot)
+		{
+			PendingWindowChanges& pending = table.pendingChanges[slot];
+
+			//assume the OS accepted the change, the next event corrects it if it did not
+			if (pending.hasPosition) table.positions[slot] = pending.position;
+			if (pending.hasSize) table.contentSizes[slot] = pending.size;
+
+			pending = {};
+		}
+
+		void RefreshNativeState(uint32_t slot);
+		void ApplyNativeChanges(uint32_t slot);
+		void FinishNativeFlush();
+
+		void EnsureWindowState(uint32_t slot)
+		{
+			if (!table.isStateCached[slot]) RefreshNativeState(slot);
+		}
+	}
+
+	WindowHandle WindowUtils::RegisterWindow(const WINDOW& nativeWindow)
+	{
+		uint64_t key = GetNativeKey(nativeWindow);
+
+		auto existing = table.nativeToSlot.find(key);
+		if (existing != table.nativeToSlot.end())
+		{
+			return { existing->second, table.generations[existing->second] };
+		}
+
+		uint32_t slot = 0;
+		if (!table.freeSlots.empty())
+		{
+			slot = table.freeSlots.back();
+			table.freeSlots.pop_back();
+		}
+		else
+		{
+			slot = static_cast<uint32_t>(table.generations.size());
+
+			table.nativeWindows.emplace_back();
+			table.generations.push_back(0);
+			table.isAlive.push_back(0);
+			table.isStateCached.push_back(0);
+			table.isVisible.push_back(1);
+			table.isBorderless.push_back(0);
+			table.pendingChanges.emplace_back();
+			table.positions.emplace_back();
+			table.contentSizes.emplace_back();
+			table.frameBorders.emplace_back();
+			table.minSizes.emplace_back();
+			table.maxSizes.emplace_back();
+#ifdef _WIN32
+			table.originalStyles.push_back(0);
+			table.originalPlacements.push_back({ sizeof(WINDOWPLACEMENT) });
+#endif
+		}
+
+		table.nativeWindows[slot] = nativeWindow;
+		table.generations[slot]++;
+		table.isAlive[slot] = 1;
+		table.isStateCached[slot] = 0;
+		table.isVisible[slot] = 1;
+		table.isBorderless[slot] = 0;
+		table.pendingChanges[slot] = {};
+		table.positions[slot] = {};
+		table.contentSizes[slot] = {};
+		table.frameBorders[slot] = {};
+		table.minSizes[slot] = { 800, 600 };
+		table.maxSizes[slot] = { 7680, 4320 };
+
+		table.nativeToSlot[key] = slot;
+		table.windowCount++;
+
+		WindowHandle handle = { slot, table.generations[slot] };
+		if (!IsSlotValid(mainWindow)) mainWindow = handle;
+
+		return handle;
+	}
+
+	void WindowUtils::UnregisterWindow(WindowHandle handle)
+	{
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		WindowHandle removed = { slot, table.generations[slot] };
+
+		table.nativeToSlot.erase(GetNativeKey(table.nativeWindows[slot]));
+		table.nativeWindows[slot] = {};
+		table.isAlive[slot] = 0;
+		table.freeSlots.push_back(slot);
+		table.windowCount--;
+
+		//hand the main window role to any window that is still registered
+		if (removed == mainWindow)
+		{
+			mainWindow = WindowHandle::Invalid();
+			for (uint32_t i = 0; i < table.isAlive.size(); i++)
+			{
+				if (table.isAlive[i])
+				{
+					mainWindow = { i, table.generations[i] };
+					break;
+				}
+			}
+		}
+	}
+
+	bool WindowUtils::IsWindowValid(WindowHandle handle)
+	{
+		return IsSlotValid(handle.IsMainWindow() ? mainWindow : handle);
+	}
+
+	WindowHandle WindowUtils::GetWindowHandle(const WINDOW& nativeWindow)
+	{
+		auto found = table.nativeToSlot.find(GetNativeKey(nativeWindow));
+		if (found == table.nativeToSlot.end()) return WindowHandle::Invalid();
+
+		return { found->second, table.generations[found->second] };
+	}
+	WINDOW WindowUtils::GetNativeWindow(WindowHandle handle)
+	{
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return {};
+
+		return table.nativeWindows[slot];
+	}
+
+	WindowHandle WindowUtils::GetMainWindow()
+	{
+		return mainWindow;
+	}
+	void WindowUtils::SetMainWindow(WindowHandle handle)
 	{
-		return debugType;
+		if (!IsSlotValid(handle))
+		{
+			LOG_ERROR("Cannot make window handle " << handle.index << ":" << handle.generation << " the main window because it is not valid!");
+			return;
+		}
+
+		mainWindow = handle;
+	}
+
+	size_t WindowUtils::GetWindowCount()
+	{
+		return table.windowCount;
 	}
-	void WindowUtils::SetDebugType(DebugType newDebugType)
+	vector<WindowHandle> WindowUtils::GetWindows()
 	{
-		debugType = newDebugType;
+		vector<WindowHandle> handles{};
+		handles.reserve(table.windowCount);
+
+		for (uint32_t i = 0; i < table.isAlive.size(); i++)
+		{
+			if (table.isAlive[i]) handles.push_back({ i, table.generations[i] });
+		}
+		return handles;
 	}
 
 	bool WindowUtils::GetWindowFocusRequiredState()
@@ -41,21 +279,79 @@ namespace KalaKit
 		isWindowFocusRequired = newWindowFocusRequiredState;
 	}
 
-	void WindowUtils::SetWindowTitle(const string& title)
+#ifdef _WIN32
+	namespace
 	{
-		if (debugType == DebugType::DEBUG_ALL
-			|| debugType == DebugType::DEBUG_WINDOW_TITLE)
+		void RefreshNativeState(uint32_t slot)
+		{
+			HWND window = table.nativeWindows[slot];
+
+			RECT frame{};
+			GetWindowRect(window, &frame);
+
+			RECT client{};
+			GetClientRect(window, &client);
+
+			POINT origin = { 0, 0 };
+			ClientToScreen(window, &origin);
+
+			table.positions[slot] = { frame.left, frame.top };
+			table.contentSizes[slot] = { client.right, client.bottom };
+
+			BOUNDS& border = table.frameBorders[slot];
+			border.left = origin.x - frame.left;
+			border.top = origin.y - frame.top;
+			border.right = frame.right - (origin.x + client.right);
+			border.bottom = frame.bottom - (origin.y + client.bottom);
+
+			table.isVisible[slot] = IsWindowVisible(window) != FALSE;
+			table.isBorderless[slot] = (GetWindowLong(window, GWL_STYLE) & WS_CAPTION) == 0;
+
+			table.isStateCached[slot] = 1;
+		}
+
+		void ApplyNativeChanges(uint32_t slot)
+		{
+			const PendingWindowChanges& pending = table.pendingChanges[slot];
+			const BOUNDS& border = table.frameBorders[slot];
+
+			UINT flags = SWP_NOZORDER | SWP_NOOWNERZORDER;
+			if (!pending.hasPosition) flags |= SWP_NOMOVE;
+			if (!pending.hasSize) flags |= SWP_NOSIZE;
+
+			//position and size of every setter call this frame in one SetWindowPos
+			SetWindowPos(
+				table.nativeWindows[slot],
+				nullptr,
+				pending.position.x,
+				pending.position.y,
+				pending.size.x + border.left + border.right,
+				pending.size.y + border.top + border.bottom,
+				flags);
+		}
+
+		void FinishNativeFlush()
+		{
+			//every Win32 call above is applied immediately
+		}
+	}
+
+	void WindowUtils::SetWindowTitle(const string& title, WindowHandle handle)
+	{
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_TITLE))
 		{
 			LOG_DEBUG("New window title: " << title << "");
 		}
 
-		SetWindowTextA(window, title.c_str());
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		SetWindowTextA(table.nativeWindows[slot], title.c_str());
 	}
 
-	void WindowUtils::SetWindowState(WindowState state)
+	void WindowUtils::SetWindowState(WindowState state, WindowHandle handle)
 	{
-		if (debugType == DebugType::DEBUG_ALL
-			|| debugType == DebugType::DEBUG_WINDOW_TITLE)
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_TITLE))
 		{
 			string type{};
 			if (state == WindowState::WINDOW_RESET) type = "WINDOW_RESET";
@@ -65,6 +361,11 @@ namespace KalaKit
 			LOG_DEBUG("New window type: " << type << "");
 		}
 
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		HWND window = table.nativeWindows[slot];
+
 		switch (state)
 		{
 		case WindowState::WINDOW_RESET:
@@ -79,25 +380,24 @@ namespace KalaKit
 		}
 	}
 
-	bool WindowUtils::IsWindowBorderless()
+	void WindowUtils::SetWindowBorderlessState(bool newWindowBorderlessState, WindowHandle handle)
 	{
-		LONG style = GetWindowLong(window, GWL_STYLE);
-		return (style & WS_OVERLAPPEDWINDOW);
-	}
-	void WindowUtils::SetWindowBorderlessState(bool newWindowBorderlessState)
-	{
-		if (debugType == DebugType::DEBUG_ALL
-			|| debugType == DebugType::DEBUG_WINDOW_BORDERLESS_STATE)
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_BORDERLESS_STATE))
 		{
 			string type = newWindowBorderlessState ? "true" : "false";
 			LOG_DEBUG("New window borderless state: " << type << "");
 		}
 
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		HWND window = table.nativeWindows[slot];
+
 		if (!newWindowBorderlessState)
 		{
 			//save original style and placement
-			originalStyle = GetWindowLong(window, GWL_STYLE);
-			GetWindowPlacement(window, &originalPlacement);
+			table.originalStyles[slot] = GetWindowLong(window, GWL_STYLE);
+			GetWindowPlacement(window, &table.originalPlacements[slot]);
 
 			//set style to borderless
 			SetWindowLong(window, GWL_STYLE, WS_POPUP);
@@ -114,16 +414,14 @@ namespace KalaKit
 				SWP_FRAMECHANGED
 				| SWP_NOOWNERZORDER
 				| SWP_SHOWWINDOW);
-
-			isWindowBorderless = true;
 		}
 		else
 		{
 			//restore original style
-			SetWindowLong(window, GWL_STYLE, originalStyle);
+			SetWindowLong(window, GWL_STYLE, table.originalStyles[slot]);
 
 			//restore previous size/position
-			SetWindowPlacement(window, &originalPlacement);
+			SetWindowPlacement(window, &table.originalPlacements[slot]);
 			SetWindowPos(
 				window,
 				nullptr,
@@ -137,164 +435,639 @@ namespace KalaKit
 				| SWP_NOOWNERZORDER
 				| SWP_NOZORDER
 				| SWP_SHOWWINDOW);
+		}
+
+		//the frame border changed, so every cached size did too
+		RefreshNativeState(slot);
+	}
 
-			isWindowBorderless = true;
+	void WindowUtils::SetWindowHiddenState(bool newWindowHiddenState, WindowHandle handle)
+	{
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_HIDDEN_STATE))
+		{
+			string type = newWindowHiddenState ? "true" : "false";
+			LOG_DEBUG("New window hidden state: " << type << "");
 		}
+
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		ShowWindow(table.nativeWindows[slot], newWindowHiddenState ? SW_HIDE : SW_SHOW);
+		table.isVisible[slot] = !newWindowHiddenState;
 	}
+#elif X11_ENABLED
+	namespace
+	{
+		//interned once per display, so setters never wait for XInternAtom replies
+		struct X11Atoms
+		{
+			Display* display = nullptr;
+
+			Atom netWmName = 0;
+			Atom utf8String = 0;
+			Atom netWmState = 0;
+			Atom netWmStateMaximizedVert = 0;
+			Atom netWmStateMaximizedHorz = 0;
+			Atom netFrameExtents = 0;
+			Atom motifWmHints = 0;
+		};
+
+		X11Atoms atoms{};
+
+		const X11Atoms& GetAtoms(Display* display)
+		{
+			if (atoms.display == display) return atoms;
+
+			char* names[] =
+			{
+				const_cast<char*>("_NET_WM_NAME"),
+				const_cast<char*>("UTF8_STRING"),
+				const_cast<char*>("_NET_WM_STATE"),
+				const_cast<char*>("_NET_WM_STATE_MAXIMIZED_VERT"),
+				const_cast<char*>("_NET_WM_STATE_MAXIMIZED_HORZ"),
+				const_cast<char*>("_NET_FRAME_EXTENTS"),
+				const_cast<char*>("_MOTIF_WM_HINTS")
+			};
+			Atom values[7]{};
+			XInternAtoms(display, names, 7, False, values);
+
+			atoms.display = display;
+			atoms.netWmName = values[0];
+			atoms.utf8String = values[1];
+			atoms.netWmState = values[2];
+			atoms.netWmStateMaximizedVert = values[3];
+			atoms.netWmStateMaximizedHorz = values[4];
+			atoms.netFrameExtents = values[5];
+			atoms.motifWmHints = values[6];
+
+			return atoms;
+		}
+
+		//frame size around the content area, needs a round trip to the server
+		BOUNDS LoadFrameExtents(const WINDOW& window)
+		{
+			const X11Atoms& currentAtoms = GetAtoms(window.display);
+
+			Atom type = 0;
+			int format = 0;
+			unsigned long count = 0;
+			unsigned long remaining = 0;
+			unsigned char* data = nullptr;
+
+			BOUNDS extents{};
+			if (XGetWindowProperty(
+				window.display,
+				window.window,
+				currentAtoms.netFrameExtents,
+				0,
+				4,
+				False,
+				XA_CARDINAL,
+				&type,
+				&format,
+				&count,
+				&remaining,
+				&data) == Success
+				&& data != nullptr)
+			{
+				if (format == 32 && count == 4)
+				{
+					//left, right, top, bottom
+					const long* values = reinterpret_cast<const long*>(data);
+					extents.left = static_cast<int>(values[0]);
+					extents.right = static_cast<int>(values[1]);
+					extents.top = static_cast<int>(values[2]);
+					extents.bottom = static_cast<int>(values[3]);
+				}
+				XFree(data);
+			}
+
+			return extents;
+		}
+
+		//asks the window manager to add (1) or remove (0) up to two _NET_WM_STATE atoms
+		void SendWindowState(const WINDOW& window, long action, Atom first, Atom second)
+		{
+			const X11Atoms& currentAtoms = GetAtoms(window.display);
+
+			XEvent event{};
+			event.xclient.type = ClientMessage;
+			event.xclient.window = window.window;
+			event.xclient.message_type = currentAtoms.netWmState;
+			event.xclient.format = 32;
+			event.xclient.data.l[0] = action;
+			event.xclient.data.l[1] = static_cast<long>(first);
+			event.xclient.data.l[2] = static_cast<long>(second);
+			event.xclient.data.l[3] = 1;
+
+			XSendEvent(
+				window.display,
+				DefaultRootWindow(window.display),
+				False,
+				SubstructureRedirectMask | SubstructureNotifyMask,
+				&event);
+		}
+
+		void RefreshNativeState(uint32_t slot)
+		{
+			const WINDOW& window = table.nativeWindows[slot];
+
+			XWindowAttributes attributes{};
+			if (!XGetWindowAttributes(window.display, window.window, &attributes)) return;
+
+			int x = 0;
+			int y = 0;
+			Window child = 0;
+			XTranslateCoordinates(
+				window.display,
+				window.window,
+				DefaultRootWindow(window.display),
+				0,
+				0,
+				&x,
+				&y,
+				&child);
+
+			BOUNDS border = LoadFrameExtents(window);
 
-	bool WindowUtils::IsWindowHidden()
+			table.frameBorders[slot] = border;
+			table.positions[slot] = { x - border.left, y - border.top };
+			table.contentSizes[slot] = { attributes.width, attributes.height };
+			table.isVisible[slot] = attributes.map_state == IsViewable;
+
+			table.isStateCached[slot] = 1;
+		}
+
+		void ApplyNativeChanges(uint32_t slot)
+		{
+			const WINDOW& window = table.nativeWindows[slot];
+			const PendingWindowChanges& pending = table.pendingChanges[slot];
+
+			unsigned int width = static_cast<unsigned int>(pending.size.x > 0 ? pending.size.x : 1);
+			unsigned int height = static_cast<unsigned int>(pending.size.y > 0 ? pending.size.y : 1);
+
+			//position and size of every setter call this frame in one request,
+			//with the default north west gravity the frame corner lands on the position
+			if (pending.hasPosition
+				&& pending.hasSize)
+			{
+				XMoveResizeWindow(
+					window.display,
+					window.window,
+					pending.position.x,
+					pending.position.y,
+					width,
+					height);
+			}
+			else if (pending.hasPosition)
+			{
+				XMoveWindow(
+					window.display,
+					window.window,
+					pending.position.x,
+					pending.position.y);
+			}
+			else
+			{
+				XResizeWindow(
+					window.display,
+					window.window,
+					width,
+					height);
+			}
+		}
+
+		void FinishNativeFlush()
+		{
+			//hands the queued requests of every display to its server without waiting for replies
+			Display* flushedDisplay = nullptr;
+			for (uint32_t slot = 0; slot < table.isAlive.size(); slot++)
+			{
+				Display* display = table.nativeWindows[slot].display;
+				if (!table.isAlive[slot]
+					|| display == nullptr
+					|| display == flushedDisplay)
+				{
+					continue;
+				}
+
+				XFlush(display);
+				flushedDisplay = display;
+			}
+		}
+	}
+
+	void WindowUtils::SetWindowTitle(const string& title, WindowHandle handle)
 	{
-		return !IsWindowVisible(window);
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_TITLE))
+		{
+			LOG_DEBUG("New window title: " << title << "");
+		}
+
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		const WINDOW& window = table.nativeWindows[slot];
+		const X11Atoms& currentAtoms = GetAtoms(window.display);
+
+		//legacy WM_NAME for old window managers, _NET_WM_NAME for UTF-8 titles
+		XStoreName(window.display, window.window, title.c_str());
+		XChangeProperty(
+			window.display,
+			window.window,
+			currentAtoms.netWmName,
+			currentAtoms.utf8String,
+			8,
+			PropModeReplace,
+			reinterpret_cast<const unsigned char*>(title.c_str()),
+			static_cast<int>(title.size()));
 	}
-	void WindowUtils::SetWindowHiddenState(bool newWindowHiddenState)
+
+	void WindowUtils::SetWindowState(WindowState state, WindowHandle handle)
 	{
-		if (debugType == DebugType::DEBUG_ALL
-			|| debugType == DebugType::DEBUG_WINDOW_HIDDEN_STATE)
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_TITLE))
+		{
+			string type{};
+			if (state == WindowState::WINDOW_RESET) type = "WINDOW_RESET";
+			else if (state == WindowState::WINDOW_MINIMIZED) type = "WINDOW_MINIMIZED";
+			else if (state == WindowState::WINDOW_MAXIMIZED) type = "WINDOW_MAXIMIZED";
+
+			LOG_DEBUG("New window type: " << type << "");
+		}
+
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		const WINDOW& window = table.nativeWindows[slot];
+		const X11Atoms& currentAtoms = GetAtoms(window.display);
+
+		switch (state)
+		{
+		case WindowState::WINDOW_RESET:
+			XMapWindow(window.display, window.window);
+			SendWindowState(
+				window,
+				0,
+				currentAtoms.netWmStateMaximizedVert,
+				currentAtoms.netWmStateMaximizedHorz);
+			break;
+		case WindowState::WINDOW_MINIMIZED:
+			XIconifyWindow(
+				window.display,
+				window.window,
+				DefaultScreen(window.display));
+			break;
+		case WindowState::WINDOW_MAXIMIZED:
+			SendWindowState(
+				window,
+				1,
+				currentAtoms.netWmStateMaximizedVert,
+				currentAtoms.netWmStateMaximizedHorz);
+			break;
+		}
+	}
+
+	void WindowUtils::SetWindowBorderlessState(bool newWindowBorderlessState, WindowHandle handle)
+	{
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_BORDERLESS_STATE))
+		{
+			string type = newWindowBorderlessState ? "true" : "false";
+			LOG_DEBUG("New window borderless state: " << type << "");
+		}
+
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		const WINDOW& window = table.nativeWindows[slot];
+		const X11Atoms& currentAtoms = GetAtoms(window.display);
+
+		//flags, functions, decorations, input mode, status
+		long hints[5] = { 2, 0, newWindowBorderlessState ? 0 : 1, 0, 0 };
+		XChangeProperty(
+			window.display,
+			window.window,
+			currentAtoms.motifWmHints,
+			currentAtoms.motifWmHints,
+			32,
+			PropModeReplace,
+			reinterpret_cast<const unsigned char*>(hints),
+			5);
+
+		table.isBorderless[slot] = newWindowBorderlessState;
+
+		//the window manager changes the frame later, read it again on the next get
+		table.isStateCached[slot] = 0;
+	}
+
+	void WindowUtils::SetWindowHiddenState(bool newWindowHiddenState, WindowHandle handle)
+	{
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_HIDDEN_STATE))
 		{
 			string type = newWindowHiddenState ? "true" : "false";
 			LOG_DEBUG("New window hidden state: " << type << "");
 		}
 
-		ShowWindow(window, newWindowHiddenState ? SW_HIDE : SW_SHOW);
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		const WINDOW& window = table.nativeWindows[slot];
+
+		if (newWindowHiddenState) XUnmapWindow(window.display, window.window);
+		else XMapWindow(window.display, window.window);
+
+		table.isVisible[slot] = !newWindowHiddenState;
+	}
+#else
+	namespace
+	{
+		//no native window layer yet, the cache is the only window state
+		void RefreshNativeState(uint32_t slot)
+		{
+			table.isStateCached[slot] = 1;
+		}
+		void ApplyNativeChanges(uint32_t slot)
+		{
+			(void)slot;
+		}
+		void FinishNativeFlush()
+		{
+		}
 	}
 
-	POINT WindowUtils::GetWindowPosition()
+	void WindowUtils::SetWindowTitle(const string& title, WindowHandle handle)
 	{
-		RECT rect{};
-		GetWindowRect(window, &rect);
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_TITLE))
+		{
+			LOG_DEBUG("New window title: " << title << "");
+		}
 
-		POINT pos{};
-		pos.x = rect.left;
-		pos.y = rect.top;
-		return pos;
+		//titles are not cached, there is nothing to show them on
+		(void)handle;
 	}
-	void WindowUtils::SetWindowPosition(int width, int height)
+
+	void WindowUtils::SetWindowState(WindowState state, WindowHandle handle)
 	{
-		if (debugType == DebugType::DEBUG_ALL
-			|| debugType == DebugType::DEBUG_WINDOW_SET_POSITION)
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_TITLE))
 		{
-			string sizeX = to_string(width);
-			string sizeY = to_string(height);
+			string type{};
+			if (state == WindowState::WINDOW_RESET) type = "WINDOW_RESET";
+			else if (state == WindowState::WINDOW_MINIMIZED) type = "WINDOW_MINIMIZED";
+			else if (state == WindowState::WINDOW_MAXIMIZED) type = "WINDOW_MAXIMIZED";
 
-			LOG_DEBUG("New window position: (" << width << ", " << height);
+			LOG_DEBUG("New window type: " << type << "");
 		}
 
-		SetWindowPos(
-			window,
-			nullptr,
-			width,
-			height,
-			0,
-			0,
-			SWP_NOSIZE
-			| SWP_NOZORDER
-			| SWP_NOOWNERZORDER);
+		//minimized and maximized states are not cached
+		(void)state;
+		(void)handle;
 	}
 
-	POINT WindowUtils::GetWindowFullSize()
+	void WindowUtils::SetWindowBorderlessState(bool newWindowBorderlessState, WindowHandle handle)
 	{
-		RECT rect{};
-		GetWindowRect(window, &rect);
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_BORDERLESS_STATE))
+		{
+			string type = newWindowBorderlessState ? "true" : "false";
+			LOG_DEBUG("New window borderless state: " << type << "");
+		}
 
-		POINT size{};
-		size.x = rect.right - rect.left;
-		size.y = rect.bottom - rect.top;
-		return size;
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		table.isBorderless[slot] = newWindowBorderlessState;
 	}
-	void WindowUtils::SetWindowFullSize(int width, int height)
+
+	void WindowUtils::SetWindowHiddenState(bool newWindowHiddenState, WindowHandle handle)
 	{
-		if (debugType == DebugType::DEBUG_ALL
-			|| debugType == DebugType::DEBUG_WINDOW_SET_FULL_SIZE)
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_HIDDEN_STATE))
 		{
-			string sizeX = to_string(width);
-			string sizeY = to_string(height);
+			string type = newWindowHiddenState ? "true" : "false";
+			LOG_DEBUG("New window hidden state: " << type << "");
+		}
+
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		table.isVisible[slot] = !newWindowHiddenState;
+	}
+#endif //_WIN32
+
+	bool WindowUtils::IsWindowBorderless(WindowHandle handle)
+	{
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return false;
+
+		EnsureWindowState(slot);
+		return table.isBorderless[slot];
+	}
 
-			LOG_DEBUG("New window full size: (" << width << ", " << height);
+	bool WindowUtils::IsWindowHidden(WindowHandle handle)
+	{
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return false;
+
+		EnsureWindowState(slot);
+		return !table.isVisible[slot];
+	}
+
+	POS WindowUtils::GetWindowPosition(WindowHandle handle)
+	{
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return {};
+
+		EnsureWindowState(slot);
+		return table.pendingChanges[slot].hasPosition
+			? table.pendingChanges[slot].position
+			: table.positions[slot];
+	}
+	void WindowUtils::SetWindowPosition(int width, int height, WindowHandle handle)
+	{
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_SET_POSITION))
+		{
+			LOG_DEBUG_FORMAT("New window position: ({}, {})", width, height);
 		}
 
-		SetWindowPos(
-			window,
-			nullptr,
-			0,
-			0,
-			width,
-			height,
-			SWP_NOMOVE
-			| SWP_NOZORDER
-			| SWP_NOOWNERZORDER);
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		table.pendingChanges[slot].position = { width, height };
+		table.pendingChanges[slot].hasPosition = true;
 	}
 
-	POINT WindowUtils::GetWindowContentSize()
+	POS WindowUtils::GetWindowFullSize(WindowHandle handle)
 	{
-		RECT rect{};
-		GetClientRect(window, &rect);
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return {};
 
-		POINT size{};
-		size.x = rect.right - rect.left;
-		size.y = rect.bottom - rect.top;
+		const BOUNDS& border = table.frameBorders[slot];
+
+		POS size = GetWindowContentSize(handle);
+		size.x += border.left + border.right;
+		size.y += border.top + border.bottom;
 		return size;
 	}
-	void WindowUtils::SetWindowContentSize(int width, int height)
+	void WindowUtils::SetWindowFullSize(int width, int height, WindowHandle handle)
 	{
-		if (debugType == DebugType::DEBUG_ALL
-			|| debugType == DebugType::DEBUG_WIŃDOW_SET_CONTENT_SIZE)
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_SET_FULL_SIZE))
 		{
-			string sizeX = to_string(width);
-			string sizeY = to_string(height);
+			LOG_DEBUG_FORMAT("New window full size: ({}, {})", width, height);
+		}
+
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		EnsureWindowState(slot);
+
+		const BOUNDS& border = table.frameBorders[slot];
+		table.pendingChanges[slot].size =
+		{
+			width - (border.left + border.right),
+			height - (border.top + border.bottom)
+		};
+		table.pendingChanges[slot].hasSize = true;
+	}
+
+	POS WindowUtils::GetWindowContentSize(WindowHandle handle)
+	{
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return {};
 
-			LOG_DEBUG("New window content size: (" << width << ", " << height);
+		EnsureWindowState(slot);
+		return table.pendingChanges[slot].hasSize
+			? table.pendingChanges[slot].size
+			: table.contentSizes[slot];
+	}
+	void WindowUtils::SetWindowContentSize(int width, int height, WindowHandle handle)
+	{
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_SET_CONTENT_SIZE))
+		{
+			LOG_DEBUG_FORMAT("New window content size: ({}, {})", width, height);
 		}
 
-		RECT rect = { 0, 0, width, height };
-		AdjustWindowRect(
-			&rect,
-			GetWindowLong(
-				window,
-				GWL_STYLE),
-			FALSE);
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
 
-		SetWindowPos(
-			window,
-			nullptr,
-			0,
-			0,
-			rect.right - rect.left,
-			rect.bottom - rect.top,
-			SWP_NOMOVE
-			| SWP_NOZORDER
-			| SWP_NOOWNERZORDER);
+		table.pendingChanges[slot].size = { width, height };
+		table.pendingChanges[slot].hasSize = true;
 	}
 
-	POINT WindowUtils::GetWindowMaxSize()
+	POS WindowUtils::GetWindowMaxSize(WindowHandle handle)
 	{
-		POINT point{};
-		point.x = maxWidth;
-		point.y = maxHeight;
-		return point;
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return {};
+
+		return table.maxSizes[slot];
 	}
-	POINT WindowUtils::GetWindowMinSize()
+	POS WindowUtils::GetWindowMinSize(WindowHandle handle)
 	{
-		POINT point{};
-		point.x = minWidth;
-		point.y = minHeight;
-		return point;
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return {};
+
+		return table.minSizes[slot];
 	}
 	void WindowUtils::SetMinMaxSize(
 		int newMaxWidth,
 		int newMaxHeight,
 		int newMinWidth,
-		int newMinHeight)
+		int newMinHeight,
+		WindowHandle handle)
 	{
-		if (debugType == DebugType::DEBUG_ALL
-			|| debugType == DebugType::DEBUG_WINDOW_SET_MINMAX_SIZE)
+		if (IsDebugTypeEnabled(DebugType::DEBUG_WINDOW_SET_MINMAX_SIZE))
 		{
-			LOG_DEBUG("Set new max size: " << maxWidth << ", " << maxHeight
-				<< ", min size:" << minWidth << ", " << minHeight);
+			LOG_DEBUG_FORMAT(
+				"Set new max size: {}, {}, min size: {}, {}",
+				newMaxWidth,
+				newMaxHeight,
+				newMinWidth,
+				newMinHeight);
 		}
 
-		maxWidth = newMaxWidth;
-		maxHeight = newMaxHeight;
-		minWidth = newMinWidth;
-		minHeight = newMinHeight;
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		table.maxSizes[slot] = { newMaxWidth, newMaxHeight };
+		table.minSizes[slot] = { newMinWidth, newMinHeight };
+
+#if !defined(_WIN32) && X11_ENABLED
+		const WINDOW& window = table.nativeWindows[slot];
+
+		XSizeHints hints{};
+		hints.flags = PMinSize | PMaxSize;
+		hints.min_width = newMinWidth;
+		hints.min_height = newMinHeight;
+		hints.max_width = newMaxWidth;
+		hints.max_height = newMaxHeight;
+		XSetWMNormalHints(window.display, window.window, &hints);
+#endif
+	}
+
+	void WindowUtils::FlushWindowChanges()
+	{
+		//pending flags sit next to each other, so windows without changes cost one byte test
+		for (uint32_t slot = 0; slot < table.pendingChanges.size(); slot++)
+		{
+			const PendingWindowChanges& pending = table.pendingChanges[slot];
+			if (!table.isAlive[slot]
+				|| (!pending.hasPosition && !pending.hasSize))
+			{
+				continue;
+			}
+
+			//sizes are converted with the frame border
+			if (pending.hasSize) EnsureWindowState(slot);
+
+			ApplyNativeChanges(slot);
+			ApplyPendingChanges(slot);
+		}
+
+		FinishNativeFlush();
+	}
+
+	void WindowUtils::RefreshWindowState(WindowHandle handle)
+	{
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		RefreshNativeState(slot);
+	}
+
+	void WindowUtils::OnWindowMoved(POS contentPosition, WindowHandle handle)
+	{
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		const BOUNDS& border = table.frameBorders[slot];
+		table.positions[slot] =
+		{
+			contentPosition.x - border.left,
+			contentPosition.y - border.top
+		};
 	}
-}
\ No newline at end of file
+	void WindowUtils::OnWindowResized(POS contentSize, WindowHandle handle)
+	{
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		table.contentSizes[slot] = contentSize;
+	}
+	void WindowUtils::OnWindowVisibilityChanged(bool isVisible, WindowHandle handle)
+	{
+		uint32_t slot = 0;
+		if (!GetSlot(handle, slot)) return;
+
+		table.isVisible[slot] = isVisible;
+	}
+#if !defined(_WIN32) && X11_ENABLED
+	void WindowUtils::OnWindowConfigured(const XConfigureEvent& event)
+	{
+		//the event loop passes every ConfigureNotify, unregistered windows are skipped quietly
+		WindowHandle handle = GetWindowHandle({ event.display, event.window });
+		if (handle == WindowHandle::Invalid()) return;
+
+		OnWindowResized({ event.width, event.height }, handle);
+
+		//events from the X server are relative to the window manager frame, the window manager
+		//follows every move with a synthetic event in root coordinates, so only those move the window
+		if (event.send_event) OnWindowMoved({ event.x, event.y }, handle);
+	}
+#endif
+}